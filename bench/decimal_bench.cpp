@@ -0,0 +1,257 @@
+// Decimal conversions behind every TWS size/position/quantity field (bid_stub.cpp)
+//
+// Checks FastDecimal (and the __bid64_* entry points the TWS API calls) against the
+// former std::stod / std::ostringstream implementation, then times both.
+// Exits with 1 if any value converts differently.
+//
+// Usage: decimal_bench [values]   (default 1000000 per round)
+
+#include <QElapsedTimer>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include "utils/fastdecimal.h"
+#include "Decimal.h"
+
+extern "C" {
+unsigned long long __bid64_from_string(char* ps, unsigned int rounding_mode, unsigned int* flags);
+void __bid64_to_string(char* ps, unsigned long long x, unsigned int* flags);
+}
+
+static const int ROUNDS = 7;
+static volatile double g_sink; // Keeps the timed loops from being optimized away
+
+// Former bid_stub.cpp conversions, the reference for the checks
+static bool legacyParse(const char* text, double& value)
+{
+    try {
+        value = std::stod(text);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+static std::string legacyFormat(double value)
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(6) << value;
+    return oss.str();
+}
+
+static bool sameDouble(double a, double b)
+{
+    if (std::isnan(a) || std::isnan(b)) {
+        return std::isnan(a) && std::isnan(b);
+    }
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+// Strings shaped like the TWS wire (sizes, fractional shares, positions) plus edge cases
+static QVector<std::string> wireCorpus(int count, std::mt19937_64& rng)
+{
+    QVector<std::string> corpus = {
+        "", " ", "-", "+", ".", "0", "-0", "+0", "00", "0.0", "1", "-1", "100", "130", "1.", ".5",
+        "0.5", "0.1", "0.000001", "0.0000005", "2.675", "-12.5", "  42", "\t7", "12abc", "1,5",
+        "9007199254740992", "9007199254740993", "18446744073709551615", "123456789012345678901234",
+        "0.1234567890123456789012", "0.12345678901234567890123", "1e3", "1E-2", "2.5e+10", "1e",
+        "1e400", "1e-400", "0x1A", "inf", "-Infinity", "nan", "170141183460469231731687303715884105727",
+        "3.14159265358979323846", "99999999.999999", "0.30000000000000004"
+    };
+    std::uniform_int_distribution<int> kind(0, 9);
+    std::uniform_int_distribution<long long> shares(0, 100000);
+    std::uniform_int_distribution<long long> wide(0, 9007199254740992LL);
+    std::uniform_int_distribution<int> decimals(1, 8);
+    char buffer[64];
+    while (corpus.size() < count) {
+        int k = kind(rng);
+        if (k < 6) {
+            std::snprintf(buffer, sizeof(buffer), "%lld", shares(rng) / (k < 3 ? 100 : 1) * (k < 3 ? 100 : 1));
+        } else if (k < 8) {
+            int places = decimals(rng);
+            long long scaled = wide(rng) % 100000000000LL;
+            long long divisor = 1;
+            for (int i = 0; i < places; ++i) {
+                divisor *= 10;
+            }
+            std::snprintf(buffer, sizeof(buffer), "%s%lld.%0*lld", (k == 7 ? "-" : ""), scaled / divisor, places,
+                          scaled % divisor);
+        } else if (k == 8) {
+            std::snprintf(buffer, sizeof(buffer), "%lld", wide(rng));
+        } else {
+            std::snprintf(buffer, sizeof(buffer), "%.17g", std::ldexp(static_cast<double>(wide(rng)), -40));
+        }
+        corpus.append(buffer);
+    }
+    return corpus;
+}
+
+// Doubles to format: wire quantities, ties at the 6th decimal, arbitrary bit patterns
+static QVector<double> valueCorpus(int count, std::mt19937_64& rng)
+{
+    QVector<double> values = {
+        0.0, -0.0, 1.0, -1.0, 0.5, 0.0000005, 0.0000015, 0.0000025, 2.675, 0.1, 1e-7, 4.9e-324,
+        999999.9999995, 0.9999995, 9007199254740991.0, 9007199254740992.0, 18446744073709549568.0,
+        INFINITY, -INFINITY, NAN
+    };
+    std::uniform_int_distribution<unsigned long long> bits;
+    std::uniform_int_distribution<int> exponent(-30, 64);
+    std::uniform_int_distribution<long long> shares(0, 1000000);
+    while (values.size() < count) {
+        switch (values.size() % 3) {
+        case 0:
+            values.append(static_cast<double>(shares(rng)) / 1000.0);
+            break;
+        case 1:
+            values.append(std::ldexp(static_cast<double>(bits(rng) >> 11), exponent(rng) - 53));
+            break;
+        default: {
+            unsigned long long raw = bits(rng);
+            double value;
+            std::memcpy(&value, &raw, sizeof(value));
+            values.append(value);
+            break;
+        }
+        }
+    }
+    return values;
+}
+
+static int checkParse(const QVector<std::string>& corpus)
+{
+    int mismatches = 0;
+    for (const std::string& text : corpus) {
+        double expected = 0.0;
+        double actual = 0.0;
+        bool expectedOk = legacyParse(text.c_str(), expected);
+        bool actualOk = FastDecimal::parse(text.c_str(), actual);
+
+        unsigned int flags = 0;
+        Decimal decimal = __bid64_from_string(const_cast<char*>(text.c_str()), 0, &flags);
+        double viaStub = DecimalFunctions::decimalToDouble(decimal);
+
+        if (expectedOk != actualOk || (expectedOk && !sameDouble(expected, actual))
+            || (flags != 0) == expectedOk || (expectedOk && !sameDouble(expected, viaStub))) {
+            if (++mismatches <= 10) {
+                std::printf("  ! parse \"%s\": legacy %s %.17g, fast %s %.17g\n", text.c_str(),
+                            expectedOk ? "ok" : "invalid", expected, actualOk ? "ok" : "invalid", actual);
+            }
+        }
+    }
+    return mismatches;
+}
+
+static int checkFormat(const QVector<double>& values)
+{
+    int mismatches = 0;
+    char buffer[FastDecimal::FORMAT_CAPACITY];
+    for (double value : values) {
+        // The legacy output for these was up to 317 characters (UNSET_DECIMAL reads as ~1e289)
+        if (std::isfinite(value) && std::fabs(value) >= 18446744073709551616.0) {
+            continue;
+        }
+        std::string expected = legacyFormat(value);
+        FastDecimal::formatFixed6(value, buffer);
+
+        char viaStub[64];
+        __bid64_to_string(viaStub, DecimalFunctions::doubleToDecimal(value), nullptr);
+
+        if (expected != buffer || expected != viaStub) {
+            if (++mismatches <= 10) {
+                std::printf("  ! format %.17g: legacy \"%s\", fast \"%s\"\n", value, expected.c_str(), buffer);
+            }
+        }
+    }
+    return mismatches;
+}
+
+// Prints ns per conversion of the fastest / median round
+template <typename Fn>
+static void runRounds(const char* name, int count, Fn convert)
+{
+    QVector<double> results;
+    for (int round = 0; round < ROUNDS; ++round) {
+        QElapsedTimer timer;
+        timer.start();
+        g_sink = convert();
+        results.append(static_cast<double>(timer.nsecsElapsed()) / count);
+    }
+    std::sort(results.begin(), results.end());
+    std::printf("%-28s best %7.1f ns/op   median %7.1f ns/op   (%d values x %d rounds)\n",
+                name, results.first(), results[results.size() / 2], count, ROUNDS);
+}
+
+int main(int argc, char* argv[])
+{
+    int count = (argc > 1) ? std::atoi(argv[1]) : 1000000;
+    if (count <= 0) {
+        count = 1000000;
+    }
+
+    // Correctness: every conversion must match the former implementation
+    std::mt19937_64 rng(20240612);
+    int parseMismatches = checkParse(wireCorpus(200000, rng));
+    int formatMismatches = checkFormat(valueCorpus(200000, rng));
+    std::printf("check: parse %d mismatches, format %d mismatches\n", parseMismatches, formatMismatches);
+
+    // Speed: typical wire sizes ("100", "2500", "0.5")
+    QVector<std::string> wire;
+    QVector<double> values;
+    wire.reserve(count);
+    values.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        int size = (i % 7 == 0) ? (i % 500) : (i % 50 + 1) * 100;
+        wire.append(i % 101 == 0 ? std::to_string(size) + ".5" : std::to_string(size));
+        values.append(size);
+    }
+
+    runRounds("parse legacy (std::stod)", count, [&]() {
+        double sum = 0.0;
+        for (const std::string& text : wire) {
+            double value = 0.0;
+            legacyParse(text.c_str(), value);
+            sum += value;
+        }
+        return sum;
+    });
+    runRounds("parse FastDecimal", count, [&]() {
+        double sum = 0.0;
+        for (const std::string& text : wire) {
+            double value = 0.0;
+            FastDecimal::parse(text.c_str(), value);
+            sum += value;
+        }
+        return sum;
+    });
+    runRounds("parse stringToDecimal", count, [&]() {
+        double sum = 0.0;
+        for (const std::string& text : wire) {
+            sum += DecimalFunctions::decimalToDouble(DecimalFunctions::stringToDecimal(text));
+        }
+        return sum;
+    });
+    runRounds("format legacy (ostringstream)", count, [&]() {
+        double sum = 0.0;
+        for (double value : values) {
+            sum += legacyFormat(value).size();
+        }
+        return sum;
+    });
+    runRounds("format FastDecimal", count, [&]() {
+        double sum = 0.0;
+        char buffer[FastDecimal::FORMAT_CAPACITY];
+        for (double value : values) {
+            sum += FastDecimal::formatFixed6(value, buffer);
+        }
+        return sum;
+    });
+
+    return (parseMismatches == 0 && formatMismatches == 0) ? 0 : 1;
+}
@@ -0,0 +1,523 @@
+// Synthetic TWS feed: IBKRWrapper callbacks -> TickerDataManager -> ChartWidget, without a socket
+//
+// Phases:
+//   throughput  TickerDataManager alone, ticks/sec sustained (tick-by-tick bid/ask + 5s bars)
+//   session     TickerDataManager + ChartWidget over a simulated session: latency from the
+//               wrapper callback to ChartWidget::updatePriceLines / updateCurrentBar /
+//               completed-bar patch (the replot itself follows on the scheduler's next
+//               frame), replots requested vs. performed, and resident memory sampled
+//               every simulated 30 minutes
+//
+// The data manager runs on the feed's clock: quotes set its time, so live candles line up
+// with the feed's bars instead of being stamped with the wall clock.
+//
+// Usage: feed_bench [--symbols 8] [--tick-rate 5] [--hours 6.5] [--ticks 2000000]
+//                   [--feed recorded.csv] [--json results.json]
+//
+// Recorded feed (CSV, sorted by time, symbols are taken from the file):
+//   T,<time>,<symbol>,<bid>,<ask>
+//   B,<time>,<symbol>,<open>,<high>,<low>,<close>,<volume>
+//
+// Results are printed as JSON (and written to --json) so runs can be diffed.
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QVector>
+#include <QHash>
+#include <cstdio>
+#include <random>
+#include "client/ibkrclient.h"
+#include "models/tickerdatamanager.h"
+#include "widgets/chartwidget.h"
+#include "utils/latencyhistogram.h"
+#include "Decimal.h"
+#include "TickAttribBidAsk.h"
+
+#if defined(Q_OS_MACOS)
+#include <mach/mach.h>
+#elif defined(Q_OS_LINUX)
+#include <unistd.h>
+#endif
+
+static const char* EXCHANGE = "NASDAQ";
+static const qint64 SESSION_START = 1700058600; // 2023-11-15 09:30 ET
+static const int BAR_SECONDS = 5;
+
+// Resident set size in bytes, 0 where unsupported
+static qint64 residentBytes()
+{
+#if defined(Q_OS_MACOS)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+        return static_cast<qint64>(info.resident_size);
+    }
+    return 0;
+#elif defined(Q_OS_LINUX)
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly)) return 0;
+    QList<QByteArray> fields = statm.readAll().split(' ');
+    return fields.size() > 1 ? fields[1].toLongLong() * sysconf(_SC_PAGESIZE) : 0;
+#else
+    return 0;
+#endif
+}
+
+static QJsonObject histogramJson(const LatencyHistogram& histogram)
+{
+    QJsonObject json;
+    json["count"] = static_cast<qint64>(histogram.count());
+    json["mean_ns"] = histogram.meanNs();
+    json["p50_ns"] = histogram.percentileNs(50.0);
+    json["p99_ns"] = histogram.percentileNs(99.0);
+    json["p999_ns"] = histogram.percentileNs(99.9);
+    json["max_ns"] = histogram.maxNs();
+    return json;
+}
+
+// Receives feed events; second() is called once per simulated second that had events
+class FeedSink
+{
+public:
+    virtual ~FeedSink() = default;
+    virtual void quote(int symbol, qint64 time, double bid, double ask) = 0;
+    virtual void bar(int symbol, const CandleBar& bar) = 0;
+    virtual void second(qint64 time) = 0;
+};
+
+struct FeedEvent {
+    bool isBar = false;
+    int symbol = 0;
+    CandleBar bar;  // Quotes: timestamp, bid in open, ask in close
+};
+
+// Random-walk quotes per symbol, with the matching 5s bar (mid prices) after every 5 seconds
+class SyntheticFeed
+{
+public:
+    explicit SyntheticFeed(int symbols)
+        : m_random(42)
+        , m_step(-0.02, 0.02)
+        , m_mid(symbols)
+    {
+        for (int i = 0; i < symbols; ++i) {
+            m_mid[i] = 50.0 + 10.0 * i;
+        }
+    }
+
+    void run(qint64 startTime, qint64 seconds, int quotesPerSecond, FeedSink& sink)
+    {
+        const int symbols = m_mid.size();
+        QVector<CandleBar> bars(symbols);
+
+        for (qint64 s = 0; s < seconds; ++s) {
+            qint64 time = startTime + s;
+            bool barStart = (time % BAR_SECONDS == 0);
+
+            for (int q = 0; q < quotesPerSecond; ++q) {
+                for (int i = 0; i < symbols; ++i) {
+                    double mid = qMax(1.0, m_mid[i] + m_step(m_random));
+                    m_mid[i] = mid;
+
+                    CandleBar& bar = bars[i];
+                    if (barStart && q == 0) {
+                        bar = {time, mid, mid, mid, mid, 0};
+                    }
+                    bar.high = qMax(bar.high, mid);
+                    bar.low = qMin(bar.low, mid);
+                    bar.close = mid;
+                    bar.volume += 100;
+
+                    sink.quote(i, time, mid - 0.01, mid + 0.01);
+                }
+            }
+
+            if ((time + 1) % BAR_SECONDS == 0) {
+                for (int i = 0; i < symbols; ++i) {
+                    if (bars[i].timestamp > 0) {
+                        sink.bar(i, bars[i]);
+                    }
+                }
+            }
+            sink.second(time);
+        }
+    }
+
+private:
+    std::mt19937 m_random;
+    std::uniform_real_distribution<double> m_step;
+    QVector<double> m_mid;
+};
+
+// Recorded feed loaded up front (parsing stays out of the measurement)
+static bool loadRecordedFeed(const QString& path, QVector<FeedEvent>& events, QStringList& symbols)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        std::fprintf(stderr, "Cannot open %s\n", qPrintable(path));
+        return false;
+    }
+
+    QHash<QString, int> symbolIndex;
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        QStringList fields = in.readLine().split(',');
+        bool isBar = fields.value(0) == "B";
+        if (fields.size() < 5 || (!isBar && fields[0] != "T") || (isBar && fields.size() < 8)) continue;
+
+        QString symbol = fields[2].trimmed();
+        if (!symbolIndex.contains(symbol)) {
+            symbolIndex.insert(symbol, symbols.size());
+            symbols.append(symbol);
+        }
+
+        FeedEvent event;
+        event.isBar = isBar;
+        event.symbol = symbolIndex.value(symbol);
+        event.bar.timestamp = fields[1].toLongLong();
+        if (isBar) {
+            event.bar.open = fields[3].toDouble();
+            event.bar.high = fields[4].toDouble();
+            event.bar.low = fields[5].toDouble();
+            event.bar.close = fields[6].toDouble();
+            event.bar.volume = fields[7].toLongLong();
+        } else {
+            event.bar.open = fields[3].toDouble();
+            event.bar.close = fields[4].toDouble();
+        }
+        events.append(event);
+    }
+    return !events.isEmpty();
+}
+
+static void replayRecordedFeed(const QVector<FeedEvent>& events, FeedSink& sink)
+{
+    qint64 second = events.isEmpty() ? 0 : events.first().bar.timestamp;
+    for (const FeedEvent& event : events) {
+        if (event.bar.timestamp != second) {
+            sink.second(second);
+            second = event.bar.timestamp;
+        }
+        if (event.isBar) {
+            sink.bar(event.symbol, event.bar);
+        } else {
+            sink.quote(event.symbol, event.bar.timestamp, event.bar.open, event.bar.close);
+        }
+    }
+    sink.second(second);
+}
+
+// Offline client + data manager with every symbol streaming; feeds events into the wrapper
+class FeedDriver : public FeedSink
+{
+public:
+    explicit FeedDriver(const QStringList& symbols)
+        : m_symbols(symbols)
+        , m_dataManager(&m_client)
+        , m_tickReqIds(symbols.size(), -1)
+        , m_barReqIds(symbols.size(), -1)
+        , m_size(DecimalFunctions::doubleToDecimal(100))
+        , m_lastFeedNs(0)
+        , m_quotes(0)
+        , m_bars(0)
+    {
+        m_dataManager.setMaxStreamingTickers(symbols.size());
+        m_dataManager.setCurrentTimeframe(Timeframe::SEC_5);
+        m_client.startOfflineSession();
+
+        // Last one activated is the displayed ticker
+        for (int i = symbols.size() - 1; i >= 0; --i) {
+            m_dataManager.activateTicker(symbols[i], EXCHANGE);
+        }
+    }
+
+    ~FeedDriver() override
+    {
+        m_client.disconnect();
+    }
+
+    TickerDataManager& dataManager() { return m_dataManager; }
+    qint64 lastFeedNs() const { return m_lastFeedNs; }
+    quint64 quotes() const { return m_quotes; }
+    quint64 bars() const { return m_bars; }
+
+    void quote(int symbol, qint64 time, double bid, double ask) override
+    {
+        int reqId = reqIdFor(m_tickReqIds, m_client.tickByTickRequests(), symbol);
+        if (reqId < 0) return;
+
+        m_dataManager.setSimulatedTime(time);
+        m_lastFeedNs = LatencyHistogram::nowNs();
+        m_client.wrapper()->tickByTickBidAsk(reqId, static_cast<time_t>(time), bid, ask, m_size, m_size, m_attrib);
+        m_quotes++;
+    }
+
+    void bar(int symbol, const CandleBar& bar) override
+    {
+        // Real-time bars are requested after the first tick of a ticker
+        int reqId = reqIdFor(m_barReqIds, m_client.realTimeBarRequests(), symbol);
+        if (reqId < 0) return;
+
+        Decimal volume = DecimalFunctions::doubleToDecimal(static_cast<double>(bar.volume));
+        m_lastFeedNs = LatencyHistogram::nowNs();
+        m_client.wrapper()->realtimeBar(reqId, static_cast<long>(bar.timestamp), bar.open, bar.high, bar.low, bar.close,
+                                       volume, volume, 1);
+        m_bars++;
+    }
+
+    void second(qint64 time) override
+    {
+        Q_UNUSED(time);
+    }
+
+private:
+    int reqIdFor(QVector<int>& cache, const QHash<int, QString>& requests, int symbol)
+    {
+        int reqId = cache[symbol];
+        if (reqId >= 0 && requests.contains(reqId)) return reqId;
+
+        cache[symbol] = -1;
+        for (auto it = requests.constBegin(); it != requests.constEnd(); ++it) {
+            if (it.value() == m_symbols[symbol]) {
+                cache[symbol] = it.key();
+                break;
+            }
+        }
+        return cache[symbol];
+    }
+
+    QStringList m_symbols;
+    IBKRClient m_client;
+    TickerDataManager m_dataManager;
+    QVector<int> m_tickReqIds;
+    QVector<int> m_barReqIds;
+    Decimal m_size;
+    TickAttribBidAsk m_attrib;
+    qint64 m_lastFeedNs;
+    quint64 m_quotes;
+    quint64 m_bars;
+};
+
+// Driver plus a visible chart of the first symbol wired like MainWindow, with latency probes
+class SessionDriver : public FeedDriver
+{
+public:
+    SessionDriver(const QStringList& symbols, qint64 sampleEverySeconds)
+        : FeedDriver(symbols)
+        , m_displayed(symbols.first())
+        , m_sampleEverySeconds(sampleEverySeconds)
+        , m_startTime(-1)
+        , m_peakRss(0)
+    {
+        TickerDataManager& manager = dataManager();
+        m_chart.setTickerDataManager(&manager);
+        m_chart.setTimeframe(Timeframe::SEC_5);
+        m_chart.setSymbol(m_displayed, EXCHANGE);
+        m_chart.resize(1400, 700);
+        m_chart.show();
+
+        // Probes run after the chart's own handler (connected later = called later)
+        QObject::connect(&manager, &TickerDataManager::priceUpdated, &m_chart,
+                         [this](const QString& symbol, double, double, double bid, double ask, double mid) {
+            if (symbol != m_displayed) return;
+            m_chart.updatePriceLines(bid, ask, mid);
+            m_priceLines.record(LatencyHistogram::nowNs() - lastFeedNs());
+        });
+        QObject::connect(&manager, &TickerDataManager::currentBarUpdated, &m_chart,
+                         [this](const QString& symbol, Timeframe timeframe, const CandleBar& bar) {
+            if (symbol != m_displayed) return;
+            m_chart.updateCurrentBar(timeframe, bar);
+            m_currentBar.record(LatencyHistogram::nowNs() - lastFeedNs());
+        });
+        QObject::connect(&manager, &TickerDataManager::barsUpdated, &m_chart,
+                         [this](const QString& symbol, Timeframe timeframe) {
+            if (symbol != m_displayed || timeframe != Timeframe::SEC_5) return;
+            m_barPatch.record(LatencyHistogram::nowNs() - lastFeedNs());
+        });
+
+        QApplication::processEvents();
+        m_startRss = residentBytes();
+    }
+
+    void second(qint64 time) override
+    {
+        // Let debounced replots and queued calls run, as the event loop would
+        QApplication::processEvents();
+
+        if (m_startTime < 0) m_startTime = time;
+        qint64 elapsed = time - m_startTime + 1;
+        if (elapsed % m_sampleEverySeconds == 0) {
+            sampleMemory(elapsed);
+        }
+    }
+
+    void sampleMemory(qint64 elapsedSeconds)
+    {
+        qint64 rss = residentBytes();
+        m_peakRss = qMax(m_peakRss, rss);
+
+        QJsonObject sample;
+        sample["simulated_hours"] = elapsedSeconds / 3600.0;
+        sample["rss_bytes"] = rss;
+        m_samples.append(sample);
+    }
+
+    QJsonObject latencyJson() const
+    {
+        QJsonObject json;
+        json["price_lines"] = histogramJson(m_priceLines);
+        json["current_bar"] = histogramJson(m_currentBar);
+        json["bar_patch"] = histogramJson(m_barPatch);
+        return json;
+    }
+
+    QJsonObject replotJson() const
+    {
+        QJsonObject json;
+        json["requested"] = static_cast<qint64>(m_chart.replotsRequested());
+        json["performed"] = static_cast<qint64>(m_chart.replotsPerformed());
+        return json;
+    }
+
+    QJsonObject memoryJson(qint64 simulatedSeconds)
+    {
+        qint64 endRss = residentBytes();
+        m_peakRss = qMax(m_peakRss, endRss);
+
+        QJsonObject json;
+        json["simulated_hours"] = simulatedSeconds / 3600.0;
+        json["rss_start_bytes"] = m_startRss;
+        json["rss_end_bytes"] = endRss;
+        json["rss_peak_bytes"] = m_peakRss;
+        json["growth_bytes"] = endRss - m_startRss;
+        json["samples"] = m_samples;
+        return json;
+    }
+
+private:
+    ChartWidget m_chart;
+    QString m_displayed;
+    qint64 m_sampleEverySeconds;
+    qint64 m_startTime;
+    qint64 m_startRss;
+    qint64 m_peakRss;
+    LatencyHistogram m_priceLines;
+    LatencyHistogram m_currentBar;
+    LatencyHistogram m_barPatch;
+    QJsonArray m_samples;
+};
+
+int main(int argc, char* argv[])
+{
+    // No window server needed unless a platform was chosen explicitly
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+    app.setApplicationName("IBKR Hotkey Trader Bench"); // Own settings and bar cache, not the trader's
+    app.setOrganizationName("Kinect.PRO");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Synthetic TWS feed benchmark");
+    parser.addHelpOption();
+    QCommandLineOption symbolsOption("symbols", "Streamed tickers (generated feed).", "count", "8");
+    QCommandLineOption tickRateOption("tick-rate", "Quotes per second per ticker in the session phase.", "rate", "5");
+    QCommandLineOption hoursOption("hours", "Simulated session length.", "hours", "6.5");
+    QCommandLineOption ticksOption("ticks", "Quotes fed in the throughput phase.", "count", "2000000");
+    QCommandLineOption feedOption("feed", "Replay a recorded feed (CSV) instead of generating one.", "file");
+    QCommandLineOption jsonOption("json", "Also write the results to this file.", "file");
+    parser.addOptions({symbolsOption, tickRateOption, hoursOption, ticksOption, feedOption, jsonOption});
+    parser.process(app);
+
+    int symbolCount = qMax(1, parser.value(symbolsOption).toInt());
+    int tickRate = qMax(1, parser.value(tickRateOption).toInt());
+    qint64 sessionSeconds = qMax<qint64>(BAR_SECONDS, static_cast<qint64>(parser.value(hoursOption).toDouble() * 3600));
+    qint64 throughputTicks = qMax<qint64>(1, parser.value(ticksOption).toLongLong());
+
+    // Bars persisted by a previous run would be restored and skew memory numbers
+    QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/bars").removeRecursively();
+
+    QVector<FeedEvent> recorded;
+    QStringList symbols;
+    if (parser.isSet(feedOption)) {
+        if (!loadRecordedFeed(parser.value(feedOption), recorded, symbols)) return 1;
+        symbolCount = symbols.size();
+    } else {
+        for (int i = 0; i < symbolCount; ++i) {
+            symbols.append(QString("BENCH%1").arg(i));
+        }
+    }
+
+    QJsonObject results;
+    results["benchmark"] = "feed_bench";
+    results["symbols"] = symbolCount;
+    results["feed"] = parser.isSet(feedOption) ? parser.value(feedOption) : QString("synthetic");
+
+    // Throughput: data manager only, quotes as fast as the wrapper takes them
+    {
+        FeedDriver driver(symbols);
+        const int quotesPerSecond = 50; // Dense feed - fast market
+        QElapsedTimer timer;
+        timer.start();
+        if (recorded.isEmpty()) {
+            qint64 seconds = qMax<qint64>(1, throughputTicks / (symbolCount * quotesPerSecond));
+            SyntheticFeed(symbolCount).run(SESSION_START, seconds, quotesPerSecond, driver);
+        } else {
+            replayRecordedFeed(recorded, driver);
+        }
+        double elapsedSec = timer.nsecsElapsed() / 1e9;
+
+        QJsonObject throughput;
+        throughput["quotes"] = static_cast<qint64>(driver.quotes());
+        throughput["bars"] = static_cast<qint64>(driver.bars());
+        throughput["elapsed_sec"] = elapsedSec;
+        throughput["quotes_per_sec"] = driver.quotes() / elapsedSec;
+        throughput["ns_per_quote"] = elapsedSec * 1e9 / qMax<quint64>(1, driver.quotes());
+        results["throughput"] = throughput;
+    }
+
+    // Session: chart attached, simulated trading day
+    {
+        SessionDriver driver(symbols, 1800);
+        QElapsedTimer timer;
+        timer.start();
+        qint64 simulatedSeconds = sessionSeconds;
+        if (recorded.isEmpty()) {
+            SyntheticFeed(symbolCount).run(SESSION_START, sessionSeconds, tickRate, driver);
+        } else {
+            replayRecordedFeed(recorded, driver);
+            simulatedSeconds = recorded.last().bar.timestamp - recorded.first().bar.timestamp + 1;
+        }
+
+        QJsonObject session;
+        session["tick_rate"] = tickRate;
+        session["quotes"] = static_cast<qint64>(driver.quotes());
+        session["bars"] = static_cast<qint64>(driver.bars());
+        session["elapsed_sec"] = timer.nsecsElapsed() / 1e9;
+        session["latency"] = driver.latencyJson();
+        session["replots"] = driver.replotJson();
+        session["memory"] = driver.memoryJson(simulatedSeconds);
+        results["session"] = session;
+    }
+
+    QByteArray json = QJsonDocument(results).toJson(QJsonDocument::Indented);
+    std::fwrite(json.constData(), 1, json.size(), stdout);
+
+    if (parser.isSet(jsonOption)) {
+        QFile out(parser.value(jsonOption));
+        if (!out.open(QIODevice::WriteOnly) || out.write(json) != json.size()) {
+            std::fprintf(stderr, "Cannot write %s\n", qPrintable(parser.value(jsonOption)));
+            return 1;
+        }
+    }
+    return 0;
+}
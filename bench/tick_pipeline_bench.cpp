@@ -0,0 +1,83 @@
+// Tick hot path: IBKRWrapper::tickByTickBidAsk -> TickPipeline -> TradingManager target prices
+//
+// Usage: tick_pipeline_bench [ticks]   (default 5000000 per round)
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QVector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include "client/ibkrclient.h"
+#include "trading/tradingmanager.h"
+#include "models/settings.h"
+#include "Decimal.h"
+#include "TickAttribBidAsk.h"
+
+static const int STREAMS = 8;      // Streaming pool size
+static const int FIRST_REQ_ID = 2000;
+static const int ROUNDS = 7;
+
+// Prints ns per tick of the fastest / median round
+static void runRounds(const char* name, IBKRWrapper* wrapper, int ticks, int focusedEvery, const TradingManager& trading)
+{
+    Decimal size = DecimalFunctions::doubleToDecimal(100);
+    TickAttribBidAsk attrib;
+    QVector<double> results;
+    double focusedAsk = 0.0;
+
+    for (int round = 0; round < ROUNDS; ++round) {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < ticks; ++i) {
+            bool focused = (i % focusedEvery == 0);
+            int reqId = FIRST_REQ_ID + (focused ? 0 : 1 + i % (STREAMS - 1));
+            double bid = 100.0 + (i & 0xff) * 0.01;
+            double ask = bid + 0.02;
+            if (focused) {
+                focusedAsk = ask;
+            }
+            wrapper->tickByTickBidAsk(reqId, 1700000000 + i, bid, ask, size, size, attrib);
+        }
+        results.append(static_cast<double>(timer.nsecsElapsed()) / ticks);
+    }
+
+    std::sort(results.begin(), results.end());
+    std::printf("%-24s best %7.1f ns/tick   median %7.1f ns/tick   (%d ticks x %d rounds)\n",
+                name, results.first(), results[results.size() / 2], ticks, ROUNDS);
+
+    // Target must follow the last focused tick, otherwise the benchmark measured a broken path
+    double expected = focusedAsk + Settings::instance().askOffset() / 100.0;
+    if (qAbs(trading.targetBuyPrice() - expected) > 1e-9) {
+        std::printf("  ! target buy price %.4f, expected %.4f\n", trading.targetBuyPrice(), expected);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("IBKR Hotkey Trader Bench"); // Own settings database, not the trader's
+    app.setOrganizationName("Kinect.PRO");
+
+    int ticks = (argc > 1) ? std::atoi(argv[1]) : 5000000;
+    if (ticks <= 0) ticks = 5000000;
+
+    IBKRClient client;
+    TradingManager trading(&client);
+
+    // Same setup as a running session: a pool of streams, one of them displayed
+    TickPipeline& pipeline = client.tickPipeline();
+    for (int i = 0; i < STREAMS; ++i) {
+        pipeline.openSlot(FIRST_REQ_ID + i);
+    }
+    pipeline.setFocus(FIRST_REQ_ID);
+
+    std::printf("Ask offset %d cents, %d streams\n", Settings::instance().askOffset(), STREAMS);
+    runRounds("focused stream only", client.wrapper(), ticks, 1, trading);
+    runRounds("1 of 8 ticks focused", client.wrapper(), ticks, STREAMS, trading);
+
+    std::printf("published %llu, dropped %llu\n",
+                static_cast<unsigned long long>(pipeline.publishedCount()),
+                static_cast<unsigned long long>(pipeline.droppedCount()));
+    return 0;
+}
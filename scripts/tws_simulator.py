@@ -0,0 +1,690 @@
+#!/usr/bin/env python3
+"""
+Local TWS stand-in for offline load testing
+
+Speaks enough of the TWS socket protocol to drive IBKRClient without a live
+TWS/Gateway: handshake, nextValidId, managedAccounts, account updates,
+reqTickByTickData (BidAsk, Last, AllLast), reqRealTimeBars, reqHistoricalData,
+placeOrder/cancelOrder/reqGlobalCancel (orderStatus + execDetails),
+reqMatchingSymbols and display groups.
+
+Quotes are a seeded random walk per symbol at a configurable rate per stream,
+with optional bursts. Last/AllLast streams print trades at the current bid or
+ask at the same rate (AllLast also from other venues). Faults can be injected on a schedule: socket drops,
+error 1100 (connectivity lost, then 1102 after an outage), error 1300 (port
+reset, connection dropped), delayed order acks and historical pacing
+violations.
+
+The server advertises API version 157, the newest version whose message
+layouts are encoded here (the 10.x client still supports it). openOrder is not
+simulated - its layout changes with almost every server version - so orders
+are tracked from orderStatus/execDetails only.
+
+Usage:
+    python3 scripts/tws_simulator.py --port 7496 --tick-rate 50
+    python3 scripts/tws_simulator.py --tick-rate 200 --burst-every 30 --burst-factor 10
+    python3 scripts/tws_simulator.py --disconnect-every 120 --error-1100-every 300 --ack-delay 250
+"""
+
+import argparse
+import asyncio
+import datetime
+import random
+import re
+import struct
+import time
+
+SERVER_VERSION = 157
+
+# Client -> server message ids
+REQ_MKT_DATA = 1
+CANCEL_MKT_DATA = 2
+PLACE_ORDER = 3
+CANCEL_ORDER = 4
+REQ_OPEN_ORDERS = 5
+REQ_ACCT_DATA = 6
+REQ_IDS = 8
+REQ_AUTO_OPEN_ORDERS = 15
+REQ_ALL_OPEN_ORDERS = 16
+REQ_MANAGED_ACCTS = 17
+REQ_HISTORICAL_DATA = 20
+CANCEL_HISTORICAL_DATA = 25
+REQ_CURRENT_TIME = 49
+REQ_REAL_TIME_BARS = 50
+CANCEL_REAL_TIME_BARS = 51
+REQ_GLOBAL_CANCEL = 58
+REQ_POSITIONS = 61
+QUERY_DISPLAY_GROUPS = 67
+SUBSCRIBE_TO_GROUP_EVENTS = 68
+UPDATE_DISPLAY_GROUP = 69
+UNSUBSCRIBE_FROM_GROUP_EVENTS = 70
+START_API = 71
+REQ_MATCHING_SYMBOLS = 81
+REQ_TICK_BY_TICK_DATA = 97
+CANCEL_TICK_BY_TICK_DATA = 98
+REQ_COMPLETED_ORDERS = 99
+
+# Server -> client message ids
+ORDER_STATUS = 3
+ERR_MSG = 4
+ACCT_VALUE = 6
+PORTFOLIO_VALUE = 7
+ACCT_UPDATE_TIME = 8
+NEXT_VALID_ID = 9
+EXECUTION_DATA = 11
+MANAGED_ACCTS = 15
+HISTORICAL_DATA = 17
+CURRENT_TIME = 49
+REAL_TIME_BARS = 50
+OPEN_ORDER_END = 53
+ACCT_DOWNLOAD_END = 54
+EXECUTION_DATA_END = 55
+POSITION_END = 62
+DISPLAY_GROUP_LIST = 67
+SYMBOL_SAMPLES = 79
+TICK_BY_TICK = 99
+COMPLETED_ORDERS_END = 102
+
+TRADE_VENUES = ["NASDAQ", "ARCA", "BATS", "IEX", "EDGX", "DARK"]  # AllLast prints
+
+BAR_SECONDS = {"sec": 1, "secs": 1, "min": 60, "mins": 60, "hour": 3600, "hours": 3600,
+               "day": 86400, "days": 86400, "week": 604800, "month": 2592000}
+DURATION_SECONDS = {"S": 1, "D": 86400, "W": 604800, "M": 2592000, "Y": 31536000}
+MAX_HISTORICAL_BARS = 50000
+
+DEFAULT_UNIVERSE = ["AAPL", "MSFT", "NVDA", "AMZN", "GOOGL", "META", "TSLA", "AMD", "NFLX", "INTC",
+                    "SPY", "QQQ", "IWM", "SMCI", "PLTR", "COIN", "MARA", "SOFI", "RIVN", "NIO"]
+
+
+def log(message):
+    print(f"{datetime.datetime.now():%H:%M:%S.%f}"[:-3] + f" {message}", flush=True)
+
+
+def encode(*fields):
+    """One length-prefixed message of null-terminated text fields"""
+    payload = b"".join(_field(f).encode() + b"\0" for f in fields)
+    return struct.pack(">I", len(payload)) + payload
+
+
+def _field(value):
+    if value is None:
+        return ""
+    if isinstance(value, bool):
+        return "1" if value else "0"
+    if isinstance(value, float):
+        return f"{value:.4f}".rstrip("0").rstrip(".")
+    return str(value)
+
+
+def parse_end_time(text):
+    """endDateTime as sent by the client: '', 'yyyyMMdd-HH:mm:ss' (UTC) or 'yyyyMMdd HH:mm:ss [tz]'"""
+    text = text.strip()
+    if not text:
+        return int(time.time())
+    for fmt in ("%Y%m%d-%H:%M:%S", "%Y%m%d %H:%M:%S"):
+        try:
+            parsed = datetime.datetime.strptime(text[:17], fmt)
+            return int(parsed.replace(tzinfo=datetime.timezone.utc).timestamp())
+        except ValueError:
+            pass
+    return int(time.time())
+
+
+def parse_bar_size(text):
+    parts = text.split()
+    if len(parts) != 2 or parts[1] not in BAR_SECONDS:
+        return 60
+    return int(parts[0]) * BAR_SECONDS[parts[1]]
+
+
+def parse_duration(text):
+    parts = text.split()
+    if len(parts) != 2 or parts[1] not in DURATION_SECONDS:
+        return 86400
+    return int(parts[0]) * DURATION_SECONDS[parts[1]]
+
+
+class Market:
+    """Random-walk bid/ask per symbol, shared by all connections"""
+
+    def __init__(self, seed):
+        self.rng = random.Random(seed)
+        self.quotes = {}
+
+    def quote(self, symbol):
+        if symbol not in self.quotes:
+            mid = round(self.rng.uniform(5.0, 500.0), 2)
+            self.quotes[symbol] = {"mid": mid, "spread": 0.01 if mid < 50 else 0.02}
+        q = self.quotes[symbol]
+        bid = round(q["mid"] - q["spread"] / 2, 2)
+        return bid, round(bid + q["spread"], 2)
+
+    def step(self, symbol):
+        self.quote(symbol)
+        q = self.quotes[symbol]
+        q["mid"] = max(0.5, q["mid"] + self.rng.gauss(0.0, q["mid"] * 0.0002))
+        return self.quote(symbol)
+
+
+class SimOrder:
+    def __init__(self, order_id, symbol, exchange, action, quantity, order_type, limit_price):
+        self.order_id = order_id
+        self.perm_id = 1000000 + order_id
+        self.symbol = symbol
+        self.exchange = exchange
+        self.action = action
+        self.quantity = quantity
+        self.order_type = order_type
+        self.limit_price = limit_price
+        self.state = "pending"  # pending (not acked) -> working -> done (filled/cancelled)
+
+
+class Session:
+    """One API client connection"""
+
+    def __init__(self, server, reader, writer):
+        self.server = server
+        self.args = server.args
+        self.reader = reader
+        self.writer = writer
+        self.peer = writer.get_extra_info("peername")
+        self.client_id = 0
+        self.closed = False
+        self.tick_streams = {}  # reqId -> symbol
+        self.tick_due = {}      # reqId -> fractional ticks owed
+        self.trade_streams = {} # reqId -> "Last" / "AllLast" (quote streams are not listed)
+        self.bar_streams = {}   # reqId -> symbol
+        self.history = {}       # reqId -> pending task
+        self.orders = {}        # orderId -> SimOrder
+        self.account_subscribed = False
+        self.tasks = []
+
+    # ---- Transport ----
+
+    def send(self, *fields):
+        if self.closed:
+            return
+        self.writer.write(encode(*fields))
+
+    def error(self, req_id, code, message):
+        self.send(ERR_MSG, 2, req_id, code, message)
+
+    async def read_message(self):
+        header = await self.reader.readexactly(4)
+        (size,) = struct.unpack(">I", header)
+        payload = await self.reader.readexactly(size)
+        return payload.decode(errors="replace").split("\0")[:-1]
+
+    def drop(self, reason):
+        if self.closed:
+            return
+        log(f"[{self.peer}] dropping connection: {reason}")
+        self.closed = True
+        self.writer.close()
+
+    async def run(self):
+        try:
+            await self.handshake()
+            self.tasks = [asyncio.create_task(self.tick_loop()),
+                          asyncio.create_task(self.bar_loop())]
+            while not self.closed:
+                fields = await self.read_message()
+                if fields:
+                    self.dispatch(fields)
+                await self.writer.drain()
+        except asyncio.IncompleteReadError:
+            pass
+        except ConnectionError as e:
+            log(f"[{self.peer}] {e}")
+        finally:
+            self.closed = True
+            for task in self.tasks + list(self.history.values()):
+                task.cancel()
+            self.server.sessions.discard(self)
+            self.writer.close()
+            log(f"[{self.peer}] client {self.client_id} disconnected")
+
+    async def handshake(self):
+        prefix = await self.reader.readexactly(4)
+        if prefix != b"API\0":
+            raise ConnectionError("not an API client")
+        header = await self.reader.readexactly(4)
+        (size,) = struct.unpack(">I", header)
+        versions = (await self.reader.readexactly(size)).decode()
+        match = re.match(r"v(\d+)(?:\.\.v?(\d+))?", versions)
+        if not match or int(match.group(2) or match.group(1)) < SERVER_VERSION:
+            raise ConnectionError(f"unsupported client versions '{versions}'")
+
+        now = datetime.datetime.now().strftime("%Y%m%d %H:%M:%S")
+        self.send(SERVER_VERSION, f"{now} UTC")
+        await self.writer.drain()
+
+        fields = await self.read_message()
+        if not fields or int(fields[0]) != START_API:
+            raise ConnectionError("expected startApi")
+        self.client_id = int(fields[2])
+        log(f"[{self.peer}] client {self.client_id} connected")
+
+        self.send(NEXT_VALID_ID, 1, self.server.next_order_id)
+        self.send(MANAGED_ACCTS, 1, self.args.account)
+        self.error(-1, 2104, "Market data farm connection is OK:usfarm")
+        self.error(-1, 2106, "HMDS data farm connection is OK:ushmds")
+        self.error(-1, 2158, "Sec-def data farm connection is OK:secdefnj")
+
+    # ---- Requests ----
+
+    def dispatch(self, f):
+        msg_id = int(f[0])
+        if msg_id == REQ_TICK_BY_TICK_DATA:
+            self.req_tick_by_tick(int(f[1]), f[3], f[14])
+        elif msg_id == CANCEL_TICK_BY_TICK_DATA:
+            self.tick_streams.pop(int(f[1]), None)
+            self.tick_due.pop(int(f[1]), None)
+            self.trade_streams.pop(int(f[1]), None)
+        elif msg_id == REQ_REAL_TIME_BARS:
+            self.bar_streams[int(f[2])] = f[4]
+        elif msg_id == CANCEL_REAL_TIME_BARS:
+            self.bar_streams.pop(int(f[2]), None)
+        elif msg_id == REQ_HISTORICAL_DATA:
+            req_id = int(f[1])
+            self.history[req_id] = asyncio.create_task(
+                self.historical_data(req_id, f[3], f[15], f[16], f[17]))
+        elif msg_id == CANCEL_HISTORICAL_DATA:
+            task = self.history.pop(int(f[2]), None)
+            if task:
+                task.cancel()
+        elif msg_id == PLACE_ORDER:
+            self.place_order(int(f[1]), f[3], f[10], f[16], float(f[17]), f[18], float(f[19] or 0))
+        elif msg_id == CANCEL_ORDER:
+            self.cancel_order(int(f[2]))
+        elif msg_id == REQ_GLOBAL_CANCEL:
+            for order_id in [o.order_id for o in self.orders.values() if o.state != "done"]:
+                self.cancel_order(order_id)
+        elif msg_id == REQ_IDS:
+            self.send(NEXT_VALID_ID, 1, self.server.next_order_id)
+        elif msg_id == REQ_MANAGED_ACCTS:
+            self.send(MANAGED_ACCTS, 1, self.args.account)
+        elif msg_id == REQ_ACCT_DATA:
+            self.account_subscribed = f[2] == "1"
+            if self.account_subscribed:
+                self.send_account()
+        elif msg_id in (REQ_ALL_OPEN_ORDERS, REQ_OPEN_ORDERS):
+            self.send(OPEN_ORDER_END, 1)
+        elif msg_id == REQ_COMPLETED_ORDERS:
+            self.send(COMPLETED_ORDERS_END)
+        elif msg_id == REQ_POSITIONS:
+            self.send(POSITION_END, 1)
+        elif msg_id == REQ_CURRENT_TIME:
+            self.send(CURRENT_TIME, 1, int(time.time()))
+        elif msg_id == REQ_MATCHING_SYMBOLS:
+            self.matching_symbols(int(f[1]), f[2])
+        elif msg_id == QUERY_DISPLAY_GROUPS:
+            self.send(DISPLAY_GROUP_LIST, 1, int(f[2]), "1|2|3|4|5|6|7")
+        elif msg_id in (REQ_AUTO_OPEN_ORDERS, SUBSCRIBE_TO_GROUP_EVENTS, UPDATE_DISPLAY_GROUP,
+                        UNSUBSCRIBE_FROM_GROUP_EVENTS, REQ_MKT_DATA, CANCEL_MKT_DATA):
+            pass
+        else:
+            log(f"[{self.peer}] ignoring unsupported message {msg_id}")
+
+    def req_tick_by_tick(self, req_id, symbol, tick_type):
+        if tick_type not in ("BidAsk", "Last", "AllLast"):
+            self.error(req_id, 10190, f"Tick-by-tick type {tick_type} is not simulated")
+            return
+        limit = self.args.max_tick_streams
+        if limit and len(self.tick_streams) >= limit:
+            self.error(req_id, 10190, "Max number of tick-by-tick requests has been reached.")
+            return
+        self.tick_streams[req_id] = symbol
+        self.tick_due[req_id] = 0.0
+        if tick_type != "BidAsk":
+            self.trade_streams[req_id] = tick_type
+
+    async def historical_data(self, req_id, symbol, end_text, bar_size_text, duration_text):
+        try:
+            await asyncio.sleep(self.args.hist_delay)
+            if self.server.rng.random() < self.args.pacing_violation_rate:
+                self.error(req_id, 162, "Historical Market Data Service error message:"
+                                        "Historical data request pacing violation")
+                return
+
+            end = parse_end_time(end_text)
+            bar_seconds = parse_bar_size(bar_size_text)
+            count = min(parse_duration(duration_text) // bar_seconds, MAX_HISTORICAL_BARS)
+            end -= end % bar_seconds
+
+            # Walk backwards from the live price so history joins the stream
+            rng = random.Random(f"{symbol}:{end}:{bar_seconds}")
+            close = sum(self.server.market.quote(symbol)) / 2
+            bars = []
+            for i in range(count):
+                open_ = close * (1 + rng.gauss(0.0, 0.0003 * bar_seconds ** 0.5))
+                high = max(open_, close) * (1 + abs(rng.gauss(0.0, 0.0002)))
+                low = min(open_, close) * (1 - abs(rng.gauss(0.0, 0.0002)))
+                volume = rng.randint(100, 5000) * max(1, bar_seconds // 5)
+                bars.append((end - (i + 1) * bar_seconds, open_, high, low, close, volume))
+                close = open_
+            bars.reverse()
+
+            fields = [HISTORICAL_DATA, req_id, "", "", len(bars)]
+            for t, o, h, l, c, v in bars:
+                fields += [t, round(o, 2), round(h, 2), round(l, 2), round(c, 2), v, round((o + c) / 2, 2), v // 100 + 1]
+            self.send(*fields)
+        finally:
+            self.history.pop(req_id, None)
+
+    def matching_symbols(self, req_id, pattern):
+        pattern = pattern.upper()
+        matches = [s for s in self.server.universe if s.startswith(pattern)][:16]
+        if pattern and pattern not in matches and pattern.isalnum():
+            matches.insert(0, pattern)
+        fields = [SYMBOL_SAMPLES, req_id, len(matches)]
+        for symbol in matches:
+            fields += [self.server.con_id(symbol), symbol, "STK", "NASDAQ", "USD", 0]
+        self.send(*fields)
+
+    # ---- Orders ----
+
+    def place_order(self, order_id, symbol, primary_exchange, action, quantity, order_type, limit_price):
+        self.server.next_order_id = max(self.server.next_order_id, order_id + 1)
+        order = self.orders.get(order_id)
+        if order is not None and order.state == "done":
+            self.error(order_id, 10148, f"OrderId {order_id} that needs to be modified cannot be modified")
+            return
+        if order is None:
+            order = SimOrder(order_id, symbol, primary_exchange, action, quantity, order_type, limit_price)
+            self.orders[order_id] = order
+        else:
+            order.action, order.quantity = action, quantity
+            order.order_type, order.limit_price = order_type, limit_price
+        asyncio.create_task(self.ack_order(order))
+
+    async def ack_order(self, order):
+        await self.ack_delay()
+        if self.closed or order.state == "done":
+            return
+        order.state = "working"
+        self.order_status(order, "Submitted", 0, order.quantity, 0.0, 0.0)
+        self.try_fill(order, *self.server.market.quote(order.symbol))
+
+    def cancel_order(self, order_id):
+        order = self.orders.get(order_id)
+        if order is None or order.state == "done":
+            self.error(order_id, 10147, f"OrderId {order_id} that needs to be cancelled is not found.")
+            return
+        asyncio.create_task(self.ack_cancel(order))
+
+    async def ack_cancel(self, order):
+        await self.ack_delay()
+        if self.closed or order.state == "done":
+            return
+        order.state = "done"
+        self.order_status(order, "Cancelled", 0, order.quantity, 0.0, 0.0)
+        self.error(order.order_id, 202, "Order Canceled - reason:")
+
+    async def ack_delay(self):
+        delay = self.args.ack_delay + self.server.rng.uniform(0, self.args.ack_jitter)
+        if delay > 0:
+            await asyncio.sleep(delay / 1000.0)
+
+    def try_fill(self, order, bid, ask):
+        if order.state != "working":
+            return
+        buy = order.action == "BUY"
+        if order.order_type == "LMT":
+            if buy and order.limit_price < ask:
+                return
+            if not buy and order.limit_price > bid:
+                return
+        price = ask if buy else bid
+        order.state = "done"
+
+        self.server.exec_seq += 1
+        exec_id = f"0000e0d5.{self.server.exec_seq:08x}.01.01"
+        exec_time = datetime.datetime.now().strftime("%Y%m%d %H:%M:%S")
+        self.send(EXECUTION_DATA, -1, order.order_id, self.server.con_id(order.symbol), order.symbol, "STK",
+                  "", 0.0, "", "", "SMART", "USD", order.symbol, "NMS", exec_id, exec_time,
+                  self.args.account, "ISLAND", "BOT" if buy else "SLD", order.quantity, price,
+                  order.perm_id, self.client_id, 0, order.quantity, price, "", "", "", "", 1)
+        self.order_status(order, "Filled", order.quantity, 0, price, price)
+
+        position = self.server.positions.setdefault(order.symbol, [0.0, 0.0])  # [qty, avg cost]
+        delta = order.quantity if buy else -order.quantity
+        if position[0] == 0 or (position[0] > 0) == (delta > 0):
+            position[1] = (position[0] * position[1] + delta * price) / (position[0] + delta)
+        position[0] += delta
+        if position[0] == 0:
+            position[1] = 0.0
+        log(f"[{self.peer}] filled {order.action} {order.quantity:g} {order.symbol} @ {price:.2f}")
+        for session in list(self.server.sessions):
+            if session.account_subscribed:
+                session.send_portfolio(order.symbol)
+
+    def order_status(self, order, status, filled, remaining, avg_price, last_price):
+        self.send(ORDER_STATUS, order.order_id, status, filled, remaining, avg_price, order.perm_id,
+                  0, last_price, self.client_id, "", 0.0)
+
+    # ---- Account ----
+
+    def send_account(self):
+        acct = self.args.account
+        for key, value in (("NetLiquidation", "1000000.00"), ("AvailableFunds", "1000000.00"),
+                           ("BuyingPower", "4000000.00"), ("TotalCashValue", "1000000.00")):
+            self.send(ACCT_VALUE, 2, key, value, "USD", acct)
+        for symbol in self.server.positions:
+            self.send_portfolio(symbol)
+        self.send(ACCT_UPDATE_TIME, 1, datetime.datetime.now().strftime("%H:%M"))
+        self.send(ACCT_DOWNLOAD_END, 1, acct)
+
+    def send_portfolio(self, symbol):
+        qty, avg_cost = self.server.positions.get(symbol, (0.0, 0.0))
+        bid, ask = self.server.market.quote(symbol)
+        mark = (bid + ask) / 2
+        self.send(PORTFOLIO_VALUE, 8, self.server.con_id(symbol), symbol, "STK", "", 0.0, "", "", "NASDAQ",
+                  "USD", symbol, "NMS", qty, mark, qty * mark, avg_cost, qty * (mark - avg_cost), 0.0,
+                  self.args.account)
+
+    # ---- Streams ----
+
+    async def tick_loop(self):
+        try:
+            await self._tick_loop()
+        except ConnectionError:
+            self.closed = True
+
+    async def bar_loop(self):
+        try:
+            await self._bar_loop()
+        except ConnectionError:
+            self.closed = True
+
+    async def _tick_loop(self):
+        interval = self.args.tick_interval / 1000.0
+        last = time.monotonic()
+        while not self.closed:
+            await asyncio.sleep(interval)
+            now = time.monotonic()
+            elapsed, last = now - last, now
+            if self.server.in_outage():
+                continue
+
+            rate = self.args.tick_rate * self.server.burst_factor()
+            stamp = int(time.time())
+            for req_id, symbol in list(self.tick_streams.items()):
+                self.tick_due[req_id] += rate * elapsed
+                ticks = int(self.tick_due[req_id])
+                self.tick_due[req_id] -= ticks
+                if req_id in self.trade_streams:
+                    self.send_trades(req_id, symbol, ticks, stamp)
+                    continue
+                for _ in range(ticks):
+                    bid, ask = self.server.market.step(symbol)
+                    self.server.record_trade(symbol, bid, ask)
+                    size = self.server.rng.randint(1, 20) * 100
+                    self.send(TICK_BY_TICK, req_id, 3, stamp, bid, ask, size, size, 0)
+                if ticks:
+                    for order in list(self.orders.values()):
+                        if order.state == "working" and order.symbol == symbol:
+                            self.try_fill(order, bid, ask)
+            await self.writer.drain()
+
+    def send_trades(self, req_id, symbol, count, stamp):
+        rng = self.server.rng
+        all_last = self.trade_streams[req_id] == "AllLast"
+        for _ in range(count):
+            bid, ask = self.server.market.quote(symbol)
+            price = ask if rng.random() < 0.5 else bid
+            size = rng.randint(1, 10) * 100
+            if all_last and rng.random() < 0.2:
+                size = rng.randint(1, 99)  # Odd lot, condition "I"
+            exchange = rng.choice(TRADE_VENUES) if all_last else "NASDAQ"
+            conditions = "I" if all_last and size < 100 else ""
+            # tickType 1 = Last, 2 = AllLast; mask 0 (not past limit, reported)
+            self.send(TICK_BY_TICK, req_id, 2 if all_last else 1, stamp, price, size, 0, exchange, conditions)
+
+    async def _bar_loop(self):
+        while not self.closed:
+            await asyncio.sleep(5.0 - time.time() % 5.0)
+            if self.server.in_outage():
+                continue
+            start = int(time.time()) // 5 * 5 - 5
+            for req_id, symbol in list(self.bar_streams.items()):
+                o, h, l, c, volume = self.server.bar_for(symbol, start)
+                self.send(REAL_TIME_BARS, 3, req_id, start, o, h, l, c, volume, round((h + l) / 2, 4),
+                          volume // 100 + 1)
+
+
+class Server:
+    def __init__(self, args):
+        self.args = args
+        self.rng = random.Random(args.seed)
+        self.market = Market(args.seed)
+        self.sessions = set()
+        self.next_order_id = args.next_order_id
+        self.exec_seq = 0
+        self.positions = {}
+        self.con_ids = {}
+        self.bars = {}  # symbol -> {bar start -> [o, h, l, c, volume]}
+        self.outage_until = 0.0
+        self.burst_until = 0.0
+        self.universe = list(DEFAULT_UNIVERSE) + [f"SIM{i:04d}" for i in range(args.symbols)]
+
+    def con_id(self, symbol):
+        return self.con_ids.setdefault(symbol, 265598 + len(self.con_ids))
+
+    def in_outage(self):
+        return time.monotonic() < self.outage_until
+
+    def burst_factor(self):
+        return self.args.burst_factor if time.monotonic() < self.burst_until else 1.0
+
+    def record_trade(self, symbol, bid, ask):
+        start = int(time.time()) // 5 * 5
+        price = round((bid + ask) / 2, 2)
+        bars = self.bars.setdefault(symbol, {})
+        bar = bars.get(start)
+        if bar is None:
+            bars[start] = [price, price, price, price, 0]
+            for old in [t for t in bars if t < start - 10]:
+                del bars[old]
+            bar = bars[start]
+        bar[1], bar[2], bar[3] = max(bar[1], price), min(bar[2], price), price
+        bar[4] += self.rng.randint(1, 10) * 100
+
+    def bar_for(self, symbol, start):
+        bar = self.bars.get(symbol, {}).get(start)
+        if bar is not None:
+            return tuple(bar)
+        # No ticks for this symbol (not streamed) - a flat bar at the current mid
+        mid = round(sum(self.market.step(symbol)) / 2, 2)
+        return mid, mid, mid, mid, self.rng.randint(1, 50) * 100
+
+    async def faults(self):
+        """Scheduled fault injection and bursts, shared by all connections"""
+        args = self.args
+        now = time.monotonic()
+        next_drop = now + args.disconnect_every if args.disconnect_every else None
+        next_1100 = now + args.error_1100_every if args.error_1100_every else None
+        next_1300 = now + args.error_1300_every if args.error_1300_every else None
+        next_burst = now + args.burst_every if args.burst_every else None
+        restore_at = None
+        while True:
+            await asyncio.sleep(0.1)
+            now = time.monotonic()
+            if next_drop and now >= next_drop:
+                next_drop = now + args.disconnect_every
+                for session in list(self.sessions):
+                    session.drop("scheduled disconnect")
+            if next_1100 and now >= next_1100:
+                next_1100 = now + args.error_1100_every
+                self.outage_until = now + args.outage
+                restore_at = self.outage_until
+                log(f"injecting 1100, outage {args.outage:.1f}s")
+                for session in list(self.sessions):
+                    session.error(-1, 1100, "Connectivity between IB and Trader Workstation has been lost.")
+            if restore_at and now >= restore_at:
+                restore_at = None
+                for session in list(self.sessions):
+                    session.error(-1, 1102, "Connectivity between IB and Trader Workstation has been restored"
+                                            " - data maintained.")
+            if next_1300 and now >= next_1300:
+                next_1300 = now + args.error_1300_every
+                for session in list(self.sessions):
+                    session.error(-1, 1300, f"TWS socket port has been reset and this connection is being "
+                                            f"dropped. Please reconnect on port {args.port}")
+                    session.drop("port reset (1300)")
+            if next_burst and now >= next_burst:
+                next_burst = now + args.burst_every
+                self.burst_until = now + args.burst_seconds
+                log(f"burst x{args.burst_factor:g} for {args.burst_seconds:.1f}s")
+
+    async def handle(self, reader, writer):
+        session = Session(self, reader, writer)
+        self.sessions.add(session)
+        await session.run()
+
+    async def serve(self):
+        server = await asyncio.start_server(self.handle, self.args.host, self.args.port)
+        log(f"TWS simulator (server version {SERVER_VERSION}) listening on {self.args.host}:{self.args.port}")
+        async with server:
+            await asyncio.gather(server.serve_forever(), self.faults())
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Local TWS protocol simulator for offline load testing")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=7496)
+    parser.add_argument("--account", default="DU0000000", help="Managed account id")
+    parser.add_argument("--next-order-id", type=int, default=1)
+    parser.add_argument("--seed", type=int, default=42)
+    parser.add_argument("--symbols", type=int, default=0,
+                        help="Extra synthetic symbols (SIM0000...) offered by symbol search")
+
+    load = parser.add_argument_group("load")
+    load.add_argument("--tick-rate", type=float, default=5.0, help="BidAsk ticks/sec per tick-by-tick stream")
+    load.add_argument("--tick-interval", type=float, default=10.0, help="Tick batching interval, ms")
+    load.add_argument("--burst-every", type=float, default=0.0, help="Start a burst every N seconds (0 = off)")
+    load.add_argument("--burst-seconds", type=float, default=2.0)
+    load.add_argument("--burst-factor", type=float, default=10.0, help="Tick rate multiplier during a burst")
+    load.add_argument("--max-tick-streams", type=int, default=0,
+                      help="Reject tick-by-tick requests above this count with error 10190 (0 = unlimited)")
+
+    faults = parser.add_argument_group("faults")
+    faults.add_argument("--ack-delay", type=float, default=0.0, help="Order/cancel ack delay, ms")
+    faults.add_argument("--ack-jitter", type=float, default=0.0, help="Random extra ack delay, ms")
+    faults.add_argument("--hist-delay", type=float, default=0.2, help="Historical data response delay, s")
+    faults.add_argument("--pacing-violation-rate", type=float, default=0.0,
+                        help="Fraction of historical requests answered with a 162 pacing violation")
+    faults.add_argument("--disconnect-every", type=float, default=0.0, help="Drop all connections every N s")
+    faults.add_argument("--error-1100-every", type=float, default=0.0, help="Send 1100 every N s")
+    faults.add_argument("--outage", type=float, default=5.0, help="Seconds without data after 1100 (then 1102)")
+    faults.add_argument("--error-1300-every", type=float, default=0.0,
+                        help="Send 1300 and drop the connection every N s")
+
+    try:
+        asyncio.run(Server(parser.parse_args()).serve())
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
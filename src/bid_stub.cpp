@@ -12,12 +12,12 @@
 //
 // We lose some precision for very large numbers, but for stock quantities
 // (typically < 1 million shares), double precision (15-17 digits) is sufficient.
+//
+// String conversions run for every size/position/quantity field TWS sends, so they
+// go through FastDecimal (integer digit accumulation, no std::string, stream or
+// exception) instead of std::stod / std::ostringstream.
 
-#include <string>
-#include <sstream>
-#include <iomanip>
-#include <cmath>
-#include <cstring>
+#include "utils/fastdecimal.h"
 
 extern "C" {
 
@@ -50,27 +50,23 @@ UINT64 __bid64_from_string(char* ps, unsigned int rounding_mode, unsigned int* f
         return 0;
     }
 
-    try {
-        double val = std::stod(ps);
-        if (flags) *flags = 0;
-        return __binary64_to_bid64(val, 0, nullptr);
-    } catch (...) {
+    double val = 0.0;
+    if (!FastDecimal::parse(ps, val)) {
         if (flags) *flags = 0x01; // Invalid flag
         return 0;
     }
+    if (flags) *flags = 0;
+    return __binary64_to_bid64(val, 0, nullptr);
 }
 
 // Note: Legacy void __bid64_from_string(char*, UINT64*) removed
 // because C extern "C" doesn't support overloading.
 // TWS API uses the UINT64 return version.
 
-// Convert BID64 to string
+// Convert BID64 to string (6 decimals, at most FastDecimal::FORMAT_CAPACITY bytes)
 void __bid64_to_string(char* ps, UINT64 x, unsigned int* flags) {
     if (ps) {
-        double val = __bid64_to_binary64(x, 0, nullptr);
-        std::ostringstream oss;
-        oss << std::fixed << std::setprecision(6) << val;
-        std::strcpy(ps, oss.str().c_str());
+        FastDecimal::formatFixed6(__bid64_to_binary64(x, 0, nullptr), ps);
         if (flags) *flags = 0;
     }
 }
@@ -36,11 +36,14 @@ void DisplayGroupManager::updateActiveSymbol(const QString& symbol, const QStrin
 
     int reqId = m_nextReqId++;
 
-    // Subscribe to group events (if not already subscribed, TWS will handle it)
-    m_client->subscribeToGroupEvents(reqId, groupId);
-
-    // Update the display group with new contract
-    m_client->updateDisplayGroup(reqId, contractInfo);
+    // Client runs on the engine thread
+    QMetaObject::invokeMethod(m_client, [client = m_client, reqId, groupId, contractInfo]() {
+        // Subscribe to group events (if not already subscribed, TWS will handle it)
+        client->subscribeToGroupEvents(reqId, groupId);
+
+        // Update the display group with new contract
+        client->updateDisplayGroup(reqId, contractInfo);
+    });
 }
 
 void DisplayGroupManager::queryDisplayGroups()
@@ -51,7 +54,9 @@ void DisplayGroupManager::queryDisplayGroups()
     }
 
     int reqId = m_nextReqId++;
-    m_client->queryDisplayGroups(reqId);
+    QMetaObject::invokeMethod(m_client, [client = m_client, reqId]() {
+        client->queryDisplayGroups(reqId);
+    });
 }
 
 void DisplayGroupManager::onDisplayGroupListReceived(int reqId, const QString& groups)
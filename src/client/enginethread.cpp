@@ -0,0 +1,56 @@
+#include "client/enginethread.h"
+#include "client/ibkrclient.h"
+#include "models/tickerdatamanager.h"
+#include "trading/tradingmanager.h"
+#include "trading/orderlane.h"
+#include "client/marketjournal.h"
+
+EngineThread::EngineThread(QObject* parent)
+    : QThread(parent)
+    , m_client(nullptr)
+    , m_tickerDataManager(nullptr)
+    , m_tradingManager(nullptr)
+    , m_orderLane(nullptr)
+    , m_replayer(nullptr)
+{
+    setObjectName("EngineThread");
+    start(QThread::HighestPriority);
+    m_ready.acquire();
+}
+
+EngineThread::~EngineThread()
+{
+    // Commands already queued by widgets (e.g. cancel orders on quit) still reach TWS;
+    // the order lane's high-priority event is handled before this one
+    QMetaObject::invokeMethod(m_client, []() {}, Qt::BlockingQueuedConnection);
+
+    quit();
+    wait();
+}
+
+void EngineThread::run()
+{
+    // Created here so their timers and queued calls belong to this thread
+    m_client = new IBKRClient();
+    m_tradingManager = new TradingManager(m_client);
+    m_tickerDataManager = new TickerDataManager(m_client);
+    m_orderLane = new OrderLane(m_tradingManager, m_client);
+    QObject::connect(m_tickerDataManager, &TickerDataManager::tradingSymbolChanged,
+                     m_tradingManager, &TradingManager::setSymbol, Qt::DirectConnection);
+    m_replayer = new JournalReplayer(m_client);
+    m_ready.release();
+
+    exec();
+
+    // Managers hold the client pointer - delete it last
+    delete m_replayer;
+    delete m_orderLane;
+    delete m_tickerDataManager;
+    delete m_tradingManager;
+    delete m_client;
+    m_orderLane = nullptr;
+    m_replayer = nullptr;
+    m_tickerDataManager = nullptr;
+    m_tradingManager = nullptr;
+    m_client = nullptr;
+}
@@ -0,0 +1,49 @@
+#ifndef ENGINETHREAD_H
+#define ENGINETHREAD_H
+
+#include <QThread>
+#include <QSemaphore>
+
+class IBKRClient;
+class TickerDataManager;
+class TradingManager;
+class OrderLane;
+class JournalReplayer;
+
+/**
+ * @brief Thread that owns the TWS client, market data and trading state
+ *
+ * IBKRClient (with its wrapper), TickerDataManager and TradingManager are created,
+ * run and destroyed on this thread, so wrapper callbacks, bar aggregation and order
+ * handling never wait behind a chart replot or an order table rebuild. Widgets talk
+ * to them through signals, queued calls (QMetaObject::invokeMethod with the engine
+ * object as context) and the snapshot getters (TradingManager::snapshot(),
+ * TickerDataManager::barsSnapshot()).
+ */
+class EngineThread : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit EngineThread(QObject* parent = nullptr); // Returns once the engine objects exist
+    ~EngineThread(); // Stops the event loop, the objects are deleted on the engine thread
+
+    IBKRClient* client() const { return m_client; }
+    TickerDataManager* tickerDataManager() const { return m_tickerDataManager; }
+    TradingManager* tradingManager() const { return m_tradingManager; }
+    OrderLane* orderLane() const { return m_orderLane; } // Hotkeys -> TradingManager
+    JournalReplayer* replayer() const { return m_replayer; } // Idle unless a journal is replayed
+
+protected:
+    void run() override;
+
+private:
+    IBKRClient* m_client;
+    TickerDataManager* m_tickerDataManager;
+    TradingManager* m_tradingManager;
+    OrderLane* m_orderLane;
+    JournalReplayer* m_replayer;
+    QSemaphore m_ready;
+};
+
+#endif // ENGINETHREAD_H
@@ -0,0 +1,303 @@
+#include "client/historicalrequestscheduler.h"
+#include "client/ibkrclient.h"
+#include "utils/logger.h"
+#include <QTimer>
+#include <QDateTime>
+
+// TWS historical data pacing limits
+static const int MAX_REQUESTS_PER_WINDOW = 60;
+static const qint64 REQUEST_WINDOW_MS = 10 * 60 * 1000;
+static const qint64 IDENTICAL_REQUEST_INTERVAL_MS = 15 * 1000;
+static const int MAX_REQUESTS_PER_CONTRACT = 6;
+static const qint64 CONTRACT_WINDOW_MS = 2 * 1000;
+static const int MAX_IN_FLIGHT = 50; // TWS limit of simultaneous open historical requests
+
+// Backoff after a pacing violation
+static const int INITIAL_BACKOFF_MS = 15 * 1000;
+static const int MAX_BACKOFF_MS = 10 * 60 * 1000;
+
+HistoricalRequestScheduler::HistoricalRequestScheduler(IBKRClient* client, QObject* parent)
+    : QObject(parent)
+    , m_client(client)
+    , m_nextSequence(0)
+    , m_pausedUntilMs(0)
+    , m_backoffMs(INITIAL_BACKOFF_MS)
+    , m_totalWaitMs(0)
+{
+    m_dispatchTimer = new QTimer(this);
+    m_dispatchTimer->setSingleShot(true);
+    connect(m_dispatchTimer, &QTimer::timeout, this, &HistoricalRequestScheduler::dispatch);
+
+    connect(m_client, &IBKRClient::historicalDataFinished, this, &HistoricalRequestScheduler::onHistoricalDataFinished);
+    connect(m_client, &IBKRClient::error, this, &HistoricalRequestScheduler::onError);
+    connect(m_client, &IBKRClient::disconnected, this, &HistoricalRequestScheduler::onDisconnected);
+    connect(m_client, &IBKRClient::connected, this, [this]() { scheduleDispatch(); });
+}
+
+QString HistoricalRequestScheduler::requestKey(const HistoricalRequest& request)
+{
+    // Owner, not symbol: SYM@NASDAQ and SYM@ARCA are different contracts with the same symbol
+    return QString("%1|%2|%3|%4").arg(request.owner, request.endDateTime, request.duration, request.barSize);
+}
+
+QString HistoricalRequestScheduler::coalesceKey(const HistoricalRequest& request)
+{
+    return requestKey(request) + QString("|%1").arg(static_cast<int>(request.purpose));
+}
+
+int HistoricalRequestScheduler::submit(int reqId, const HistoricalRequest& request)
+{
+    QString key = coalesceKey(request);
+
+    // Coalesce with an identical request that is still queued or in flight
+    for (Entry& entry : m_queue) {
+        if (coalesceKey(entry.request) == key) {
+            if (request.priority < entry.request.priority) {
+                entry.request.priority = request.priority;
+            }
+            m_metrics.coalesced++;
+            LOG_DEBUG(QString("Historical request for %1 [%2] coalesced with queued reqId %3").arg(request.symbol).arg(request.barSize).arg(entry.reqId));
+            return entry.reqId;
+        }
+    }
+    for (auto it = m_inFlight.constBegin(); it != m_inFlight.constEnd(); ++it) {
+        if (coalesceKey(it->request) == key) {
+            m_metrics.coalesced++;
+            LOG_DEBUG(QString("Historical request for %1 [%2] coalesced with in-flight reqId %3").arg(request.symbol).arg(request.barSize).arg(it.key()));
+            return it.key();
+        }
+    }
+
+    m_queue.append(Entry{reqId, request, QDateTime::currentMSecsSinceEpoch(), m_nextSequence++});
+    scheduleDispatch();
+    return reqId;
+}
+
+QList<int> HistoricalRequestScheduler::cancelOwner(const QString& owner, HistoricalRequestPriority lowest)
+{
+    QList<int> cancelled;
+
+    for (auto it = m_queue.begin(); it != m_queue.end();) {
+        if (it->request.owner == owner && it->request.priority <= lowest) {
+            cancelled.append(it->reqId);
+            it = m_queue.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto it = m_inFlight.begin(); it != m_inFlight.end();) {
+        if (it->request.owner == owner && it->request.priority <= lowest) {
+            m_client->cancelHistoricalData(it.key());
+            cancelled.append(it.key());
+            it = m_inFlight.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (!cancelled.isEmpty()) {
+        m_metrics.cancelled += cancelled.size();
+        LOG_DEBUG(QString("Cancelled %1 historical request(s) for %2").arg(cancelled.size()).arg(owner));
+        scheduleDispatch(); // Freed in-flight slots
+    }
+    return cancelled;
+}
+
+void HistoricalRequestScheduler::setFocusOwner(const QString& owner)
+{
+    m_focusOwner = owner;
+}
+
+bool HistoricalRequestScheduler::isPending(int reqId) const
+{
+    if (m_inFlight.contains(reqId)) return true;
+    for (const Entry& entry : m_queue) {
+        if (entry.reqId == reqId) return true;
+    }
+    return false;
+}
+
+HistoricalSchedulerMetrics HistoricalRequestScheduler::metrics() const
+{
+    HistoricalSchedulerMetrics metrics = m_metrics;
+    metrics.queueDepth = m_queue.size();
+    metrics.inFlight = m_inFlight.size();
+    metrics.sentLast10Min = m_sentTimes.size();
+    metrics.averageWaitMs = metrics.sent > 0 ? static_cast<double>(m_totalWaitMs) / metrics.sent : 0.0;
+    return metrics;
+}
+
+bool HistoricalRequestScheduler::isMoreUrgent(const Entry& a, const Entry& b) const
+{
+    if (a.request.priority != b.request.priority) {
+        return a.request.priority < b.request.priority;
+    }
+    bool aFocused = !m_focusOwner.isEmpty() && a.request.owner == m_focusOwner;
+    bool bFocused = !m_focusOwner.isEmpty() && b.request.owner == m_focusOwner;
+    if (aFocused != bFocused) {
+        return aFocused;
+    }
+    return a.sequence < b.sequence;
+}
+
+qint64 HistoricalRequestScheduler::blockedForMs(const Entry& entry, qint64 nowMs) const
+{
+    qint64 wait = 0;
+
+    auto lastIt = m_lastSentByKey.constFind(requestKey(entry.request));
+    if (lastIt != m_lastSentByKey.constEnd()) {
+        wait = qMax(wait, lastIt.value() + IDENTICAL_REQUEST_INTERVAL_MS - nowMs);
+    }
+
+    auto symbolIt = m_sentBySymbol.constFind(entry.request.symbol);
+    if (symbolIt != m_sentBySymbol.constEnd() && symbolIt->size() >= MAX_REQUESTS_PER_CONTRACT) {
+        wait = qMax(wait, symbolIt->first() + CONTRACT_WINDOW_MS - nowMs);
+    }
+
+    return wait;
+}
+
+void HistoricalRequestScheduler::pruneHistory(qint64 nowMs)
+{
+    while (!m_sentTimes.isEmpty() && nowMs - m_sentTimes.first() >= REQUEST_WINDOW_MS) {
+        m_sentTimes.removeFirst();
+    }
+
+    for (auto it = m_sentBySymbol.begin(); it != m_sentBySymbol.end();) {
+        QList<qint64>& times = it.value();
+        while (!times.isEmpty() && nowMs - times.first() >= CONTRACT_WINDOW_MS) {
+            times.removeFirst();
+        }
+        if (times.isEmpty()) {
+            it = m_sentBySymbol.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto it = m_lastSentByKey.begin(); it != m_lastSentByKey.end();) {
+        if (nowMs - it.value() >= IDENTICAL_REQUEST_INTERVAL_MS) {
+            it = m_lastSentByKey.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void HistoricalRequestScheduler::dispatch()
+{
+    if (!m_client->isConnected()) return; // Resumed on connected()
+
+    qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    pruneHistory(nowMs);
+
+    while (!m_queue.isEmpty()) {
+        if (m_inFlight.size() >= MAX_IN_FLIGHT) return; // Resumed when a request finishes
+
+        if (nowMs < m_pausedUntilMs) {
+            scheduleDispatch(m_pausedUntilMs - nowMs);
+            return;
+        }
+        if (m_sentTimes.size() >= MAX_REQUESTS_PER_WINDOW) {
+            scheduleDispatch(m_sentTimes.first() + REQUEST_WINDOW_MS - nowMs);
+            return;
+        }
+
+        // Most urgent request not held back by per-contract or identical request limits
+        int pick = -1;
+        qint64 earliestWait = -1;
+        for (int i = 0; i < m_queue.size(); ++i) {
+            qint64 wait = blockedForMs(m_queue[i], nowMs);
+            if (wait > 0) {
+                earliestWait = (earliestWait < 0) ? wait : qMin(earliestWait, wait);
+            } else if (pick < 0 || isMoreUrgent(m_queue[i], m_queue[pick])) {
+                pick = i;
+            }
+        }
+
+        if (pick < 0) {
+            scheduleDispatch(earliestWait);
+            return;
+        }
+
+        send(m_queue.takeAt(pick), nowMs);
+    }
+}
+
+void HistoricalRequestScheduler::send(const Entry& entry, qint64 nowMs)
+{
+    const HistoricalRequest& request = entry.request;
+    m_client->requestHistoricalData(entry.reqId, request.symbol, request.endDateTime, request.duration, request.barSize);
+    m_inFlight[entry.reqId] = entry;
+
+    m_sentTimes.append(nowMs);
+    m_sentBySymbol[request.symbol].append(nowMs);
+    m_lastSentByKey[requestKey(request)] = nowMs;
+
+    qint64 waitMs = nowMs - entry.submittedMs;
+    m_metrics.sent++;
+    m_metrics.lastWaitMs = waitMs;
+    m_metrics.maxWaitMs = qMax(m_metrics.maxWaitMs, waitMs);
+    m_totalWaitMs += waitMs;
+
+    LOG_DEBUG(QString("Historical request %1 sent for %2 [%3, %4] after %5 ms in queue (queued: %6, in flight: %7, last 10 min: %8)")
+        .arg(entry.reqId).arg(request.symbol).arg(request.barSize).arg(request.duration).arg(waitMs)
+        .arg(m_queue.size()).arg(m_inFlight.size()).arg(m_sentTimes.size()));
+}
+
+void HistoricalRequestScheduler::scheduleDispatch(qint64 delayMs)
+{
+    m_dispatchTimer->start(static_cast<int>(qMax<qint64>(0, delayMs)));
+}
+
+void HistoricalRequestScheduler::onHistoricalDataFinished(int reqId)
+{
+    if (m_inFlight.remove(reqId) == 0) return;
+
+    m_backoffMs = INITIAL_BACKOFF_MS; // TWS accepts requests again
+    if (!m_queue.isEmpty()) {
+        scheduleDispatch();
+    }
+}
+
+void HistoricalRequestScheduler::onError(int id, int code, const QString& message)
+{
+    auto it = m_inFlight.find(id);
+    if (it == m_inFlight.end()) return;
+
+    // Pacing violation or too many open requests - TWS dropped it, send again later
+    bool isPacing = (code == 162 && message.contains("pacing violation", Qt::CaseInsensitive)) || code == 322;
+    if (isPacing) {
+        Entry entry = it.value();
+        m_inFlight.erase(it);
+        m_queue.prepend(entry);
+        m_metrics.pacingViolations++;
+
+        m_pausedUntilMs = QDateTime::currentMSecsSinceEpoch() + m_backoffMs;
+        LOG_WARNING(QString("Historical data pacing violation for %1 (reqId %2), pausing requests for %3 s")
+            .arg(entry.request.symbol).arg(id).arg(m_backoffMs / 1000));
+        m_backoffMs = qMin(m_backoffMs * 2, MAX_BACKOFF_MS);
+        scheduleDispatch(m_pausedUntilMs - QDateTime::currentMSecsSinceEpoch());
+        return;
+    }
+
+    m_inFlight.erase(it);
+    emit requestFailed(id, code, message);
+    if (!m_queue.isEmpty()) {
+        scheduleDispatch();
+    }
+}
+
+void HistoricalRequestScheduler::onDisconnected()
+{
+    if (m_inFlight.isEmpty()) return;
+
+    // In-flight requests are lost with the connection - put them back in front (same reqIds)
+    QList<Entry> interrupted = m_inFlight.values();
+    m_inFlight.clear();
+    for (int i = interrupted.size() - 1; i >= 0; --i) {
+        m_queue.prepend(interrupted[i]);
+    }
+    LOG_DEBUG(QString("%1 historical request(s) will be re-sent after reconnect").arg(interrupted.size()));
+}
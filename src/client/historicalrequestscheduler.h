@@ -0,0 +1,121 @@
+#ifndef HISTORICALREQUESTSCHEDULER_H
+#define HISTORICALREQUESTSCHEDULER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QMap>
+#include <QHash>
+
+class IBKRClient;
+class QTimer;
+
+enum class HistoricalRequestPriority {
+    High,   // Chart of the displayed ticker
+    Normal, // Background loads
+    Low     // Gap backfill
+};
+
+// What the bars are for - requests of different purposes are handled differently and never coalesce
+enum class HistoricalRequestPurpose {
+    Load,     // Chart / timeframe load (marks the timeframe loaded)
+    Backfill, // Gap after a resubscribe
+    Prefetch  // Watchlist warm-up
+};
+
+struct HistoricalRequest {
+    QString owner;       // Ticker key the bars belong to
+    QString symbol;
+    QString endDateTime; // Empty = now
+    QString duration;
+    QString barSize;
+    HistoricalRequestPriority priority = HistoricalRequestPriority::Normal;
+    HistoricalRequestPurpose purpose = HistoricalRequestPurpose::Load;
+};
+
+struct HistoricalSchedulerMetrics {
+    int queueDepth = 0;
+    int inFlight = 0;
+    int sentLast10Min = 0;
+    int sent = 0;
+    int coalesced = 0;
+    int cancelled = 0;
+    int pacingViolations = 0;
+    qint64 lastWaitMs = 0;
+    qint64 maxWaitMs = 0;
+    double averageWaitMs = 0.0;
+};
+
+/**
+ * @brief Single entry point for historical data requests, paced to TWS limits
+ *
+ * Requests are queued by priority (displayed ticker first) and sent while
+ * staying under TWS pacing rules: 60 requests per 10 minutes, no identical
+ * request within 15 seconds, 6 requests per 2 seconds for the same contract.
+ * Identical pending requests of the same owner and purpose are coalesced. A pacing violation (error 162)
+ * pauses the queue with exponential backoff and re-sends the request.
+ * Requests cut off by a disconnect are re-sent after reconnecting.
+ */
+class HistoricalRequestScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HistoricalRequestScheduler(IBKRClient* client, QObject* parent = nullptr);
+
+    // Returns reqId the bars will arrive with: reqId itself, or the one of an identical pending request
+    int submit(int reqId, const HistoricalRequest& request);
+
+    // Drop queued / cancel in-flight requests of owner with priority `lowest` or more urgent. Returns their reqIds
+    QList<int> cancelOwner(const QString& owner, HistoricalRequestPriority lowest = HistoricalRequestPriority::Normal);
+
+    // Requests of this owner go first within the same priority
+    void setFocusOwner(const QString& owner);
+
+    bool isPending(int reqId) const;
+    HistoricalSchedulerMetrics metrics() const;
+
+signals:
+    void requestFailed(int reqId, int code, const QString& message);
+
+private slots:
+    void dispatch();
+    void onHistoricalDataFinished(int reqId);
+    void onError(int id, int code, const QString& message);
+    void onDisconnected();
+
+private:
+    struct Entry {
+        int reqId;
+        HistoricalRequest request;
+        qint64 submittedMs;
+        qint64 sequence;
+    };
+
+    static QString requestKey(const HistoricalRequest& request);  // Same contract and parameters (TWS "identical")
+    static QString coalesceKey(const HistoricalRequest& request); // ... and same purpose
+    bool isMoreUrgent(const Entry& a, const Entry& b) const;
+    qint64 blockedForMs(const Entry& entry, qint64 nowMs) const; // 0 = can be sent now
+    void pruneHistory(qint64 nowMs);
+    void send(const Entry& entry, qint64 nowMs);
+    void scheduleDispatch(qint64 delayMs = 0);
+
+    IBKRClient* m_client;
+    QTimer* m_dispatchTimer;
+    QList<Entry> m_queue;
+    QMap<int, Entry> m_inFlight;
+    QString m_focusOwner;
+    qint64 m_nextSequence;
+
+    // Pacing history
+    QList<qint64> m_sentTimes;                  // All sends within the 10 minute window
+    QHash<QString, QList<qint64>> m_sentBySymbol; // Sends within 2 seconds, per contract
+    QHash<QString, qint64> m_lastSentByKey;       // Identical request -> last send time
+    qint64 m_pausedUntilMs;
+    int m_backoffMs;
+
+    HistoricalSchedulerMetrics m_metrics;
+    qint64 m_totalWaitMs;
+};
+
+#endif // HISTORICALREQUESTSCHEDULER_H
@@ -1,9 +1,14 @@
 #include "client/ibkrclient.h"
+#include "client/messagedispatcher.h"
 #include "../external/twsapi/source/cppclient/client/Order.h"
 #include "../external/twsapi/source/cppclient/client/TagValue.h"
 #include "utils/logger.h"
 #include <QDebug>
 
+// Tick handoff from the dispatcher thread when the queue is full
+static const int MAX_PARKED_QUOTES = 256; // Streams with a parked quote (more than TWS allows)
+static const int TRADE_PUSH_SPINS = 1000; // Yields before a trade print counts as dropped
+
 IBKRClient::IBKRClient(QObject *parent)
     : QObject(parent)
     , m_isConnected(false)
@@ -12,14 +17,27 @@ IBKRClient::IBKRClient(QObject *parent)
     , m_nextOrderId(1)
     , m_activeAccount("N/A")
     , m_disconnectLogged(false)
+    , m_tickQueue(4096)
+    , m_tickDrainPending(false)
+    , m_droppedQuotes(0)
+    , m_droppedTrades(0)
+    , m_quotesParked(false)
+    , m_orderOriginNs(0)
+    , m_offline(false)
 {
+    m_parkedQuotes.reserve(MAX_PARKED_QUOTES);
+    m_drainedQuotes.reserve(MAX_PARKED_QUOTES);
+
     m_wrapper = std::make_unique<IBKRWrapper>(this);
     m_signal = std::make_unique<EReaderOSSignal>();
     m_socket = std::make_unique<EClientSocket>(m_wrapper.get(), m_signal.get());
 
-    m_messageTimer = new QTimer(this);
-    m_messageTimer->setInterval(50); // 50ms = fast enough, reduces conflicts with EReader thread
-    QObject::connect(m_messageTimer, &QTimer::timeout, this, &IBKRClient::processMessages);
+    // Messages are dispatched as soon as EReader signals them (no polling interval)
+    m_dispatcher = new MessageDispatcher(m_signal.get(), this);
+
+    m_latencyReportTimer = new QTimer(this);
+    m_latencyReportTimer->setInterval(5 * 60 * 1000);
+    QObject::connect(m_latencyReportTimer, &QTimer::timeout, this, &IBKRClient::reportLatency);
 
     m_reconnectTimer = new QTimer(this);
     m_reconnectTimer->setInterval(1000);
@@ -31,6 +49,7 @@ IBKRClient::IBKRClient(QObject *parent)
 IBKRClient::~IBKRClient()
 {
     disconnect();
+    m_wrapper->setJournal(nullptr);
 }
 
 void IBKRClient::setupSignals()
@@ -63,7 +82,7 @@ void IBKRClient::setupSignals()
 
     QObject::connect(m_wrapper.get(), &IBKRWrapper::errorOccurred, this, &IBKRClient::error);
     QObject::connect(m_wrapper.get(), &IBKRWrapper::tickPriceReceived, this, &IBKRClient::tickPriceUpdated);
-    QObject::connect(m_wrapper.get(), &IBKRWrapper::tickByTickReceived, this, &IBKRClient::tickByTickUpdated);
+    QObject::connect(m_wrapper.get(), &IBKRWrapper::tickSizeReceived, this, &IBKRClient::tickSizeUpdated);
     QObject::connect(m_wrapper.get(), &IBKRWrapper::marketDataReceived, this, &IBKRClient::marketDataUpdated);
     QObject::connect(m_wrapper.get(), &IBKRWrapper::realTimeBarReceived, this, &IBKRClient::realTimeBarReceived);
     QObject::connect(m_wrapper.get(), &IBKRWrapper::historicalDataReceived, this, &IBKRClient::historicalBarReceived);
@@ -134,7 +153,8 @@ void IBKRClient::connect(const QString& host, int port, int clientId)
         m_reader = std::make_unique<EReader>(m_socket.get(), m_signal.get());
         m_reader->start();
 
-        m_messageTimer->start();
+        m_dispatcher->startDispatching(m_reader.get());
+        m_latencyReportTimer->start();
     } else {
         // Don't log here - detailed error will come from IBKRWrapper
         // Don't emit error here - detailed error will come from IBKRWrapper
@@ -142,6 +162,29 @@ void IBKRClient::connect(const QString& host, int port, int clientId)
     }
 }
 
+void IBKRClient::startOfflineSession(int nextOrderId)
+{
+    if (m_isConnected) return;
+
+    m_offline = true;
+    m_isConnected = true;
+    m_nextOrderId = nextOrderId;
+    m_wrapper->resetSession();
+    LOG_INFO("Offline session started (no TWS connection)");
+    emit connected();
+}
+
+bool IBKRClient::startRecording(const QString& path)
+{
+    auto journal = std::make_unique<MarketJournalWriter>();
+    if (!journal->open(path)) return false;
+
+    // The dispatcher thread isn't running yet, so the wrapper can take the pointer unguarded
+    m_journal = std::move(journal);
+    m_wrapper->setJournal(m_journal.get());
+    return true;
+}
+
 void IBKRClient::disconnect()
 {
     disconnect(true);
@@ -149,7 +192,12 @@ void IBKRClient::disconnect()
 
 void IBKRClient::disconnect(bool stopReconnect)
 {
-    m_messageTimer->stop();
+    // Wrapper callbacks run on the dispatcher thread, which can't join itself
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, [this, stopReconnect]() { disconnect(stopReconnect); }, Qt::QueuedConnection);
+        return;
+    }
+
     if (stopReconnect) {
         m_reconnectTimer->stop();
     }
@@ -158,13 +206,19 @@ void IBKRClient::disconnect(bool stopReconnect)
         m_socket->eDisconnect();
     }
 
+    m_dispatcher->stopDispatching();
     m_reader.reset();
+    m_latencyReportTimer->stop();
 
     if (!m_isConnected) {
         return; // Already disconnected
     }
 
     m_isConnected = false;
+    m_offline = false;
+    m_tickPipeline.reset(); // TWS drops all subscriptions with the connection
+    m_tickByTickRequests.clear();
+    m_realTimeBarRequests.clear();
     m_activeAccount = "N/A";
     emit activeAccountChanged("N/A");
 
@@ -174,6 +228,7 @@ void IBKRClient::disconnect(bool stopReconnect)
         m_disconnectLogged = true;
     }
 
+    reportLatency();
     emit disconnected();
 
     if (!stopReconnect) {
@@ -181,17 +236,100 @@ void IBKRClient::disconnect(bool stopReconnect)
     }
 }
 
-void IBKRClient::processMessages()
+void IBKRClient::postTick(const Tick& tick)
 {
-    // Process messages using EReader pattern (non-blocking)
-    if (m_reader && m_socket && m_socket->isConnected()) {
-        try {
-            m_reader->processMsgs();
-        } catch (const std::system_error& e) {
-            // Mutex conflict with EReader thread - skip this cycle
-            // This can happen when both threads try to access message queue simultaneously
-            LOG_DEBUG(QString("Skipped processMsgs() due to mutex conflict: %1").arg(e.what()));
+    if (QThread::currentThread() == thread()) {
+        m_tickPipeline.publish(tick);
+        return;
+    }
+
+    // Dispatcher thread: queue without locking, wake the engine thread once per batch
+    QueuedTick item{tick, LatencyHistogram::nowNs()};
+    if (tick.isTrade()) {
+        // Every print counts towards volume: wait for the engine thread to make room
+        bool queued = m_tickQueue.push(item);
+        for (int spin = 0; !queued && spin < TRADE_PUSH_SPINS; ++spin) {
+            QThread::yieldCurrentThread();
+            queued = m_tickQueue.push(item);
+        }
+        if (!queued) {
+            m_droppedTrades.fetch_add(1, std::memory_order_relaxed);
         }
+    } else {
+        // Only the last quote of a stream matters - parked instead of queued when full
+        if (m_quotesParked.load(std::memory_order_acquire) || !m_tickQueue.push(item)) {
+            parkQuote(item);
+        }
+    }
+
+    if (!m_tickDrainPending.exchange(true)) {
+        QMetaObject::invokeMethod(this, &IBKRClient::drainTicks, Qt::QueuedConnection);
+    }
+}
+
+void IBKRClient::parkQuote(const QueuedTick& item)
+{
+    QMutexLocker locker(&m_parkedLock);
+    m_quotesParked.store(true, std::memory_order_release);
+    for (QueuedTick& parked : m_parkedQuotes) {
+        if (parked.tick.reqId == item.tick.reqId) {
+            parked = item; // The superseded quote is never published
+            m_droppedQuotes.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    if (m_parkedQuotes.size() < MAX_PARKED_QUOTES) {
+        m_parkedQuotes.append(item);
+    } else {
+        m_droppedQuotes.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void IBKRClient::drainTicks()
+{
+    // Clear first: ticks pushed from now on schedule another drain
+    m_tickDrainPending.store(false);
+
+    QueuedTick item;
+    while (m_tickQueue.pop(item)) {
+        m_quoteLatency.record(LatencyHistogram::nowNs() - item.queuedNs);
+        m_tickPipeline.publish(item.tick);
+    }
+
+    // Parked quotes are newer than everything queued before them; quotes queued from now on
+    // are newer still and go out with the next drain
+    {
+        QMutexLocker locker(&m_parkedLock);
+        if (!m_quotesParked.load(std::memory_order_acquire)) return;
+        m_parkedQuotes.swap(m_drainedQuotes);
+        m_quotesParked.store(false, std::memory_order_release);
+    }
+    for (const QueuedTick& parked : m_drainedQuotes) {
+        m_quoteLatency.record(LatencyHistogram::nowNs() - parked.queuedNs);
+        m_tickPipeline.publish(parked.tick);
+    }
+    m_drainedQuotes.clear(); // Keeps its capacity
+}
+
+qint64 IBKRClient::takeOrderOrigin()
+{
+    // First request of a command only (cancelling several orders is one keypress)
+    qint64 originNs = m_orderOriginNs;
+    m_orderOriginNs = 0;
+    return originNs;
+}
+
+void IBKRClient::reportLatency()
+{
+    LatencyHistogram keyToWrite = m_orderTracker.stage(OrderLatencyTracker::KeyToWrite);
+    if (m_quoteLatency.count() == 0 && m_eventLatency.count() == 0 && keyToWrite.count() == 0) return;
+
+    LOG_DEBUG(QString("Dispatch latency - quotes: %1; order events: %2; dropped quotes: %3, trades: %4")
+        .arg(m_quoteLatency.summary()).arg(m_eventLatency.summary()).arg(droppedQuotes()).arg(droppedTrades()));
+    if (keyToWrite.count() > 0) {
+        LOG_DEBUG(QString("Keypress to socket write: %1; socket write to ack: %2")
+            .arg(keyToWrite.summary())
+            .arg(m_orderTracker.stage(OrderLatencyTracker::WriteToAck).summary()));
     }
 }
 
@@ -202,6 +340,7 @@ void IBKRClient::attemptReconnect()
         // Ensure clean disconnect before reconnecting
         if (m_socket->isConnected()) {
             m_socket->eDisconnect();
+            m_dispatcher->stopDispatching();
             m_reader.reset();
         }
         connect(m_host, m_port, m_clientId);
@@ -229,11 +368,12 @@ void IBKRClient::cancelMarketData(int tickerId)
 
 void IBKRClient::requestTickByTick(int tickerId, const QString& symbol)
 {
+    // Latest-quote slot is allocated here, not per tick
+    m_tickPipeline.openSlot(tickerId);
+    m_tickByTickRequests.insert(tickerId, symbol);
+    if (m_journal) m_journal->requestTickByTick(tickerId, symbol);
     if (!m_socket->isConnected()) return;
 
-    // Reset tick logging for this reqId (allow first tick to be logged again)
-    m_wrapper->resetTickByTickLogging(tickerId);
-
     Contract contract;
     contract.symbol = symbol.toStdString();
     contract.secType = "STK";
@@ -243,18 +383,36 @@ void IBKRClient::requestTickByTick(int tickerId, const QString& symbol)
     m_socket->reqTickByTickData(tickerId, contract, "BidAsk", 0, true);
 }
 
-void IBKRClient::cancelTickByTick(int tickerId)
+void IBKRClient::requestTickByTickTrades(int tickerId, int quoteTickerId, const QString& symbol, const QString& tickType)
 {
+    m_tickPipeline.openAlias(tickerId, quoteTickerId);
+    m_tickByTickRequests.insert(tickerId, symbol);
+    if (m_journal) m_journal->requestTickByTick(tickerId, symbol);
     if (!m_socket->isConnected()) return;
 
-    // Reset tick logging for this reqId (in case we resubscribe later)
-    m_wrapper->resetTickByTickLogging(tickerId);
+    Contract contract;
+    contract.symbol = symbol.toStdString();
+    contract.secType = "STK";
+    contract.exchange = "SMART";
+    contract.currency = "USD";
+
+    m_socket->reqTickByTickData(tickerId, contract, tickType.toStdString(), 0, false);
+}
+
+void IBKRClient::cancelTickByTick(int tickerId)
+{
+    m_tickPipeline.closeSlot(tickerId);
+    m_tickByTickRequests.remove(tickerId);
+    if (m_journal) m_journal->cancelTickByTick(tickerId);
+    if (!m_socket->isConnected()) return;
 
     m_socket->cancelTickByTickData(tickerId);
 }
 
 void IBKRClient::requestRealTimeBars(int tickerId, const QString& symbol)
 {
+    m_realTimeBarRequests.insert(tickerId, symbol);
+    if (m_journal) m_journal->requestRealTimeBars(tickerId, symbol);
     if (!m_socket->isConnected()) return;
 
     Contract contract;
@@ -271,13 +429,20 @@ void IBKRClient::requestRealTimeBars(int tickerId, const QString& symbol)
 
 void IBKRClient::cancelRealTimeBars(int tickerId)
 {
+    m_realTimeBarRequests.remove(tickerId);
+    if (m_journal) m_journal->cancelRealTimeBars(tickerId);
     if (!m_socket->isConnected()) return;
     m_socket->cancelRealTimeBars(tickerId);
 }
 
 void IBKRClient::requestHistoricalData(int reqId, const QString& symbol, const QString& endDateTime, const QString& duration, const QString& barSize)
 {
+    if (m_offline) {
+        emit historicalDataRequested(reqId, symbol, endDateTime, duration, barSize);
+        return;
+    }
     if (!m_socket->isConnected()) return;
+    if (m_journal) m_journal->requestHistorical(reqId, symbol, endDateTime, duration, barSize);
 
     Contract contract;
     contract.symbol = symbol.toStdString();
@@ -291,9 +456,16 @@ void IBKRClient::requestHistoricalData(int reqId, const QString& symbol, const Q
                                  barSize.toStdString(), "TRADES", 0, 2, false, TagValueListSPtr());
 }
 
+void IBKRClient::cancelHistoricalData(int reqId)
+{
+    if (!m_socket->isConnected()) return;
+    m_socket->cancelHistoricalData(reqId);
+}
+
 int IBKRClient::placeOrder(const QString& symbol, const QString& action, int quantity, double limitPrice,
                            const QString& orderType, const QString& tif, bool outsideRth, const QString& primaryExchange)
 {
+    qint64 callNs = LatencyHistogram::nowNs();
     if (!m_socket->isConnected()) {
         LOG_WARNING("Cannot place order - not connected to TWS");
         return -1;
@@ -340,7 +512,9 @@ int IBKRClient::placeOrder(const QString& symbol, const QString& action, int qua
     order.goodTillDate = "";
 
     int orderId = m_nextOrderId++;
+    m_orderTracker.begin(orderId, OrderTimeline::Place, takeOrderOrigin(), callNs);
     m_socket->placeOrder(orderId, contract, order);
+    m_orderTracker.written(orderId, LatencyHistogram::nowNs());
 
     return orderId;
 }
@@ -348,6 +522,7 @@ int IBKRClient::placeOrder(const QString& symbol, const QString& action, int qua
 void IBKRClient::updateOrder(int orderId, const QString& symbol, const QString& action, int quantity, double limitPrice,
                               const QString& orderType, const QString& tif, bool outsideRth, const QString& primaryExchange)
 {
+    qint64 callNs = LatencyHistogram::nowNs();
     if (!m_socket->isConnected()) {
         LOG_WARNING("Cannot update order - not connected to TWS");
         return;
@@ -392,29 +567,37 @@ void IBKRClient::updateOrder(int orderId, const QString& symbol, const QString&
     order.goodAfterTime = "";
     order.goodTillDate = "";
 
+    // Use existing orderId to update order in TWS (logged after the write, not before)
+    m_orderTracker.begin(orderId, OrderTimeline::Modify, takeOrderOrigin(), callNs);
+    m_socket->placeOrder(orderId, contract, order);
+    m_orderTracker.written(orderId, LatencyHistogram::nowNs());
+
     LOG_INFO(QString("Updating order in TWS: orderId=%1, action=%2, qty=%3, type=%4, lmt=%5, tif=%6")
         .arg(orderId).arg(QString::fromStdString(order.action)).arg(quantity)
         .arg(QString::fromStdString(order.orderType)).arg(order.lmtPrice, 0, 'f', 2)
         .arg(QString::fromStdString(order.tif)));
-
-    // Use existing orderId to update order in TWS
-    m_socket->placeOrder(orderId, contract, order);
 }
 
 void IBKRClient::cancelOrder(int orderId)
 {
+    qint64 callNs = LatencyHistogram::nowNs();
     if (!m_socket->isConnected()) return;
     OrderCancel orderCancel;
     orderCancel.manualOrderCancelTime = "";
+    m_orderTracker.begin(orderId, OrderTimeline::Cancel, takeOrderOrigin(), callNs);
     m_socket->cancelOrder(orderId, orderCancel);
+    m_orderTracker.written(orderId, LatencyHistogram::nowNs());
 }
 
 void IBKRClient::cancelAllOrders()
 {
+    qint64 callNs = LatencyHistogram::nowNs();
     if (!m_socket->isConnected()) return;
     OrderCancel orderCancel;
     orderCancel.manualOrderCancelTime = "";
+    m_orderTracker.begin(-1, OrderTimeline::GlobalCancel, takeOrderOrigin(), callNs);
     m_socket->reqGlobalCancel(orderCancel);
+    m_orderTracker.written(-1, LatencyHistogram::nowNs());
 }
 
 void IBKRClient::requestAccountUpdates(bool subscribe, const QString& account)
@@ -5,11 +5,20 @@
 #include <QTimer>
 #include <QThread>
 #include <QMutex>
+#include <QHash>
 #include <memory>
+#include <atomic>
 #include "EClientSocket.h"
 #include "EReader.h"
 #include "EReaderOSSignal.h"
 #include "client/ibkrwrapper.h"
+#include "client/tickpipeline.h"
+#include "utils/spscqueue.h"
+#include "client/orderlatencytracker.h"
+#include "client/marketjournal.h"
+#include "utils/latencyhistogram.h"
+
+class MessageDispatcher;
 
 class IBKRClient : public QObject
 {
@@ -19,23 +28,38 @@ public:
     explicit IBKRClient(QObject *parent = nullptr);
     ~IBKRClient();
 
+    // Lives on the engine thread (see EngineThread): call the methods below from there
+    // (queued from widgets); isConnected() is safe from any thread
     bool isConnected() const { return m_isConnected; }
-    QString activeAccount() const { return m_activeAccount; }
+    QString activeAccount() const { return m_activeAccount; } // Widgets track activeAccountChanged instead
 
     void connect(const QString& host, int port, int clientId);
     void disconnect();
     void disconnect(bool stopReconnect);
 
+    // Connected state without a socket (benchmarks, replay): requests only do their local
+    // bookkeeping and data is fed through wrapper() callbacks. Ends with disconnect()
+    void startOfflineSession(int nextOrderId = 1);
+    bool isOffline() const { return m_offline; }
+
+    // Record every wrapper callback and stream/historical request to a journal (see
+    // JournalReplayer). Call before connect(); recording stops when the client is destroyed
+    bool startRecording(const QString& path);
+
     // Market Data
     void requestMarketData(int tickerId, const QString& symbol);
     void cancelMarketData(int tickerId);
     void requestTickByTick(int tickerId, const QString& symbol);
-    void cancelTickByTick(int tickerId);
+    // "Last" or "AllLast" prints of a symbol already streamed as quoteTickerId: the
+    // trades reach tick consumers merged into quoteTickerId's stream
+    void requestTickByTickTrades(int tickerId, int quoteTickerId, const QString& symbol, const QString& tickType);
+    void cancelTickByTick(int tickerId); // Quotes or trades
     void requestRealTimeBars(int tickerId, const QString& symbol);
     void cancelRealTimeBars(int tickerId);
 
     // Historical Data
     void requestHistoricalData(int reqId, const QString& symbol, const QString& endDateTime, const QString& duration, const QString& barSize);
+    void cancelHistoricalData(int reqId);
 
     // Orders
     // Place new order (generates new orderId)
@@ -67,6 +91,31 @@ public:
     void unsubscribeFromGroupEvents(int reqId);
 
     EClientSocket* socket() { return m_socket.get(); }
+    IBKRWrapper* wrapper() { return m_wrapper.get(); }
+
+    // Tick-by-tick quotes bypass signals (see TickPipeline)
+    TickPipeline& tickPipeline() { return m_tickPipeline; }
+
+    // Open streaming requests (reqId -> symbol), so offline feeds know what to answer
+    const QHash<int, QString>& tickByTickRequests() const { return m_tickByTickRequests; }
+    const QHash<int, QString>& realTimeBarRequests() const { return m_realTimeBarRequests; }
+
+    // Called by the wrapper: publishes right away on the engine thread, queues from the dispatcher thread
+    void postTick(const Tick& tick);
+
+    // Dispatcher thread -> engine thread handoff latency (quotes via tick queue, order events via queued calls)
+    const LatencyHistogram& quoteLatency() const { return m_quoteLatency; }
+    const LatencyHistogram& eventLatency() const { return m_eventLatency; }
+    void recordEventLatency(qint64 ns) { m_eventLatency.record(ns); }
+
+    // Order lifecycle timings. The next placeOrder/updateOrder/cancelOrder is stamped with
+    // the keypress time set here by OrderLane, 0 disarms
+    void setOrderOrigin(qint64 originNs) { m_orderOriginNs = originNs; }
+    OrderLatencyTracker& orderTracker() { return m_orderTracker; } // Thread-safe
+    // Ticks the engine thread never saw: quotes superseded by a newer one of the same stream
+    // while the tick queue was full, trades that still found it full after waiting
+    quint64 droppedQuotes() const { return m_droppedQuotes.load(std::memory_order_relaxed); }
+    quint64 droppedTrades() const { return m_droppedTrades.load(std::memory_order_relaxed); }
 
 signals:
     void connected();
@@ -74,12 +123,14 @@ signals:
     void error(int id, int code, const QString& message);
 
     void tickPriceUpdated(int tickerId, int field, double price);
-    void tickByTickUpdated(int reqId, double price, double bidPrice, double askPrice);
+    void tickSizeUpdated(int tickerId, int field, double size);
     void marketDataUpdated(int tickerId, double lastPrice, double bidPrice, double askPrice);
 
     void realTimeBarReceived(int reqId, long time, double open, double high, double low, double close, long volume);
     void historicalBarReceived(int reqId, long time, double open, double high, double low, double close, long volume);
     void historicalDataFinished(int reqId);
+    // Offline session only: there is no socket, the feed answers through wrapper() (see JournalReplayer)
+    void historicalDataRequested(int reqId, const QString& symbol, const QString& endDateTime, const QString& duration, const QString& barSize);
 
     void orderConfirmed(int orderId, const QString& symbol, const QString& action, int quantity, double price, long long permId);
     void orderStatusUpdated(int orderId, const QString& status, double filled, double remaining, double avgFillPrice);
@@ -98,20 +149,51 @@ signals:
     void displayGroupUpdatedReceived(int reqId, const QString& contractInfo);
 
 private slots:
-    void processMessages();
+    void drainTicks();
     void attemptReconnect();
+    void reportLatency();
 
 private:
     void setupSignals();
+    qint64 takeOrderOrigin();
 
     std::unique_ptr<IBKRWrapper> m_wrapper;
     std::unique_ptr<EClientSocket> m_socket;
     std::unique_ptr<EReader> m_reader;
     std::unique_ptr<EReaderOSSignal> m_signal;
-    QTimer *m_messageTimer;
+    MessageDispatcher *m_dispatcher;
+    TickPipeline m_tickPipeline;
     QTimer *m_reconnectTimer;
 
-    bool m_isConnected;
+    // Ticks crossing from the dispatcher thread
+    struct QueuedTick {
+        Tick tick;
+        qint64 queuedNs = 0;
+    };
+    SpscQueue<QueuedTick> m_tickQueue;
+    std::atomic<bool> m_tickDrainPending;
+    std::atomic<quint64> m_droppedQuotes;
+    std::atomic<quint64> m_droppedTrades;
+
+    // Queue full: latest quote per stream, published after the queue on the next drain.
+    // Once one is parked, all quotes go here until then (keeps each stream's order)
+    void parkQuote(const QueuedTick& item);
+    QMutex m_parkedLock;
+    QVector<QueuedTick> m_parkedQuotes;  // Capacity reserved up front
+    QVector<QueuedTick> m_drainedQuotes; // Engine thread's side of the swap
+    std::atomic<bool> m_quotesParked;    // Set by the producer, cleared by the drain (under the lock)
+
+    LatencyHistogram m_quoteLatency;
+    LatencyHistogram m_eventLatency;
+    OrderLatencyTracker m_orderTracker;
+    std::unique_ptr<MarketJournalWriter> m_journal;
+    qint64 m_orderOriginNs;
+    QTimer *m_latencyReportTimer;
+
+    std::atomic<bool> m_isConnected; // Read by widgets
+    bool m_offline;
+    QHash<int, QString> m_tickByTickRequests;
+    QHash<int, QString> m_realTimeBarRequests;
     QString m_host;
     int m_port;
     int m_clientId;
@@ -1,31 +1,46 @@
 #include "client/ibkrwrapper.h"
 #include "client/ibkrclient.h"
+#include "client/marketjournal.h"
 #include "utils/logger.h"
+#include "utils/latencyhistogram.h"
 #include "Execution.h"
 #include "Order.h"
 #include "OrderState.h"
 #include "Decimal.h"
 #include <QDebug>
 #include <QTimeZone>
+#include <cstring>
 
 IBKRWrapper::IBKRWrapper(IBKRClient *client)
     : m_client(client)
+    , m_journal(nullptr)
     , m_accountValueLogged(false)
     , m_portfolioLogged(false)
 {
-    // m_tickByTickLogged is QMap and initializes empty automatically
 }
 
-void IBKRWrapper::resetSession()
+// Fixed-size copy for Tick's inline strings (keeps ticks plain data)
+static void copyTruncated(char* target, size_t capacity, const std::string& value)
 {
-    m_accountValueLogged = false;
-    m_portfolioLogged = false;
-    m_tickByTickLogged.clear();
+    size_t length = qMin(value.size(), capacity - 1);
+    memcpy(target, value.data(), length);
+    target[length] = '\0';
+}
+
+void IBKRWrapper::emitTimed(std::function<void()> emitter)
+{
+    // Order flow hops to the engine thread explicitly so the handoff can be measured
+    qint64 queuedNs = LatencyHistogram::nowNs();
+    QMetaObject::invokeMethod(this, [this, queuedNs, emitter]() {
+        m_client->recordEventLatency(LatencyHistogram::nowNs() - queuedNs);
+        emitter();
+    }, Qt::QueuedConnection);
 }
 
-void IBKRWrapper::resetTickByTickLogging(int reqId)
+void IBKRWrapper::resetSession()
 {
-    m_tickByTickLogged.remove(reqId);
+    m_accountValueLogged = false;
+    m_portfolioLogged = false;
 }
 
 void IBKRWrapper::connectAck()
@@ -42,12 +57,14 @@ void IBKRWrapper::connectionClosed()
 
 void IBKRWrapper::nextValidId(OrderId orderId)
 {
+    if (m_journal) m_journal->nextValidId(orderId);
     qDebug() << "API ready, next valid order ID:" << orderId;
     emit apiReady(orderId);
 }
 
 void IBKRWrapper::error(int id, time_t errorTime, int errorCode, const std::string& errorString, const std::string& advancedOrderRejectJson)
 {
+    if (m_journal) m_journal->error(id, errorCode, errorString);
     QString msg = QString::fromStdString(errorString);
 
     // Filter informational "OK" status messages (not errors)
@@ -84,6 +101,7 @@ void IBKRWrapper::error(int id, time_t errorTime, int errorCode, const std::stri
 
 void IBKRWrapper::tickPrice(TickerId tickerId, TickType field, double price, const TickAttrib& attrib)
 {
+    if (m_journal) m_journal->tickPrice(tickerId, field, price);
     emit tickPriceReceived(tickerId, field, price);
 
     // Aggregate market data: LAST=4, BID=1, ASK=2
@@ -108,7 +126,9 @@ void IBKRWrapper::tickPrice(TickerId tickerId, TickType field, double price, con
 
 void IBKRWrapper::tickSize(TickerId tickerId, TickType field, Decimal size)
 {
-    // Not used for now
+    if (m_journal) m_journal->tickSize(tickerId, field, size);
+    // BID_SIZE=0, ASK_SIZE=3, LAST_SIZE=5, VOLUME=8 (reqMktData streams)
+    emit tickSizeReceived(tickerId, field, DecimalFunctions::decimalToDouble(size));
 }
 
 void IBKRWrapper::tickGeneric(TickerId tickerId, TickType tickType, double value)
@@ -123,22 +143,34 @@ void IBKRWrapper::tickString(TickerId tickerId, TickType tickType, const std::st
 
 void IBKRWrapper::tickByTickAllLast(int reqId, int tickType, time_t time, double price, Decimal size, const TickAttribLast& tickAttribLast, const std::string& exchange, const std::string& specialConditions)
 {
-    // Price updated via all last
-    emit tickByTickReceived(reqId, price, 0, 0);
+    if (m_journal) m_journal->tickByTickAllLast(reqId, tickType, time, price, size, exchange, specialConditions);
+
+    // Trade print (Last / AllLast)
+    Tick tick;
+    tick.reqId = reqId;
+    tick.kind = TickKind::Trade;
+    tick.time = static_cast<qint64>(time);
+    tick.price = price;
+    tick.size = DecimalFunctions::decimalToDouble(size);
+    copyTruncated(tick.exchange, sizeof(tick.exchange), exchange);
+    copyTruncated(tick.conditions, sizeof(tick.conditions), specialConditions);
+    m_client->postTick(tick);
 }
 
 void IBKRWrapper::tickByTickBidAsk(int reqId, time_t time, double bidPrice, double askPrice, Decimal bidSize, Decimal askSize, const TickAttribBidAsk& tickAttribBidAsk)
 {
-    Q_UNUSED(time);
-    Q_UNUSED(bidSize);
-    Q_UNUSED(askSize);
     Q_UNUSED(tickAttribBidAsk);
+    if (m_journal) m_journal->tickByTickBidAsk(reqId, time, bidPrice, askPrice, bidSize, askSize);
 
-    // Log only first successful tick for each reqId (similar to account/portfolio logging)
-    if (!m_tickByTickLogged.value(reqId, false)) {
-        m_tickByTickLogged[reqId] = true;
-    }
-    emit tickByTickReceived(reqId, 0, bidPrice, askPrice);
+    // Straight to the consumers, no signal hops or string conversions
+    Tick tick;
+    tick.reqId = reqId;
+    tick.time = static_cast<qint64>(time);
+    tick.bid = bidPrice;
+    tick.ask = askPrice;
+    tick.bidSize = DecimalFunctions::decimalToDouble(bidSize);
+    tick.askSize = DecimalFunctions::decimalToDouble(askSize);
+    m_client->postTick(tick);
 }
 
 void IBKRWrapper::tickByTickMidPoint(int reqId, time_t time, double midPoint)
@@ -148,6 +180,7 @@ void IBKRWrapper::tickByTickMidPoint(int reqId, time_t time, double midPoint)
 
 void IBKRWrapper::historicalData(TickerId reqId, const Bar& bar)
 {
+    if (m_journal) m_journal->historicalData(reqId, bar);
     long timestamp = 0;
     QString rawTime = QString::fromStdString(bar.time);
     QDateTime dt;
@@ -176,33 +209,44 @@ void IBKRWrapper::historicalData(TickerId reqId, const Bar& bar)
 
 void IBKRWrapper::historicalDataEnd(int reqId, const std::string& startDateStr, const std::string& endDateStr)
 {
+    if (m_journal) m_journal->historicalDataEnd(reqId);
     qDebug() << "Historical data complete for reqId:" << reqId;
     emit historicalDataComplete(reqId);
 }
 
 void IBKRWrapper::realtimeBar(TickerId reqId, long time, double open, double high, double low, double close, Decimal volume, Decimal wap, int count)
 {
+    if (m_journal) m_journal->realtimeBar(reqId, time, open, high, low, close, volume, wap, count);
     long volumeLong = DecimalFunctions::decimalToDouble(volume);
     emit realTimeBarReceived(reqId, time, open, high, low, close, volumeLong);
 }
 
 void IBKRWrapper::orderStatus(OrderId orderId, const std::string& status, Decimal filled, Decimal remaining, double avgFillPrice, long long permId, int parentId, double lastFillPrice, int clientId, const std::string& whyHeld, double mktCapPrice)
 {
+    qint64 receivedNs = LatencyHistogram::nowNs();
+    if (m_journal) m_journal->orderStatus(orderId, status, filled, remaining, avgFillPrice, permId, lastFillPrice);
     QString statusStr = QString::fromStdString(status);
-    std::string filledStr = DecimalFunctions::decimalStringToDisplay(filled);
-    std::string remainingStr = DecimalFunctions::decimalStringToDisplay(remaining);
-    qDebug() << "Order status:" << orderId << statusStr << "filled:" << QString::fromStdString(filledStr) << "remaining:" << QString::fromStdString(remainingStr);
+    m_client->orderTracker().statusReceived(orderId, statusStr, receivedNs);
+    double filledQty = DecimalFunctions::decimalToDouble(filled);
+    double remainingQty = DecimalFunctions::decimalToDouble(remaining);
+    qDebug() << "Order status:" << orderId << statusStr << "filled:" << filledQty << "remaining:" << remainingQty;
 
     // Log when order is filled to track if portfolio update follows
     if (statusStr == "Filled") {
         LOG_DEBUG(QString("Order %1 FILLED - awaiting portfolio update from TWS").arg(orderId));
     }
 
-    emit orderStatusChanged(orderId, statusStr, QString::fromStdString(filledStr).toDouble(), QString::fromStdString(remainingStr).toDouble(), avgFillPrice);
+    emitTimed([=]() { emit orderStatusChanged(orderId, statusStr, filledQty, remainingQty, avgFillPrice); });
 }
 
 void IBKRWrapper::openOrder(OrderId orderId, const Contract& contract, const Order& order, const OrderState& orderState)
 {
+    m_client->orderTracker().ackReceived(orderId, LatencyHistogram::nowNs());
+    if (m_journal) {
+        m_journal->openOrder(orderId, contract.symbol, order.action, order.totalQuantity, order.orderType,
+                             order.lmtPrice, order.permId, orderState.status);
+    }
+
     QString symbol = QString::fromStdString(contract.symbol);
     QString action = QString::fromStdString(order.action);
 
@@ -223,7 +267,9 @@ void IBKRWrapper::openOrder(OrderId orderId, const Contract& contract, const Ord
         return;
     }
 
-    emit orderOpened(orderId, symbol, action, (int)quantity, order.lmtPrice, order.permId);
+    double limitPrice = order.lmtPrice;
+    long long permId = order.permId;
+    emitTimed([=]() { emit orderOpened(orderId, symbol, action, (int)quantity, limitPrice, permId); });
 }
 
 void IBKRWrapper::openOrderEnd()
@@ -233,6 +279,10 @@ void IBKRWrapper::openOrderEnd()
 
 void IBKRWrapper::completedOrder(const Contract& contract, const Order& order, const OrderState& orderState)
 {
+    if (m_journal) {
+        m_journal->completedOrder(order.orderId, contract.symbol, order.action, order.filledQuantity,
+                                  order.totalQuantity, order.lmtPrice, order.permId, orderState.status);
+    }
     QString symbol = QString::fromStdString(contract.symbol);
     QString action = QString::fromStdString(order.action);
 
@@ -256,7 +306,10 @@ void IBKRWrapper::completedOrder(const Contract& contract, const Order& order, c
         .arg(QString::fromStdString(orderState.status))
         .arg(order.permId));
 
-    emit orderOpened(order.orderId, symbol, action, (int)quantity, order.lmtPrice, order.permId);
+    int orderId = order.orderId;
+    double limitPrice = order.lmtPrice;
+    long long permId = order.permId;
+    emitTimed([=]() { emit orderOpened(orderId, symbol, action, (int)quantity, limitPrice, permId); });
 }
 
 void IBKRWrapper::completedOrdersEnd()
@@ -266,14 +319,21 @@ void IBKRWrapper::completedOrdersEnd()
 
 void IBKRWrapper::execDetails(int reqId, const Contract& contract, const Execution& execution)
 {
+    m_client->orderTracker().executionReceived(execution.orderId, LatencyHistogram::nowNs());
+    if (m_journal) {
+        m_journal->execDetails(reqId, execution.orderId, contract.symbol, execution.side, execution.shares,
+                               execution.price, execution.execId);
+    }
+
     QString symbol = QString::fromStdString(contract.symbol);
     QString side = QString::fromStdString(execution.side); // "BOT" or "SLD"
-    std::string sharesStr = DecimalFunctions::decimalStringToDisplay(execution.shares);
-    double shares = QString::fromStdString(sharesStr).toDouble();
+    double shares = DecimalFunctions::decimalToDouble(execution.shares);
 
     qDebug() << "Execution:" << execution.orderId << symbol << side << "price:" << execution.price << "shares:" << shares;
 
-    emit executionReceived(execution.orderId, symbol, side, execution.price, shares);
+    int orderId = execution.orderId;
+    double fillPrice = execution.price;
+    emitTimed([=]() { emit executionReceived(orderId, symbol, side, fillPrice, shares); });
 }
 
 void IBKRWrapper::execDetailsEnd(int reqId)
@@ -283,6 +343,8 @@ void IBKRWrapper::execDetailsEnd(int reqId)
 
 void IBKRWrapper::updateAccountValue(const std::string& key, const std::string& val, const std::string& currency, const std::string& accountName)
 {
+    if (m_journal) m_journal->accountValue(key, val, currency, accountName);
+
     // Log only account number and balance (NetLiquidation) until accountDownloadEnd
     if (!m_accountValueLogged) {
         if (key == "AccountCode") {
@@ -299,6 +361,10 @@ void IBKRWrapper::updateAccountValue(const std::string& key, const std::string&
 
 void IBKRWrapper::updatePortfolio(const Contract& contract, Decimal position, double marketPrice, double marketValue, double averageCost, double unrealizedPNL, double realizedPNL, const std::string& accountName)
 {
+    if (m_journal) {
+        m_journal->portfolio(contract.symbol, position, marketPrice, marketValue, averageCost,
+                             unrealizedPNL, realizedPNL, accountName);
+    }
     QString symbol = QString::fromStdString(contract.symbol);
     double quantity = DecimalFunctions::decimalToDouble(position);
 
@@ -323,6 +389,8 @@ void IBKRWrapper::updateAccountTime(const std::string& timeStamp)
 
 void IBKRWrapper::accountDownloadEnd(const std::string& accountName)
 {
+    if (m_journal) m_journal->accountDownloadEnd(accountName);
+
     // Disable logging after first account download
     m_accountValueLogged = true;
     m_portfolioLogged = true;
@@ -360,6 +428,7 @@ void IBKRWrapper::tickNews(int tickerId, time_t timeStamp, const std::string& pr
 
 void IBKRWrapper::managedAccounts(const std::string& accountsList)
 {
+    if (m_journal) m_journal->managedAccounts(accountsList);
     qDebug() << "Managed accounts:" << QString::fromStdString(accountsList);
     emit managedAccountsReceived(QString::fromStdString(accountsList));
 }
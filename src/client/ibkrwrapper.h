@@ -6,8 +6,11 @@
 #include <QMap>
 #include <QDateTime>
 #include <memory>
+#include <atomic>
+#include <functional>
 
 class IBKRClient;
+class MarketJournalWriter;
 
 class IBKRWrapper : public QObject, public DefaultEWrapper
 {
@@ -18,7 +21,9 @@ public:
     virtual ~IBKRWrapper() = default;
 
     void resetSession();
-    void resetTickByTickLogging(int reqId);
+
+    // Record callbacks to a journal (nullptr stops). Set while no callbacks run (see IBKRClient::startRecording)
+    void setJournal(MarketJournalWriter* journal) { m_journal = journal; }
 
     // Connection and Server
     void connectAck() override;
@@ -195,7 +200,7 @@ signals:
     void errorOccurred(int id, int code, const QString& message);
 
     void tickPriceReceived(int tickerId, int field, double price);
-    void tickByTickReceived(int reqId, double price, double bidPrice, double askPrice);
+    void tickSizeReceived(int tickerId, int field, double size);
     void marketDataReceived(int tickerId, double lastPrice, double bidPrice, double askPrice);
 
     void realTimeBarReceived(int reqId, long time, double open, double high, double low, double close, long volume);
@@ -222,6 +227,7 @@ signals:
 
 private:
     IBKRClient *m_client;
+    MarketJournalWriter *m_journal;
 
     // Cache for market data aggregation
     struct MarketDataCache {
@@ -234,10 +240,12 @@ private:
     };
     QMap<int, MarketDataCache> m_marketDataCache;
 
-    // Session tracking for first-time logging
-    bool m_accountValueLogged = false;
-    bool m_portfolioLogged = false;
-    QMap<int, bool> m_tickByTickLogged; // Track which reqIds have logged at least one tick
+    // Queue emitter on the engine thread, recording the handoff in IBKRClient::eventLatency()
+    void emitTimed(std::function<void()> emitter);
+
+    // Session tracking for first-time logging (reset from the engine thread)
+    std::atomic<bool> m_accountValueLogged{false};
+    std::atomic<bool> m_portfolioLogged{false};
 };
 
 #endif // IBKRWRAPPER_H
@@ -0,0 +1,747 @@
+#include "client/marketjournal.h"
+#include "client/ibkrclient.h"
+#include "utils/latencyhistogram.h"
+#include "utils/logger.h"
+#include "Contract.h"
+#include "Execution.h"
+#include "Order.h"
+#include "OrderState.h"
+#include <QDateTime>
+
+namespace {
+const quint32 JOURNAL_MAGIC = 0x49424A31; // "IBJ1"
+const quint16 JOURNAL_VERSION = 1;
+const qint64 FLUSH_INTERVAL_NS = 1000000000;
+
+QString historyKey(const QString& symbol, const QString& barSize)
+{
+    return symbol + '|' + barSize;
+}
+
+// Connection status codes make the wrapper drop the connection (here: the offline session)
+bool isConnectionStatus(int code)
+{
+    return code == 1100 || code == 1101 || code == 1102 || code == 1300 || code == 2110;
+}
+}
+
+MarketJournalWriter::MarketJournalWriter()
+    : m_startNs(0)
+    , m_lastFlushNs(0)
+    , m_records(0)
+{
+}
+
+MarketJournalWriter::~MarketJournalWriter()
+{
+    close();
+}
+
+bool MarketJournalWriter::open(const QString& path)
+{
+    QMutexLocker locker(&m_mutex);
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        LOG_ERROR(QString("Cannot open market journal %1: %2").arg(path).arg(m_file.errorString()));
+        return false;
+    }
+
+    m_stream.setDevice(&m_file);
+    m_stream.setByteOrder(QDataStream::LittleEndian);
+    m_stream << JOURNAL_MAGIC << JOURNAL_VERSION << qint64(QDateTime::currentMSecsSinceEpoch());
+    m_startNs = LatencyHistogram::nowNs();
+    m_lastFlushNs = m_startNs;
+    m_records = 0;
+    LOG_INFO(QString("Recording TWS callbacks to %1").arg(path));
+    return true;
+}
+
+void MarketJournalWriter::close()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_file.isOpen()) return;
+
+    m_stream.setDevice(nullptr);
+    m_file.close();
+    LOG_INFO(QString("Market journal %1 closed (%2 records)").arg(m_file.fileName()).arg(m_records));
+}
+
+bool MarketJournalWriter::begin(JournalRecord type)
+{
+    qint64 ns = LatencyHistogram::nowNs();
+    m_mutex.lock();
+    if (!m_file.isOpen()) {
+        m_mutex.unlock();
+        return false;
+    }
+    m_stream << quint8(type) << (ns - m_startNs);
+    return true;
+}
+
+void MarketJournalWriter::end()
+{
+    m_records++;
+    // A crash loses at most the last second (and QFile's buffer), not the whole incident
+    qint64 ns = LatencyHistogram::nowNs();
+    if (ns - m_lastFlushNs > FLUSH_INTERVAL_NS) {
+        m_file.flush();
+        m_lastFlushNs = ns;
+    }
+    m_mutex.unlock();
+}
+
+void MarketJournalWriter::writeString(const std::string& value)
+{
+    m_stream << QByteArray::fromRawData(value.data(), static_cast<qsizetype>(value.size()));
+}
+
+void MarketJournalWriter::writeString(const QString& value)
+{
+    m_stream << value.toUtf8();
+}
+
+void MarketJournalWriter::requestTickByTick(int reqId, const QString& symbol)
+{
+    if (!begin(JournalRecord::RequestTickByTick)) return;
+    m_stream << qint32(reqId);
+    writeString(symbol);
+    end();
+}
+
+void MarketJournalWriter::cancelTickByTick(int reqId)
+{
+    if (!begin(JournalRecord::CancelTickByTick)) return;
+    m_stream << qint32(reqId);
+    end();
+}
+
+void MarketJournalWriter::requestRealTimeBars(int reqId, const QString& symbol)
+{
+    if (!begin(JournalRecord::RequestRealTimeBars)) return;
+    m_stream << qint32(reqId);
+    writeString(symbol);
+    end();
+}
+
+void MarketJournalWriter::cancelRealTimeBars(int reqId)
+{
+    if (!begin(JournalRecord::CancelRealTimeBars)) return;
+    m_stream << qint32(reqId);
+    end();
+}
+
+void MarketJournalWriter::requestHistorical(int reqId, const QString& symbol, const QString& endDateTime, const QString& duration, const QString& barSize)
+{
+    if (!begin(JournalRecord::RequestHistorical)) return;
+    m_stream << qint32(reqId);
+    writeString(symbol);
+    writeString(endDateTime);
+    writeString(duration);
+    writeString(barSize);
+    end();
+}
+
+void MarketJournalWriter::nextValidId(long orderId)
+{
+    if (!begin(JournalRecord::NextValidId)) return;
+    m_stream << qint64(orderId);
+    end();
+}
+
+void MarketJournalWriter::managedAccounts(const std::string& accounts)
+{
+    if (!begin(JournalRecord::ManagedAccounts)) return;
+    writeString(accounts);
+    end();
+}
+
+void MarketJournalWriter::error(int id, int code, const std::string& message)
+{
+    if (!begin(JournalRecord::Error)) return;
+    m_stream << qint32(id) << qint32(code);
+    writeString(message);
+    end();
+}
+
+void MarketJournalWriter::tickPrice(int tickerId, int field, double price)
+{
+    if (!begin(JournalRecord::TickPrice)) return;
+    m_stream << qint32(tickerId) << qint32(field) << price;
+    end();
+}
+
+void MarketJournalWriter::tickSize(int tickerId, int field, Decimal size)
+{
+    if (!begin(JournalRecord::TickSize)) return;
+    m_stream << qint32(tickerId) << qint32(field) << quint64(size);
+    end();
+}
+
+void MarketJournalWriter::tickByTickBidAsk(int reqId, qint64 time, double bid, double ask, Decimal bidSize, Decimal askSize)
+{
+    if (!begin(JournalRecord::TickByTickBidAsk)) return;
+    m_stream << qint32(reqId) << time << bid << ask << quint64(bidSize) << quint64(askSize);
+    end();
+}
+
+void MarketJournalWriter::tickByTickAllLast(int reqId, int tickType, qint64 time, double price, Decimal size,
+                                            const std::string& exchange, const std::string& conditions)
+{
+    if (!begin(JournalRecord::TickByTickAllLast)) return;
+    m_stream << qint32(reqId) << qint32(tickType) << time << price << quint64(size);
+    writeString(exchange);
+    writeString(conditions);
+    end();
+}
+
+void MarketJournalWriter::realtimeBar(int reqId, qint64 time, double open, double high, double low, double close,
+                                      Decimal volume, Decimal wap, int count)
+{
+    if (!begin(JournalRecord::RealtimeBar)) return;
+    m_stream << qint32(reqId) << time << open << high << low << close << quint64(volume) << quint64(wap) << qint32(count);
+    end();
+}
+
+void MarketJournalWriter::historicalData(int reqId, const Bar& bar)
+{
+    if (!begin(JournalRecord::HistoricalData)) return;
+    m_stream << qint32(reqId);
+    writeString(bar.time);
+    m_stream << bar.open << bar.high << bar.low << bar.close << quint64(bar.volume) << quint64(bar.wap) << qint32(bar.count);
+    end();
+}
+
+void MarketJournalWriter::historicalDataEnd(int reqId)
+{
+    if (!begin(JournalRecord::HistoricalDataEnd)) return;
+    m_stream << qint32(reqId);
+    end();
+}
+
+void MarketJournalWriter::orderStatus(long orderId, const std::string& status, Decimal filled, Decimal remaining,
+                                      double avgFillPrice, long long permId, double lastFillPrice)
+{
+    if (!begin(JournalRecord::OrderStatus)) return;
+    m_stream << qint64(orderId);
+    writeString(status);
+    m_stream << quint64(filled) << quint64(remaining) << avgFillPrice << qint64(permId) << lastFillPrice;
+    end();
+}
+
+void MarketJournalWriter::openOrder(long orderId, const std::string& symbol, const std::string& action, Decimal quantity,
+                                    const std::string& orderType, double limitPrice, long long permId, const std::string& status)
+{
+    if (!begin(JournalRecord::OpenOrder)) return;
+    m_stream << qint64(orderId);
+    writeString(symbol);
+    writeString(action);
+    m_stream << quint64(quantity);
+    writeString(orderType);
+    m_stream << limitPrice << qint64(permId);
+    writeString(status);
+    end();
+}
+
+void MarketJournalWriter::completedOrder(long orderId, const std::string& symbol, const std::string& action,
+                                         Decimal filledQuantity, Decimal totalQuantity, double limitPrice,
+                                         long long permId, const std::string& status)
+{
+    if (!begin(JournalRecord::CompletedOrder)) return;
+    m_stream << qint64(orderId);
+    writeString(symbol);
+    writeString(action);
+    m_stream << quint64(filledQuantity) << quint64(totalQuantity) << limitPrice << qint64(permId);
+    writeString(status);
+    end();
+}
+
+void MarketJournalWriter::execDetails(int reqId, long orderId, const std::string& symbol, const std::string& side,
+                                      Decimal shares, double price, const std::string& execId)
+{
+    if (!begin(JournalRecord::ExecDetails)) return;
+    m_stream << qint32(reqId) << qint64(orderId);
+    writeString(symbol);
+    writeString(side);
+    m_stream << quint64(shares) << price;
+    writeString(execId);
+    end();
+}
+
+void MarketJournalWriter::accountValue(const std::string& key, const std::string& value, const std::string& currency,
+                                       const std::string& account)
+{
+    if (!begin(JournalRecord::AccountValue)) return;
+    writeString(key);
+    writeString(value);
+    writeString(currency);
+    writeString(account);
+    end();
+}
+
+void MarketJournalWriter::portfolio(const std::string& symbol, Decimal position, double marketPrice, double marketValue,
+                                    double averageCost, double unrealizedPNL, double realizedPNL, const std::string& account)
+{
+    if (!begin(JournalRecord::Portfolio)) return;
+    writeString(symbol);
+    m_stream << quint64(position) << marketPrice << marketValue << averageCost << unrealizedPNL << realizedPNL;
+    writeString(account);
+    end();
+}
+
+void MarketJournalWriter::accountDownloadEnd(const std::string& account)
+{
+    if (!begin(JournalRecord::AccountDownloadEnd)) return;
+    writeString(account);
+    end();
+}
+
+JournalReplayer::JournalReplayer(IBKRClient* client, QObject* parent)
+    : QObject(parent)
+    , m_client(client)
+    , m_speed(1.0)
+    , m_running(false)
+    , m_startNs(0)
+    , m_nextType(JournalRecord::NextValidId)
+    , m_nextNs(0)
+    , m_hasNext(false)
+    , m_records(0)
+    , m_unmatched(0)
+{
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &JournalReplayer::step);
+    connect(m_client, &IBKRClient::historicalDataRequested, this, &JournalReplayer::onHistoricalRequested);
+    // Data for a session that ended has nowhere to go
+    connect(m_client, &IBKRClient::disconnected, this, &JournalReplayer::stop);
+}
+
+JournalReplayer::~JournalReplayer()
+{
+    stop();
+}
+
+bool JournalReplayer::start(const QString& path, double speed)
+{
+    if (m_running) return false;
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        LOG_ERROR(QString("Cannot open market journal %1: %2").arg(path).arg(m_file.errorString()));
+        return false;
+    }
+
+    m_stream.setDevice(&m_file);
+    m_stream.setByteOrder(QDataStream::LittleEndian);
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint64 recordedMs = 0;
+    m_stream >> magic >> version >> recordedMs;
+    if (m_stream.status() != QDataStream::Ok || magic != JOURNAL_MAGIC || version != JOURNAL_VERSION) {
+        LOG_ERROR(QString("%1 is not a market journal (or a newer format version)").arg(path));
+        m_stream.setDevice(nullptr);
+        m_file.close();
+        return false;
+    }
+
+    m_speed = speed;
+    m_records = 0;
+    m_unmatched = 0;
+    m_recordedTickByTick.clear();
+    m_recordedRealTimeBars.clear();
+    m_recordedHistorical.clear();
+    m_liveReqIds.clear();
+    m_historyInProgress.clear();
+    m_history.clear();
+    m_pendingHistory.clear();
+
+    LOG_INFO(QString("Replaying market journal %1 (recorded %2) at %3")
+        .arg(path)
+        .arg(QDateTime::fromMSecsSinceEpoch(recordedMs).toString("yyyy-MM-dd HH:mm:ss"))
+        .arg(speed > 0 ? QString("%1x").arg(speed) : QString("max speed")));
+
+    m_client->startOfflineSession();
+    m_running = true;
+    m_startNs = LatencyHistogram::nowNs();
+    m_hasNext = readHeader(m_nextType, m_nextNs);
+    scheduleNext();
+    return true;
+}
+
+void JournalReplayer::stop()
+{
+    if (!m_running) return;
+    m_running = false;
+    m_timer->stop();
+    m_stream.setDevice(nullptr);
+    m_file.close();
+}
+
+bool JournalReplayer::readHeader(JournalRecord& type, qint64& ns)
+{
+    quint8 rawType = 0;
+    m_stream >> rawType >> ns;
+    type = static_cast<JournalRecord>(rawType);
+    return m_stream.status() == QDataStream::Ok;
+}
+
+void JournalReplayer::scheduleNext()
+{
+    if (!m_hasNext) {
+        finish();
+        return;
+    }
+
+    int delayMs = 0;
+    if (m_speed > 0) {
+        qint64 dueNs = static_cast<qint64>(m_nextNs / m_speed) - (LatencyHistogram::nowNs() - m_startNs);
+        // Long recorded pauses are waited out in 1 s steps so stop() stays cheap
+        delayMs = dueNs <= 0 ? 0 : static_cast<int>(qMin<qint64>(dueNs / 1000000, 1000));
+    }
+    m_timer->start(delayMs);
+}
+
+void JournalReplayer::step()
+{
+    if (!m_running) return;
+
+    qint64 elapsedNs = LatencyHistogram::nowNs() - m_startNs;
+    int batch = 0;
+    while (m_hasNext && batch < MAX_BATCH) {
+        if (m_speed > 0 && static_cast<qint64>(m_nextNs / m_speed) > elapsedNs) break;
+
+        if (!dispatch(m_nextType)) {
+            LOG_WARNING(QString("Market journal ends with a truncated or unknown record (type %1)")
+                .arg(static_cast<int>(m_nextType)));
+            m_hasNext = false;
+            break;
+        }
+        m_records++;
+        batch++;
+        m_hasNext = readHeader(m_nextType, m_nextNs);
+    }
+
+    // Dispatching can call back into stop()
+    if (m_running) {
+        scheduleNext();
+    }
+}
+
+std::string JournalReplayer::readString()
+{
+    QByteArray value;
+    m_stream >> value;
+    return value.toStdString();
+}
+
+int JournalReplayer::liveStream(int recordedReqId, const QHash<int, QString>& recordedRequests, const QHash<int, QString>& liveRequests)
+{
+    auto recorded = recordedRequests.constFind(recordedReqId);
+    if (recorded == recordedRequests.constEnd()) return -1;
+
+    auto cached = m_liveReqIds.constFind(recordedReqId);
+    if (cached != m_liveReqIds.constEnd()) {
+        auto live = liveRequests.constFind(cached.value());
+        if (live != liveRequests.constEnd() && live.value() == recorded.value()) {
+            return cached.value();
+        }
+    }
+
+    for (auto it = liveRequests.constBegin(); it != liveRequests.constEnd(); ++it) {
+        if (it.value() == recorded.value()) {
+            m_liveReqIds.insert(recordedReqId, it.key());
+            return it.key();
+        }
+    }
+    return -1;
+}
+
+bool JournalReplayer::dispatch(JournalRecord type)
+{
+    IBKRWrapper* wrapper = m_client->wrapper();
+    qint32 id = 0;
+    qint32 code = 0;
+    qint64 orderId = 0;
+    qint64 time = 0;
+    qint64 permId = 0;
+    double price = 0.0;
+    quint64 a = 0;
+    quint64 b = 0;
+
+    switch (type) {
+    case JournalRecord::RequestTickByTick: {
+        m_stream >> id;
+        QString symbol = QString::fromStdString(readString());
+        if (m_stream.status() != QDataStream::Ok) return false;
+        m_recordedTickByTick.insert(id, symbol);
+        m_liveReqIds.remove(id);
+        // Follow the recorded session into tickers the app isn't streaming yet
+        if (!m_client->tickByTickRequests().values().contains(symbol)) {
+            emit tickerRequested(symbol);
+        }
+        return true;
+    }
+    case JournalRecord::CancelTickByTick:
+        m_stream >> id;
+        m_recordedTickByTick.remove(id);
+        m_liveReqIds.remove(id);
+        break;
+    case JournalRecord::RequestRealTimeBars: {
+        m_stream >> id;
+        QString symbol = QString::fromStdString(readString());
+        m_recordedRealTimeBars.insert(id, symbol);
+        m_liveReqIds.remove(id);
+        break;
+    }
+    case JournalRecord::CancelRealTimeBars:
+        m_stream >> id;
+        m_recordedRealTimeBars.remove(id);
+        m_liveReqIds.remove(id);
+        break;
+    case JournalRecord::RequestHistorical: {
+        m_stream >> id;
+        QString symbol = QString::fromStdString(readString());
+        readString(); // endDateTime
+        readString(); // duration
+        QString barSize = QString::fromStdString(readString());
+        m_recordedHistorical.insert(id, historyKey(symbol, barSize));
+        break;
+    }
+    case JournalRecord::NextValidId:
+        m_stream >> orderId; // The offline session hands out its own ids
+        break;
+    case JournalRecord::ManagedAccounts: {
+        std::string accounts = readString();
+        if (m_stream.status() != QDataStream::Ok) return false;
+        wrapper->managedAccounts(accounts);
+        return true;
+    }
+    case JournalRecord::Error: {
+        m_stream >> id >> code;
+        std::string message = readString();
+        if (m_stream.status() != QDataStream::Ok) return false;
+        bool recordedRequest = m_recordedTickByTick.contains(id) || m_recordedRealTimeBars.contains(id)
+                               || m_recordedHistorical.contains(id);
+        if (isConnectionStatus(code) || recordedRequest) {
+            m_unmatched++;
+        } else {
+            wrapper->error(id, 0, code, message, "");
+        }
+        return true;
+    }
+    case JournalRecord::TickPrice: {
+        qint32 field = 0;
+        m_stream >> id >> field >> price;
+        if (m_stream.status() != QDataStream::Ok) return false;
+        wrapper->tickPrice(id, static_cast<TickType>(field), price, TickAttrib());
+        return true;
+    }
+    case JournalRecord::TickSize: {
+        qint32 field = 0;
+        m_stream >> id >> field >> a;
+        if (m_stream.status() != QDataStream::Ok) return false;
+        wrapper->tickSize(id, static_cast<TickType>(field), a);
+        return true;
+    }
+    case JournalRecord::TickByTickBidAsk: {
+        double ask = 0.0;
+        m_stream >> id >> time >> price >> ask >> a >> b;
+        if (m_stream.status() != QDataStream::Ok) return false;
+        int reqId = liveStream(id, m_recordedTickByTick, m_client->tickByTickRequests());
+        if (reqId < 0) {
+            m_unmatched++;
+        } else {
+            wrapper->tickByTickBidAsk(reqId, static_cast<time_t>(time), price, ask, a, b, TickAttribBidAsk());
+        }
+        return true;
+    }
+    case JournalRecord::TickByTickAllLast: {
+        qint32 tickType = 0;
+        m_stream >> id >> tickType >> time >> price >> a;
+        std::string exchange = readString();
+        std::string conditions = readString();
+        if (m_stream.status() != QDataStream::Ok) return false;
+        int reqId = liveStream(id, m_recordedTickByTick, m_client->tickByTickRequests());
+        if (reqId < 0) {
+            m_unmatched++;
+        } else {
+            wrapper->tickByTickAllLast(reqId, tickType, static_cast<time_t>(time), price, a, TickAttribLast(), exchange, conditions);
+        }
+        return true;
+    }
+    case JournalRecord::RealtimeBar: {
+        double open = 0.0, high = 0.0, low = 0.0;
+        qint32 count = 0;
+        m_stream >> id >> time >> open >> high >> low >> price >> a >> b >> count;
+        if (m_stream.status() != QDataStream::Ok) return false;
+        int reqId = liveStream(id, m_recordedRealTimeBars, m_client->realTimeBarRequests());
+        if (reqId < 0) {
+            m_unmatched++;
+        } else {
+            wrapper->realtimeBar(reqId, static_cast<long>(time), open, high, low, price, a, b, count);
+        }
+        return true;
+    }
+    case JournalRecord::HistoricalData: {
+        Bar bar;
+        qint32 count = 0;
+        m_stream >> id;
+        bar.time = readString();
+        m_stream >> bar.open >> bar.high >> bar.low >> bar.close >> a >> b >> count;
+        bar.volume = a;
+        bar.wap = b;
+        bar.count = count;
+        if (m_recordedHistorical.contains(id)) {
+            m_historyInProgress[id].append(bar);
+        }
+        break;
+    }
+    case JournalRecord::HistoricalDataEnd: {
+        m_stream >> id;
+        if (m_stream.status() != QDataStream::Ok) return false;
+        QString key = m_recordedHistorical.take(id);
+        if (key.isEmpty()) return true;
+
+        QVector<Bar> bars = m_historyInProgress.take(id);
+        m_history.insert(key, bars);
+        const QVector<int> waiting = m_pendingHistory.take(key);
+        for (int reqId : waiting) {
+            answerHistorical(reqId, bars);
+        }
+        return true;
+    }
+    case JournalRecord::OrderStatus: {
+        double avgFillPrice = 0.0;
+        m_stream >> orderId;
+        std::string status = readString();
+        m_stream >> a >> b >> avgFillPrice >> permId >> price;
+        if (m_stream.status() != QDataStream::Ok) return false;
+        wrapper->orderStatus(orderId, status, a, b, avgFillPrice, permId, 0, price, 0, "", 0.0);
+        return true;
+    }
+    case JournalRecord::OpenOrder: {
+        Contract contract;
+        Order order;
+        OrderState state;
+        m_stream >> orderId;
+        contract.symbol = readString();
+        contract.secType = "STK";
+        order.action = readString();
+        m_stream >> a;
+        order.orderType = readString();
+        m_stream >> order.lmtPrice >> permId;
+        state.status = readString();
+        if (m_stream.status() != QDataStream::Ok) return false;
+        order.orderId = orderId;
+        order.totalQuantity = a;
+        order.permId = permId;
+        wrapper->openOrder(orderId, contract, order, state);
+        return true;
+    }
+    case JournalRecord::CompletedOrder: {
+        Contract contract;
+        Order order;
+        OrderState state;
+        m_stream >> orderId;
+        contract.symbol = readString();
+        contract.secType = "STK";
+        order.action = readString();
+        m_stream >> a >> b >> order.lmtPrice >> permId;
+        state.status = readString();
+        if (m_stream.status() != QDataStream::Ok) return false;
+        order.orderId = orderId;
+        order.filledQuantity = a;
+        order.totalQuantity = b;
+        order.permId = permId;
+        wrapper->completedOrder(contract, order, state);
+        return true;
+    }
+    case JournalRecord::ExecDetails: {
+        Contract contract;
+        Execution execution;
+        m_stream >> id >> orderId;
+        contract.symbol = readString();
+        contract.secType = "STK";
+        execution.side = readString();
+        m_stream >> a >> execution.price;
+        execution.execId = readString();
+        if (m_stream.status() != QDataStream::Ok) return false;
+        execution.orderId = orderId;
+        execution.shares = a;
+        wrapper->execDetails(id, contract, execution);
+        return true;
+    }
+    case JournalRecord::AccountValue: {
+        std::string key = readString();
+        std::string value = readString();
+        std::string currency = readString();
+        std::string account = readString();
+        if (m_stream.status() != QDataStream::Ok) return false;
+        wrapper->updateAccountValue(key, value, currency, account);
+        return true;
+    }
+    case JournalRecord::Portfolio: {
+        Contract contract;
+        double marketPrice = 0.0, marketValue = 0.0, averageCost = 0.0, unrealizedPNL = 0.0, realizedPNL = 0.0;
+        contract.symbol = readString();
+        contract.secType = "STK";
+        m_stream >> a >> marketPrice >> marketValue >> averageCost >> unrealizedPNL >> realizedPNL;
+        std::string account = readString();
+        if (m_stream.status() != QDataStream::Ok) return false;
+        wrapper->updatePortfolio(contract, a, marketPrice, marketValue, averageCost, unrealizedPNL, realizedPNL, account);
+        return true;
+    }
+    case JournalRecord::AccountDownloadEnd: {
+        std::string account = readString();
+        if (m_stream.status() != QDataStream::Ok) return false;
+        wrapper->accountDownloadEnd(account);
+        return true;
+    }
+    default:
+        return false; // Records carry no length, an unknown type can't be skipped
+    }
+
+    return m_stream.status() == QDataStream::Ok;
+}
+
+void JournalReplayer::onHistoricalRequested(int reqId, const QString& symbol, const QString& endDateTime,
+                                            const QString& duration, const QString& barSize)
+{
+    Q_UNUSED(endDateTime);
+    Q_UNUSED(duration);
+    if (!m_running) return;
+
+    QString key = historyKey(symbol, barSize);
+    auto it = m_history.constFind(key);
+    if (it == m_history.constEnd()) {
+        m_pendingHistory[key].append(reqId); // Answered when the replay reaches a recorded response
+        return;
+    }
+
+    // Not from inside the requester's call
+    QVector<Bar> bars = it.value();
+    QMetaObject::invokeMethod(this, [this, reqId, bars]() { answerHistorical(reqId, bars); }, Qt::QueuedConnection);
+}
+
+void JournalReplayer::answerHistorical(int reqId, const QVector<Bar>& bars)
+{
+    IBKRWrapper* wrapper = m_client->wrapper();
+    for (const Bar& bar : bars) {
+        wrapper->historicalData(reqId, bar);
+    }
+    wrapper->historicalDataEnd(reqId, "", "");
+}
+
+void JournalReplayer::finish()
+{
+    double seconds = (LatencyHistogram::nowNs() - m_startNs) / 1e9;
+    int pending = 0;
+    for (auto it = m_pendingHistory.constBegin(); it != m_pendingHistory.constEnd(); ++it) {
+        pending += it.value().size();
+    }
+
+    stop();
+    LOG_INFO(QString("Replay finished: %1 records in %2 s, %3 unmatched, %4 historical requests without a recorded response")
+        .arg(m_records).arg(seconds, 0, 'f', 1).arg(m_unmatched).arg(pending));
+    emit finished(m_records, m_unmatched, seconds);
+}
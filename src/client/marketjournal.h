@@ -0,0 +1,180 @@
+#ifndef MARKETJOURNAL_H
+#define MARKETJOURNAL_H
+
+#include <QObject>
+#include <QFile>
+#include <QDataStream>
+#include <QHash>
+#include <QVector>
+#include <QMutex>
+#include <QTimer>
+#include <string>
+#include "bar.h"
+#include "Decimal.h"
+
+class IBKRClient;
+
+// Record types in a journal file (values are part of the file format - append only)
+enum class JournalRecord : quint8 {
+    RequestTickByTick = 1,
+    CancelTickByTick,
+    RequestRealTimeBars,
+    CancelRealTimeBars,
+    RequestHistorical,
+    NextValidId,
+    ManagedAccounts,
+    Error,
+    TickPrice,
+    TickByTickBidAsk,
+    TickByTickAllLast,
+    RealtimeBar,
+    HistoricalData,
+    HistoricalDataEnd,
+    OrderStatus,
+    OpenOrder,
+    CompletedOrder,
+    ExecDetails,
+    AccountValue,
+    Portfolio,
+    AccountDownloadEnd,
+    TickSize
+};
+
+/**
+ * @brief Appends raw EWrapper callbacks (and the requests they answer) to a binary journal
+ *
+ * File: header (magic, format version, wall-clock start in ms), then one record per
+ * callback: type byte, monotonic nanoseconds since the journal was opened, and the
+ * callback arguments the app uses. Decimals are stored as their raw 64-bit value,
+ * strings as length-prefixed bytes. Buffered, flushed at most once a second.
+ *
+ * Thread-safe: the wrapper records from the dispatcher thread, IBKRClient records
+ * requests from the engine thread.
+ */
+class MarketJournalWriter
+{
+public:
+    MarketJournalWriter();
+    ~MarketJournalWriter();
+
+    bool open(const QString& path);
+    void close();
+    QString path() const { return m_file.fileName(); }
+
+    // Requests (reqId -> symbol lets replay map recorded ids to the ones it is given)
+    void requestTickByTick(int reqId, const QString& symbol);
+    void cancelTickByTick(int reqId);
+    void requestRealTimeBars(int reqId, const QString& symbol);
+    void cancelRealTimeBars(int reqId);
+    void requestHistorical(int reqId, const QString& symbol, const QString& endDateTime, const QString& duration, const QString& barSize);
+
+    // Callbacks
+    void nextValidId(long orderId);
+    void managedAccounts(const std::string& accounts);
+    void error(int id, int code, const std::string& message);
+    void tickPrice(int tickerId, int field, double price);
+    void tickSize(int tickerId, int field, Decimal size);
+    void tickByTickBidAsk(int reqId, qint64 time, double bid, double ask, Decimal bidSize, Decimal askSize);
+    void tickByTickAllLast(int reqId, int tickType, qint64 time, double price, Decimal size,
+                           const std::string& exchange, const std::string& conditions);
+    void realtimeBar(int reqId, qint64 time, double open, double high, double low, double close, Decimal volume, Decimal wap, int count);
+    void historicalData(int reqId, const Bar& bar);
+    void historicalDataEnd(int reqId);
+    void orderStatus(long orderId, const std::string& status, Decimal filled, Decimal remaining, double avgFillPrice,
+                     long long permId, double lastFillPrice);
+    void openOrder(long orderId, const std::string& symbol, const std::string& action, Decimal quantity,
+                   const std::string& orderType, double limitPrice, long long permId, const std::string& status);
+    void completedOrder(long orderId, const std::string& symbol, const std::string& action, Decimal filledQuantity,
+                        Decimal totalQuantity, double limitPrice, long long permId, const std::string& status);
+    void execDetails(int reqId, long orderId, const std::string& symbol, const std::string& side, Decimal shares,
+                     double price, const std::string& execId);
+    void accountValue(const std::string& key, const std::string& value, const std::string& currency, const std::string& account);
+    void portfolio(const std::string& symbol, Decimal position, double marketPrice, double marketValue, double averageCost,
+                   double unrealizedPNL, double realizedPNL, const std::string& account);
+    void accountDownloadEnd(const std::string& account);
+
+private:
+    // Starts a record under m_mutex; returns false if no file is open
+    bool begin(JournalRecord type);
+    void end();
+    void writeString(const std::string& value);
+    void writeString(const QString& value);
+
+    QMutex m_mutex;
+    QFile m_file;
+    QDataStream m_stream;
+    qint64 m_startNs;
+    qint64 m_lastFlushNs;
+    quint64 m_records;
+};
+
+/**
+ * @brief Feeds a recorded journal into IBKRClient's wrapper instead of a socket
+ *
+ * start() opens an offline session (IBKRClient::startOfflineSession()) and replays
+ * the callbacks with their recorded spacing divided by the speed factor, or as fast
+ * as the engine can take them (speed <= 0; the event loop still runs between
+ * batches). Recorded stream reqIds are mapped by symbol to the requests the app
+ * made in this session; a recorded tick-by-tick request for a symbol the app isn't
+ * streaming emits tickerRequested() so the UI can follow the recorded session.
+ * Historical requests are answered with the latest recorded response for the same
+ * symbol and bar size, or as soon as the replay reaches one. Connection status
+ * errors (1100/1300/...) are skipped, they would end the offline session.
+ *
+ * Lives on the engine thread (see EngineThread).
+ */
+class JournalReplayer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit JournalReplayer(IBKRClient* client, QObject* parent = nullptr);
+    ~JournalReplayer();
+
+    bool start(const QString& path, double speed);
+    void stop();
+    bool isRunning() const { return m_running; }
+
+signals:
+    void tickerRequested(const QString& symbol);
+    void finished(quint64 records, quint64 unmatched, double seconds);
+
+private slots:
+    void step();
+    void onHistoricalRequested(int reqId, const QString& symbol, const QString& endDateTime, const QString& duration, const QString& barSize);
+
+private:
+    static const int MAX_BATCH = 2048; // Records per event loop turn at max speed
+
+    bool readHeader(JournalRecord& type, qint64& ns);
+    bool dispatch(JournalRecord type); // False if the record is truncated or unknown
+    void scheduleNext();
+    int liveStream(int recordedReqId, const QHash<int, QString>& recordedRequests, const QHash<int, QString>& liveRequests);
+    void answerHistorical(int reqId, const QVector<Bar>& bars);
+    std::string readString();
+    void finish();
+
+    IBKRClient* m_client;
+    QTimer* m_timer;
+    QFile m_file;
+    QDataStream m_stream;
+    double m_speed;
+    bool m_running;
+    qint64 m_startNs;         // Replay start (LatencyHistogram::nowNs())
+    JournalRecord m_nextType; // Header of the next record, read ahead for scheduling
+    qint64 m_nextNs;
+    bool m_hasNext;
+
+    QHash<int, QString> m_recordedTickByTick;  // Recorded reqId -> symbol
+    QHash<int, QString> m_recordedRealTimeBars;
+    QHash<int, QString> m_recordedHistorical;  // Recorded reqId -> "symbol|barSize"
+    QHash<int, int> m_liveReqIds;              // Recorded reqId -> reqId of this session (cache)
+    QHash<int, QVector<Bar>> m_historyInProgress;
+    QHash<QString, QVector<Bar>> m_history;    // "symbol|barSize" -> latest recorded response
+    QHash<QString, QVector<int>> m_pendingHistory; // "symbol|barSize" -> reqIds waiting for a response
+
+    quint64 m_records;
+    quint64 m_unmatched; // Stream data for symbols the app isn't streaming, skipped errors
+};
+
+#endif // MARKETJOURNAL_H
@@ -0,0 +1,52 @@
+#include "client/messagedispatcher.h"
+#include "utils/logger.h"
+#include "EReader.h"
+#include "EReaderOSSignal.h"
+#include <system_error>
+
+MessageDispatcher::MessageDispatcher(EReaderOSSignal* signal, QObject* parent)
+    : QThread(parent)
+    , m_signal(signal)
+    , m_reader(nullptr)
+    , m_stopRequested(false)
+{
+}
+
+MessageDispatcher::~MessageDispatcher()
+{
+    stopDispatching();
+}
+
+void MessageDispatcher::startDispatching(EReader* reader)
+{
+    stopDispatching();
+
+    m_reader = reader;
+    m_stopRequested = false;
+    start(QThread::TimeCriticalPriority);
+}
+
+void MessageDispatcher::stopDispatching()
+{
+    if (!isRunning()) return;
+
+    m_stopRequested = true;
+    m_signal->issueSignal(); // Wake waitForSignal()
+    wait();
+    m_reader = nullptr;
+}
+
+void MessageDispatcher::run()
+{
+    while (!m_stopRequested) {
+        // Blocks until EReader has queued at least one message
+        m_signal->waitForSignal();
+        if (m_stopRequested) break;
+
+        try {
+            m_reader->processMsgs();
+        } catch (const std::system_error& e) {
+            LOG_WARNING(QString("processMsgs() failed: %1").arg(e.what()));
+        }
+    }
+}
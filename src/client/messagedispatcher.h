@@ -0,0 +1,38 @@
+#ifndef MESSAGEDISPATCHER_H
+#define MESSAGEDISPATCHER_H
+
+#include <QThread>
+#include <atomic>
+
+class EReader;
+class EReaderOSSignal;
+
+/**
+ * @brief Thread that runs EReader::processMsgs() as soon as the reader signals new messages
+ *
+ * Replaces polling the message queue from a GUI timer. EWrapper callbacks run
+ * on this thread: ticks are handed to the engine thread (see EngineThread) through
+ * IBKRClient's lock-free tick queue, everything else through queued signals.
+ */
+class MessageDispatcher : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit MessageDispatcher(EReaderOSSignal* signal, QObject* parent = nullptr);
+    ~MessageDispatcher();
+
+    // Both called from the owning (engine) thread
+    void startDispatching(EReader* reader);
+    void stopDispatching(); // Wakes the thread and waits for it; reader may be destroyed afterwards
+
+protected:
+    void run() override;
+
+private:
+    EReaderOSSignal* m_signal;
+    EReader* m_reader;
+    std::atomic<bool> m_stopRequested;
+};
+
+#endif // MESSAGEDISPATCHER_H
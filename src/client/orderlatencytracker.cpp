@@ -0,0 +1,196 @@
+#include "client/orderlatencytracker.h"
+#include <QMutexLocker>
+#include <QStringList>
+
+OrderLatencyTracker::OrderLatencyTracker()
+    : m_ring(RING_SIZE)
+    , m_next(0)
+    , m_size(0)
+    , m_globalCancelSlot(-1)
+{
+    m_slotByOrderId.reserve(RING_SIZE);
+}
+
+void OrderLatencyTracker::begin(int orderId, OrderTimeline::Request request, qint64 keypressNs, qint64 callNs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    int slot = m_next;
+    m_next = (m_next + 1) % RING_SIZE;
+    m_size = qMin(m_size + 1, RING_SIZE);
+
+    // Forget the request being overwritten unless a newer request took over its id
+    const OrderTimeline& old = m_ring[slot];
+    if (old.orderId >= 0 && m_slotByOrderId.value(old.orderId, -1) == slot) {
+        m_slotByOrderId.remove(old.orderId);
+    }
+    if (m_globalCancelSlot == slot) {
+        m_globalCancelSlot = -1;
+    }
+
+    OrderTimeline& timeline = m_ring[slot];
+    timeline = OrderTimeline();
+    timeline.orderId = orderId;
+    timeline.request = request;
+    timeline.keypressNs = keypressNs;
+    timeline.callNs = callNs;
+
+    if (orderId >= 0) {
+        m_slotByOrderId.insert(orderId, slot);
+    } else {
+        m_globalCancelSlot = slot;
+    }
+}
+
+void OrderLatencyTracker::written(int orderId, qint64 writeNs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    OrderTimeline* timeline = orderId >= 0 ? find(orderId)
+                                           : (m_globalCancelSlot >= 0 ? &m_ring[m_globalCancelSlot] : nullptr);
+    if (!timeline) return;
+
+    timeline->writeNs = writeNs;
+    timeline->wallTime = QDateTime::currentDateTime();
+    m_stages[CallToWrite].record(writeNs - timeline->callNs);
+    if (timeline->keypressNs > 0) {
+        m_stages[KeyToCall].record(timeline->callNs - timeline->keypressNs);
+        m_stages[KeyToWrite].record(writeNs - timeline->keypressNs);
+    }
+}
+
+void OrderLatencyTracker::ackReceived(int orderId, qint64 receivedNs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    OrderTimeline* timeline = find(orderId);
+    if (!timeline || timeline->writeNs == 0 || timeline->ackNs > 0) return; // openOrder repeats on every change
+
+    timeline->ackNs = receivedNs;
+    m_stages[WriteToAck].record(receivedNs - timeline->writeNs);
+}
+
+void OrderLatencyTracker::statusReceived(int orderId, const QString& status, qint64 receivedNs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    OrderTimeline* timeline = find(orderId);
+    if (!timeline || timeline->writeNs == 0) return;
+
+    if (timeline->firstStatusNs == 0) {
+        timeline->firstStatusNs = receivedNs;
+    }
+    timeline->lastStatusNs = receivedNs;
+    timeline->lastStatus = status;
+    timeline->statusCount++;
+    m_stages[WriteToStatus].record(receivedNs - timeline->writeNs);
+}
+
+void OrderLatencyTracker::executionReceived(int orderId, qint64 receivedNs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    OrderTimeline* timeline = find(orderId);
+    if (!timeline || timeline->writeNs == 0) return;
+
+    if (timeline->firstExecNs == 0) {
+        timeline->firstExecNs = receivedNs;
+    }
+    timeline->execCount++;
+    m_stages[WriteToExec].record(receivedNs - timeline->writeNs);
+}
+
+OrderTimeline* OrderLatencyTracker::find(int orderId)
+{
+    auto it = m_slotByOrderId.constFind(orderId);
+    return it != m_slotByOrderId.constEnd() ? &m_ring[it.value()] : nullptr;
+}
+
+LatencyHistogram OrderLatencyTracker::stage(Stage stage) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stages[stage];
+}
+
+QVector<OrderTimeline> OrderLatencyTracker::timelines() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    QVector<OrderTimeline> result;
+    result.reserve(m_size);
+    int start = (m_next - m_size + RING_SIZE) % RING_SIZE;
+    for (int i = 0; i < m_size; ++i) {
+        result.append(m_ring[(start + i) % RING_SIZE]);
+    }
+    return result;
+}
+
+QString OrderLatencyTracker::toCsv() const
+{
+    // Durations in microseconds, empty when the stage was not reached
+    auto us = [](qint64 fromNs, qint64 toNs) {
+        return (fromNs > 0 && toNs > 0) ? QString::number((toNs - fromNs) / 1000.0, 'f', 1) : QString();
+    };
+
+    QStringList lines;
+    lines << "order_id,request,time,key_to_call_us,call_to_write_us,write_to_ack_us,"
+             "write_to_first_status_us,write_to_last_status_us,status_count,last_status,"
+             "write_to_first_exec_us,exec_count";
+
+    const QVector<OrderTimeline> all = timelines();
+    for (const OrderTimeline& t : all) {
+        lines << QStringList{
+            QString::number(t.orderId),
+            requestName(t.request),
+            t.wallTime.toString("yyyy-MM-dd HH:mm:ss.zzz"),
+            us(t.keypressNs, t.callNs),
+            us(t.callNs, t.writeNs),
+            us(t.writeNs, t.ackNs),
+            us(t.writeNs, t.firstStatusNs),
+            us(t.writeNs, t.lastStatusNs),
+            QString::number(t.statusCount),
+            t.lastStatus,
+            us(t.writeNs, t.firstExecNs),
+            QString::number(t.execCount)
+        }.join(',');
+    }
+    return lines.join('\n') + '\n';
+}
+
+void OrderLatencyTracker::reset()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_ring.fill(OrderTimeline());
+    m_next = 0;
+    m_size = 0;
+    m_slotByOrderId.clear();
+    m_globalCancelSlot = -1;
+    for (int i = 0; i < StageCount; ++i) {
+        m_stages[i].reset();
+    }
+}
+
+QString OrderLatencyTracker::stageName(Stage stage)
+{
+    switch (stage) {
+    case KeyToCall:     return "Keypress -> placeOrder call";
+    case CallToWrite:   return "placeOrder call -> socket write";
+    case KeyToWrite:    return "Keypress -> socket write";
+    case WriteToAck:    return "Socket write -> openOrder ack";
+    case WriteToStatus: return "Socket write -> orderStatus";
+    case WriteToExec:   return "Socket write -> execDetails";
+    default:            return "Unknown";
+    }
+}
+
+QString OrderLatencyTracker::requestName(OrderTimeline::Request request)
+{
+    switch (request) {
+    case OrderTimeline::Place:        return "place";
+    case OrderTimeline::Modify:       return "modify";
+    case OrderTimeline::Cancel:       return "cancel";
+    case OrderTimeline::GlobalCancel: return "global_cancel";
+    default:                          return "unknown";
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef ORDERLATENCYTRACKER_H
+#define ORDERLATENCYTRACKER_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QDateTime>
+#include <QMutex>
+#include "utils/latencyhistogram.h"
+
+// Timestamps of one order request (LatencyHistogram::nowNs(), 0 = not reached)
+struct OrderTimeline {
+    enum Request { Place, Modify, Cancel, GlobalCancel };
+
+    int orderId = -1;           // -1 for a global cancel
+    Request request = Place;
+    QDateTime wallTime;         // When the request was written (for the CSV)
+    qint64 keypressNs = 0;      // Hotkey handled by the GUI (0 if not from a hotkey)
+    qint64 callNs = 0;          // IBKRClient::placeOrder/updateOrder/cancelOrder entered
+    qint64 writeNs = 0;         // Request written to the socket
+    qint64 ackNs = 0;           // First openOrder for this id
+    qint64 firstStatusNs = 0;
+    qint64 lastStatusNs = 0;
+    int statusCount = 0;
+    QString lastStatus;
+    qint64 firstExecNs = 0;
+    int execCount = 0;
+};
+
+/**
+ * @brief Order lifecycle timestamps and per-stage latency histograms
+ *
+ * IBKRClient records the request side (keypress, call, socket write) and the
+ * wrapper records TWS responses (openOrder ack, each orderStatus, each
+ * execDetails) with the time the message was read off the socket. The last
+ * RING_SIZE requests are kept in a fixed ring, looked up by orderId (the newest
+ * request wins, so a cancel's statuses go to the cancel). Responses for ids
+ * not in the ring (orders from other sessions) are ignored.
+ *
+ * Thread-safe: written from the engine and dispatcher threads, read by the
+ * diagnostics dialog.
+ */
+class OrderLatencyTracker
+{
+public:
+    enum Stage {
+        KeyToCall,      // Lane + TradingManager (app)
+        CallToWrite,    // Building and encoding the request (app)
+        KeyToWrite,     // Whole app side
+        WriteToAck,     // TWS + network
+        WriteToStatus,  // Every orderStatus
+        WriteToExec,    // Every execDetails
+        StageCount
+    };
+
+    static const int RING_SIZE = 256;
+
+    OrderLatencyTracker();
+
+    // Request side (engine thread). begin() before the socket write, written() right after
+    void begin(int orderId, OrderTimeline::Request request, qint64 keypressNs, qint64 callNs);
+    void written(int orderId, qint64 writeNs);
+
+    // Response side (dispatcher thread), receivedNs taken when the callback started
+    void ackReceived(int orderId, qint64 receivedNs);
+    void statusReceived(int orderId, const QString& status, qint64 receivedNs);
+    void executionReceived(int orderId, qint64 receivedNs);
+
+    LatencyHistogram stage(Stage stage) const;
+    QVector<OrderTimeline> timelines() const; // Oldest first
+    QString toCsv() const;
+    void reset();
+
+    static QString stageName(Stage stage);
+    static QString requestName(OrderTimeline::Request request);
+
+private:
+    OrderTimeline* find(int orderId); // Caller holds m_mutex
+
+    mutable QMutex m_mutex;
+    QVector<OrderTimeline> m_ring;
+    int m_next;                     // Slot the next request overwrites
+    int m_size;
+    QHash<int, int> m_slotByOrderId;
+    int m_globalCancelSlot;         // Global cancels have no orderId
+    LatencyHistogram m_stages[StageCount];
+};
+
+#endif // ORDERLATENCYTRACKER_H
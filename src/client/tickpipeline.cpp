@@ -0,0 +1,164 @@
+#include "client/tickpipeline.h"
+
+TickPipeline::TickPipeline(int expectedStreams)
+    : m_focusReqId(-1)
+    , m_published(0)
+    , m_dropped(0)
+{
+    m_slots.reserve(expectedStreams);
+    m_freeSlots.reserve(expectedStreams);
+    m_slotByReqId.reserve(expectedStreams);
+}
+
+void TickPipeline::openSlot(int reqId)
+{
+    if (m_slotByReqId.contains(reqId)) return;
+
+    int index;
+    if (!m_freeSlots.isEmpty()) {
+        index = m_freeSlots.takeLast();
+        m_slots[index] = QuoteSlot();
+    } else {
+        index = m_slots.size();
+        m_slots.append(QuoteSlot());
+    }
+    m_slots[index].reqId = reqId;
+    m_slotByReqId.insert(reqId, index);
+}
+
+void TickPipeline::openAlias(int aliasReqId, int reqId)
+{
+    auto it = m_slotByReqId.constFind(reqId);
+    if (it == m_slotByReqId.constEnd() || m_slotByReqId.contains(aliasReqId)) return;
+    m_slotByReqId.insert(aliasReqId, it.value());
+}
+
+void TickPipeline::closeSlot(int reqId)
+{
+    auto it = m_slotByReqId.find(reqId);
+    if (it == m_slotByReqId.end()) return;
+
+    int index = it.value();
+    m_slotByReqId.erase(it);
+    if (m_slots[index].reqId != reqId) return; // Alias - the slot stays
+
+    for (auto alias = m_slotByReqId.begin(); alias != m_slotByReqId.end();) {
+        if (alias.value() == index) {
+            alias = m_slotByReqId.erase(alias);
+        } else {
+            ++alias;
+        }
+    }
+    m_freeSlots.append(index);
+    if (m_focusReqId == reqId) {
+        m_focusReqId = -1;
+    }
+}
+
+void TickPipeline::reset()
+{
+    m_slots.clear();
+    m_freeSlots.clear();
+    m_slotByReqId.clear();
+    m_focusReqId = -1;
+}
+
+void TickPipeline::publish(const Tick& tick)
+{
+    auto it = m_slotByReqId.constFind(tick.reqId);
+    if (it == m_slotByReqId.constEnd()) {
+        m_dropped++;
+        return;
+    }
+
+    QuoteSlot& slot = m_slots[it.value()];
+    Tick& stored = tick.isTrade() ? slot.trade : slot.quote;
+    stored = tick;
+    stored.reqId = slot.reqId;
+    if (tick.isTrade()) {
+        slot.hasTrade = true;
+    } else {
+        slot.hasQuote = true;
+    }
+    m_published++;
+
+    // Consumers get the caller's tick (a copy for aliases) - a consumer may open or close slots
+    if (tick.reqId != slot.reqId) {
+        Tick routed = stored;
+        deliver(routed);
+    } else {
+        deliver(tick);
+    }
+}
+
+void TickPipeline::deliver(const Tick& tick)
+{
+    if (tick.reqId == m_focusReqId) {
+        for (int i = 0; i < m_focusConsumers.size(); ++i) {
+            m_focusConsumers[i]->onTick(tick);
+        }
+    }
+    for (int i = 0; i < m_consumers.size(); ++i) {
+        m_consumers[i]->onTick(tick);
+    }
+}
+
+const Tick* TickPipeline::latest(int reqId) const
+{
+    auto it = m_slotByReqId.constFind(reqId);
+    if (it == m_slotByReqId.constEnd()) return nullptr;
+
+    const QuoteSlot& slot = m_slots[it.value()];
+    return slot.hasQuote ? &slot.quote : nullptr;
+}
+
+const Tick* TickPipeline::latestTrade(int reqId) const
+{
+    auto it = m_slotByReqId.constFind(reqId);
+    if (it == m_slotByReqId.constEnd()) return nullptr;
+
+    const QuoteSlot& slot = m_slots[it.value()];
+    return slot.hasTrade ? &slot.trade : nullptr;
+}
+
+void TickPipeline::addConsumer(TickConsumer* consumer)
+{
+    if (!m_consumers.contains(consumer)) {
+        m_consumers.append(consumer);
+    }
+}
+
+void TickPipeline::addFocusConsumer(TickConsumer* consumer)
+{
+    if (!m_focusConsumers.contains(consumer)) {
+        m_focusConsumers.append(consumer);
+    }
+}
+
+void TickPipeline::removeConsumer(TickConsumer* consumer)
+{
+    m_consumers.removeAll(consumer);
+    m_focusConsumers.removeAll(consumer);
+}
+
+void TickPipeline::setFocus(int reqId)
+{
+    if (m_focusReqId == reqId) return;
+    m_focusReqId = reqId;
+    for (int i = 0; i < m_focusConsumers.size(); ++i) {
+        m_focusConsumers[i]->onFocusChanged(reqId);
+    }
+
+    // Focus consumers start from the last known quote and trade instead of waiting for the next tick
+    const Tick* quote = latest(reqId);
+    const Tick* trade = latestTrade(reqId);
+    Tick ticks[2];
+    int count = 0;
+    if (quote) ticks[count++] = *quote;
+    if (trade) ticks[count++] = *trade;
+    for (int t = 0; t < count; ++t) {
+        for (int i = 0; i < m_focusConsumers.size(); ++i) {
+            m_focusConsumers[i]->onTick(ticks[t]);
+        }
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef TICKPIPELINE_H
+#define TICKPIPELINE_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <QHash>
+#include <type_traits>
+
+enum class TickKind : quint8 {
+    BidAsk, // Quote update: bid/ask and their sizes
+    Trade   // Last / AllLast print: price, size, exchange, conditions
+};
+
+// Tick-by-tick update as it leaves the wrapper (plain data, passed by reference)
+struct Tick {
+    int reqId = -1;
+    TickKind kind = TickKind::BidAsk;
+    qint64 time = 0;    // TWS timestamp (seconds)
+    double price = 0.0; // Last trade price (0 for bid/ask ticks)
+    double bid = 0.0;   // 0 for trade ticks
+    double ask = 0.0;
+    double bidSize = 0.0; // Displayed size at bid/ask (shares)
+    double askSize = 0.0;
+    double size = 0.0;    // Trade size (0 for bid/ask ticks)
+    char exchange[8] = {};   // Trade exchange, truncated to fit (NUL-terminated)
+    char conditions[8] = {}; // Trade special conditions, truncated to fit
+
+    bool isTrade() const { return kind == TickKind::Trade; }
+};
+static_assert(std::is_trivially_copyable<Tick>::value, "Tick must stay plain data");
+
+class TickConsumer
+{
+public:
+    virtual ~TickConsumer() = default;
+    virtual void onTick(const Tick& tick) = 0;
+    virtual void onFocusChanged(int reqId) { Q_UNUSED(reqId); } // Focus consumers, before the replay
+};
+
+/**
+ * @brief Direct tick path from IBKRWrapper to its consumers
+ *
+ * Replaces the wrapper -> client -> manager signal chain for tick-by-tick data.
+ * Every subscribed stream gets a latest-quote slot when it is opened (the only
+ * place that allocates); publishing a tick overwrites the slot's quote or trade
+ * and calls the consumers in place. Focus consumers (TradingManager) only receive the
+ * stream of the displayed ticker and are called first.
+ */
+class TickPipeline
+{
+public:
+    explicit TickPipeline(int expectedStreams = 16);
+
+    // Stream lifetime (tick-by-tick subscribe / cancel)
+    void openSlot(int reqId);
+    void closeSlot(int reqId); // Closing the slot's own reqId also drops its aliases
+
+    // Second stream of the same ticker (trades next to quotes): its ticks go into reqId's
+    // slot and reach consumers as reqId, in arrival order with reqId's own ticks
+    void openAlias(int aliasReqId, int reqId);
+    void reset(); // Connection lost - all streams are gone (consumers stay)
+
+    // Called from the wrapper; ticks of streams without a slot (already cancelled) are dropped
+    void publish(const Tick& tick);
+
+    // Latest quote / trade tick of a stream, nullptr if none yet (valid until slots change)
+    const Tick* latest(int reqId) const;
+    const Tick* latestTrade(int reqId) const;
+
+    void addConsumer(TickConsumer* consumer);
+    void addFocusConsumer(TickConsumer* consumer);
+    void removeConsumer(TickConsumer* consumer);
+
+    // Stream forwarded to focus consumers; its latest quote and trade are delivered right away
+    void setFocus(int reqId);
+    int focus() const { return m_focusReqId; }
+
+    quint64 publishedCount() const { return m_published; }
+    quint64 droppedCount() const { return m_dropped; }
+
+private:
+    struct QuoteSlot {
+        int reqId = -1; // Stream the slot was opened for (aliases publish as this one)
+        Tick quote;
+        Tick trade;
+        bool hasQuote = false;
+        bool hasTrade = false;
+    };
+
+    void deliver(const Tick& tick);
+
+    QVector<QuoteSlot> m_slots;
+    QVector<int> m_freeSlots;
+    QHash<int, int> m_slotByReqId; // reqId (or alias) -> index into m_slots
+    QVector<TickConsumer*> m_consumers;
+    QVector<TickConsumer*> m_focusConsumers;
+    int m_focusReqId;
+    quint64 m_published;
+    quint64 m_dropped;
+};
+
+#endif // TICKPIPELINE_H
@@ -0,0 +1,206 @@
+#include "diagnosticsdialog.h"
+#include "client/ibkrclient.h"
+#include "client/orderlatencytracker.h"
+#include "models/tickerdatamanager.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QGroupBox>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QFileDialog>
+#include <QFile>
+#include <QTextStream>
+#include <QMessageBox>
+#include <QStandardPaths>
+#include <QPointer>
+#include <QApplication>
+
+DiagnosticsDialog::DiagnosticsDialog(IBKRClient* client, TickerDataManager* dataManager, QWidget* parent)
+    : QDialog(parent)
+    , m_client(client)
+    , m_dataManager(dataManager)
+{
+    setupUI();
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(1000);
+    connect(m_refreshTimer, &QTimer::timeout, this, &DiagnosticsDialog::refresh);
+    m_refreshTimer->start();
+
+    refresh();
+}
+
+void DiagnosticsDialog::setupUI() {
+    setWindowTitle("Diagnostics");
+    resize(1000, 700);
+
+    auto* mainLayout = new QVBoxLayout(this);
+
+    // Per-stage order latency
+    auto* stageGroup = new QGroupBox("Order latency");
+    auto* stageLayout = new QVBoxLayout(stageGroup);
+    m_stageTable = new QTableWidget(OrderLatencyTracker::StageCount, 5, this);
+    m_stageTable->setHorizontalHeaderLabels({"Stage", "Count", "p50", "p99", "Max"});
+    m_stageTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_stageTable->setSelectionMode(QAbstractItemView::NoSelection);
+    m_stageTable->verticalHeader()->setVisible(false);
+    m_stageTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    for (int stage = 0; stage < OrderLatencyTracker::StageCount; ++stage) {
+        m_stageTable->setItem(stage, 0, new QTableWidgetItem(
+            OrderLatencyTracker::stageName(static_cast<OrderLatencyTracker::Stage>(stage))));
+        for (int col = 1; col < 5; ++col) {
+            auto* item = new QTableWidgetItem();
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            m_stageTable->setItem(stage, col, item);
+        }
+    }
+    stageLayout->addWidget(m_stageTable);
+    mainLayout->addWidget(stageGroup);
+
+    // Recent order requests (newest first)
+    auto* orderGroup = new QGroupBox(QString("Recent requests (last %1)").arg(OrderLatencyTracker::RING_SIZE));
+    auto* orderLayout = new QVBoxLayout(orderGroup);
+    m_orderTable = new QTableWidget(0, 9, this);
+    m_orderTable->setHorizontalHeaderLabels({"Time", "Order", "Request", "Key -> call", "Call -> write",
+                                             "Write -> ack", "Write -> 1st status", "Last status", "Write -> 1st exec"});
+    m_orderTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_orderTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_orderTable->setAlternatingRowColors(true);
+    m_orderTable->verticalHeader()->setVisible(false);
+    m_orderTable->horizontalHeader()->setStretchLastSection(true);
+    m_orderTable->setColumnWidth(0, 100);
+    orderLayout->addWidget(m_orderTable);
+    mainLayout->addWidget(orderGroup, 1);
+
+    // Engine thread: market data dispatch and historical request pacing
+    auto* engineGroup = new QGroupBox("Engine");
+    auto* engineLayout = new QVBoxLayout(engineGroup);
+    m_dispatchLabel = new QLabel(this);
+    m_dispatchLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    m_schedulerLabel = new QLabel(this);
+    m_schedulerLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    engineLayout->addWidget(m_dispatchLabel);
+    engineLayout->addWidget(m_schedulerLabel);
+    mainLayout->addWidget(engineGroup);
+
+    // Bottom buttons
+    auto* buttonLayout = new QHBoxLayout();
+    auto* exportButton = new QPushButton("Export CSV...");
+    connect(exportButton, &QPushButton::clicked, this, &DiagnosticsDialog::onExportCsv);
+    buttonLayout->addWidget(exportButton);
+
+    auto* resetButton = new QPushButton("Reset");
+    connect(resetButton, &QPushButton::clicked, this, &DiagnosticsDialog::onReset);
+    buttonLayout->addWidget(resetButton);
+
+    buttonLayout->addStretch();
+
+    auto* closeButton = new QPushButton("Close");
+    connect(closeButton, &QPushButton::clicked, this, &QDialog::accept);
+    buttonLayout->addWidget(closeButton);
+
+    mainLayout->addLayout(buttonLayout);
+}
+
+void DiagnosticsDialog::refresh() {
+    showOrderLatency();
+
+    // Dispatch histograms and scheduler state belong to the engine thread - copy them there.
+    // The reply goes through qApp so the guard is only checked on the GUI thread
+    QPointer<DiagnosticsDialog> guard(this);
+    QMetaObject::invokeMethod(m_client, [client = m_client, manager = m_dataManager, guard]() {
+        EngineDiagnostics diagnostics;
+        diagnostics.quoteLatency = client->quoteLatency();
+        diagnostics.eventLatency = client->eventLatency();
+        diagnostics.ticksPublished = client->tickPipeline().publishedCount();
+        diagnostics.droppedQuotes = client->droppedQuotes();
+        diagnostics.droppedTrades = client->droppedTrades();
+        diagnostics.scheduler = manager->historyScheduler()->metrics();
+
+        QMetaObject::invokeMethod(qApp, [guard, diagnostics]() {
+            if (guard) {
+                guard->showEngineDiagnostics(diagnostics);
+            }
+        });
+    });
+}
+
+void DiagnosticsDialog::showOrderLatency() {
+    OrderLatencyTracker& tracker = m_client->orderTracker();
+
+    for (int stage = 0; stage < OrderLatencyTracker::StageCount; ++stage) {
+        LatencyHistogram histogram = tracker.stage(static_cast<OrderLatencyTracker::Stage>(stage));
+        bool empty = histogram.count() == 0;
+        m_stageTable->item(stage, 1)->setText(QString::number(histogram.count()));
+        m_stageTable->item(stage, 2)->setText(empty ? "-" : LatencyHistogram::formatNs(histogram.percentileNs(50.0)));
+        m_stageTable->item(stage, 3)->setText(empty ? "-" : LatencyHistogram::formatNs(histogram.percentileNs(99.0)));
+        m_stageTable->item(stage, 4)->setText(empty ? "-" : LatencyHistogram::formatNs(histogram.maxNs()));
+    }
+
+    auto duration = [](qint64 fromNs, qint64 toNs) {
+        return (fromNs > 0 && toNs > 0) ? LatencyHistogram::formatNs(toNs - fromNs) : QString("-");
+    };
+
+    const QVector<OrderTimeline> timelines = tracker.timelines();
+    m_orderTable->setRowCount(timelines.size());
+    for (int i = 0; i < timelines.size(); ++i) {
+        const OrderTimeline& t = timelines[timelines.size() - 1 - i];
+        QStringList cells = {
+            t.wallTime.toString("HH:mm:ss.zzz"),
+            t.orderId >= 0 ? QString::number(t.orderId) : QString("all"),
+            OrderLatencyTracker::requestName(t.request),
+            duration(t.keypressNs, t.callNs),
+            duration(t.callNs, t.writeNs),
+            duration(t.writeNs, t.ackNs),
+            duration(t.writeNs, t.firstStatusNs),
+            t.statusCount > 0 ? QString("%1 (%2x)").arg(t.lastStatus).arg(t.statusCount) : QString("-"),
+            duration(t.writeNs, t.firstExecNs)
+        };
+        for (int col = 0; col < cells.size(); ++col) {
+            QTableWidgetItem* item = m_orderTable->item(i, col);
+            if (!item) {
+                item = new QTableWidgetItem();
+                m_orderTable->setItem(i, col, item);
+            }
+            item->setText(cells[col]);
+        }
+    }
+}
+
+void DiagnosticsDialog::showEngineDiagnostics(const EngineDiagnostics& diagnostics) {
+    m_dispatchLabel->setText(QString("Quote handoff: %1\nOrder event handoff: %2\nTicks published: %3, dropped quotes: %4, dropped trades: %5")
+        .arg(diagnostics.quoteLatency.summary())
+        .arg(diagnostics.eventLatency.summary())
+        .arg(diagnostics.ticksPublished)
+        .arg(diagnostics.droppedQuotes)
+        .arg(diagnostics.droppedTrades));
+
+    const HistoricalSchedulerMetrics& m = diagnostics.scheduler;
+    m_schedulerLabel->setText(QString("Historical requests: queued %1, in flight %2, sent %3 (%4 in last 10 min), "
+                                      "coalesced %5, cancelled %6, pacing violations %7, wait avg %8 ms / max %9 ms")
+        .arg(m.queueDepth).arg(m.inFlight).arg(m.sent).arg(m.sentLast10Min)
+        .arg(m.coalesced).arg(m.cancelled).arg(m.pacingViolations)
+        .arg(m.averageWaitMs, 0, 'f', 0).arg(m.maxWaitMs));
+}
+
+void DiagnosticsDialog::onExportCsv() {
+    QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation)
+        + "/order_latency.csv";
+    QString fileName = QFileDialog::getSaveFileName(this, "Export Order Latency", defaultPath, "CSV files (*.csv)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QMessageBox::warning(this, "Export Failed", QString("Cannot write %1: %2").arg(fileName, file.errorString()));
+        return;
+    }
+    QTextStream out(&file);
+    out << m_client->orderTracker().toCsv();
+}
+
+void DiagnosticsDialog::onReset() {
+    m_client->orderTracker().reset();
+    refresh();
+}
@@ -0,0 +1,56 @@
+#ifndef DIAGNOSTICSDIALOG_H
+#define DIAGNOSTICSDIALOG_H
+
+#include <QDialog>
+#include <QTableWidget>
+#include <QLabel>
+#include <QTimer>
+#include "client/historicalrequestscheduler.h"
+#include "utils/latencyhistogram.h"
+
+class IBKRClient;
+class TickerDataManager;
+
+// Engine-thread metrics, copied on the engine thread for one refresh
+struct EngineDiagnostics {
+    LatencyHistogram quoteLatency;
+    LatencyHistogram eventLatency;
+    quint64 ticksPublished = 0;
+    quint64 droppedQuotes = 0;
+    quint64 droppedTrades = 0;
+    HistoricalSchedulerMetrics scheduler;
+};
+
+/**
+ * @brief Live latency view: order lifecycle stages, recent orders, dispatch and history pacing
+ *
+ * Order timings come from IBKRClient::orderTracker() (thread-safe); the rest is
+ * collected on the engine thread once per second. Recent orders can be exported as CSV.
+ */
+class DiagnosticsDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    DiagnosticsDialog(IBKRClient* client, TickerDataManager* dataManager, QWidget* parent = nullptr);
+
+private slots:
+    void refresh();
+    void onExportCsv();
+    void onReset();
+
+private:
+    void setupUI();
+    void showEngineDiagnostics(const EngineDiagnostics& diagnostics);
+    void showOrderLatency();
+
+    IBKRClient* m_client;
+    TickerDataManager* m_dataManager;
+    QTimer* m_refreshTimer;
+
+    QTableWidget* m_stageTable;
+    QTableWidget* m_orderTable;
+    QLabel* m_dispatchLabel;
+    QLabel* m_schedulerLabel;
+};
+
+#endif // DIAGNOSTICSDIALOG_H
@@ -28,6 +28,9 @@ void SettingsDialog::setupUI()
     m_budgetEdit = new QLineEdit();
     tradingLayout->addRow("Budget $:", m_budgetEdit);
 
+    m_capToDisplayedSizeCheck = new QCheckBox("Cap buys to the size displayed at the ask");
+    tradingLayout->addRow(m_capToDisplayedSizeCheck);
+
     m_tabWidget->addTab(tradingTab, "Trading");
 
     // Limits tab
@@ -164,6 +167,35 @@ void SettingsDialog::setupUI()
     m_clientIdSpin->setRange(0, 999);  // 0 is required for binding manual TWS orders
     twsLayout->addRow("Client ID:", m_clientIdSpin);
 
+    m_streamingTickersSpin = new QSpinBox();
+    m_streamingTickersSpin->setRange(1, 50);  // Limited by TWS market data lines (min 3 tick-by-tick)
+    m_streamingTickersSpin->setToolTip("Number of recently used tickers kept streaming in the background");
+    twsLayout->addRow("Streaming tickers:", m_streamingTickersSpin);
+
+    m_tickByTickTradesCombo = new QComboBox();
+    m_tickByTickTradesCombo->addItem("Quotes only", QString());
+    m_tickByTickTradesCombo->addItem("Quotes + trades (Last)", QString("Last"));
+    m_tickByTickTradesCombo->addItem("Quotes + trades (AllLast)", QString("AllLast"));
+    m_tickByTickTradesCombo->setToolTip("Trade prints give the real last price and traded volume; each costs a tick-by-tick subscription");
+    twsLayout->addRow("Tick-by-tick:", m_tickByTickTradesCombo);
+
+    m_tickByTickLimitSpin = new QSpinBox();
+    m_tickByTickLimitSpin->setRange(1, 100);
+    m_tickByTickLimitSpin->setToolTip("Simultaneous tick-by-tick subscriptions TWS allows (at least 3). The current ticker's trades come first, then recently used tickers");
+    twsLayout->addRow("Tick-by-tick limit:", m_tickByTickLimitSpin);
+
+    m_barRetentionSpin = new QSpinBox();
+    m_barRetentionSpin->setRange(1, 168);
+    m_barRetentionSpin->setSuffix(" h");
+    m_barRetentionSpin->setToolTip("Hours of candles kept in memory per ticker and timeframe");
+    twsLayout->addRow("Bar history:", m_barRetentionSpin);
+
+    m_chartMaxFpsSpin = new QSpinBox();
+    m_chartMaxFpsSpin->setRange(1, 60);
+    m_chartMaxFpsSpin->setSuffix(" fps");
+    m_chartMaxFpsSpin->setToolTip("Chart redraws per second at most; ticks in between are drawn together");
+    twsLayout->addRow("Chart refresh:", m_chartMaxFpsSpin);
+
     connectionMainLayout->addWidget(twsWidget);
     connectionMainLayout->addSpacing(20);
 
@@ -199,6 +231,7 @@ void SettingsDialog::loadSettings()
     Settings& settings = Settings::instance();
 
     m_budgetEdit->setText(QString::number(settings.budget()));
+    m_capToDisplayedSizeCheck->setChecked(settings.capToDisplayedSize());
     m_askOffsetSpin->setValue(settings.askOffset());
     m_bidOffsetSpin->setValue(settings.bidOffset());
 
@@ -223,6 +256,11 @@ void SettingsDialog::loadSettings()
     m_hostEdit->setText(settings.host());
     m_portSpin->setValue(settings.port());
     m_clientIdSpin->setValue(settings.clientId());
+    m_streamingTickersSpin->setValue(settings.maxStreamingTickers());
+    m_tickByTickTradesCombo->setCurrentIndex(qMax(0, m_tickByTickTradesCombo->findData(settings.tickByTickTrades())));
+    m_tickByTickLimitSpin->setValue(settings.tickByTickLimit());
+    m_barRetentionSpin->setValue(settings.barRetentionHours());
+    m_chartMaxFpsSpin->setValue(settings.chartMaxFps());
     m_remoteControlPortSpin->setValue(settings.remoteControlPort());
 }
 
@@ -231,6 +269,7 @@ void SettingsDialog::saveSettings()
     Settings& settings = Settings::instance();
 
     settings.setBudget(m_budgetEdit->text().toDouble());
+    settings.setCapToDisplayedSize(m_capToDisplayedSizeCheck->isChecked());
     settings.setAskOffset(m_askOffsetSpin->value());
     settings.setBidOffset(m_bidOffsetSpin->value());
 
@@ -240,6 +279,11 @@ void SettingsDialog::saveSettings()
     settings.setHost(m_hostEdit->text());
     settings.setPort(m_portSpin->value());
     settings.setClientId(m_clientIdSpin->value());
+    settings.setMaxStreamingTickers(m_streamingTickersSpin->value());
+    settings.setTickByTickTrades(m_tickByTickTradesCombo->currentData().toString());
+    settings.setTickByTickLimit(m_tickByTickLimitSpin->value());
+    settings.setBarRetentionHours(m_barRetentionSpin->value());
+    settings.setChartMaxFps(m_chartMaxFpsSpin->value());
     settings.setRemoteControlPort(m_remoteControlPortSpin->value());
 
     settings.save();
@@ -5,6 +5,8 @@
 #include <QTabWidget>
 #include <QLineEdit>
 #include <QSpinBox>
+#include <QCheckBox>
+#include <QComboBox>
 
 class SettingsDialog : public QDialog
 {
@@ -25,6 +27,7 @@ private:
 
     // Trading tab
     QLineEdit *m_budgetEdit;
+    QCheckBox *m_capToDisplayedSizeCheck;
 
     // Limits tab
     QSpinBox *m_askOffsetSpin;
@@ -52,6 +55,11 @@ private:
     QLineEdit *m_hostEdit;
     QSpinBox *m_portSpin;
     QSpinBox *m_clientIdSpin;
+    QSpinBox *m_streamingTickersSpin;
+    QComboBox *m_tickByTickTradesCombo;
+    QSpinBox *m_tickByTickLimitSpin;
+    QSpinBox *m_barRetentionSpin;
+    QSpinBox *m_chartMaxFpsSpin;
 
     // Remote Control tab
     QSpinBox *m_remoteControlPortSpin;
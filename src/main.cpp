@@ -1,4 +1,5 @@
 #include <QApplication>
+#include <QCommandLineParser>
 #include "ui/mainwindow.h"
 
 int main(int argc, char *argv[])
@@ -10,7 +11,38 @@ int main(int argc, char *argv[])
     app.setOrganizationName("Kinect.PRO");
     app.setOrganizationDomain("kinect-pro.com");
 
-    MainWindow window;
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Hotkey trading for Interactive Brokers TWS");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption recordOption("record", "Record TWS callbacks (ticks, bars, order events) to a journal file.", "file");
+    QCommandLineOption replayOption("replay", "Replay a recorded journal instead of connecting to TWS.", "file");
+    QCommandLineOption speedOption("replay-speed", "Replay speed: 1 (recorded pace), N (N times faster) or max.", "speed", "1");
+    parser.addOption(recordOption);
+    parser.addOption(replayOption);
+    parser.addOption(speedOption);
+    parser.process(app);
+
+    LaunchOptions options;
+    options.recordJournal = parser.value(recordOption);
+    options.replayJournal = parser.value(replayOption);
+    if (!options.recordJournal.isEmpty() && !options.replayJournal.isEmpty()) {
+        qWarning("--record and --replay can't be combined");
+        return 1;
+    }
+    QString speed = parser.value(speedOption);
+    if (speed.compare("max", Qt::CaseInsensitive) == 0) {
+        options.replaySpeed = 0.0;
+    } else {
+        bool ok = false;
+        options.replaySpeed = speed.toDouble(&ok);
+        if (!ok || options.replaySpeed <= 0.0) {
+            qWarning("--replay-speed must be a positive number or max");
+            return 1;
+        }
+    }
+
+    MainWindow window(options);
     window.show();
 
     return app.exec();
@@ -0,0 +1,229 @@
+#include "models/barcache.h"
+#include "utils/logger.h"
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QRegularExpression>
+#include <cstring>
+
+namespace {
+
+const char FILE_MAGIC[4] = {'I', 'B', 'K', 'B'};
+const quint32 FILE_VERSION = 1;
+
+struct FileHeader {
+    char magic[4];
+    quint32 version;
+    quint32 recordSize;
+    quint32 reserved;
+};
+
+struct BarRecord {
+    qint64 timestamp;
+    double open;
+    double high;
+    double low;
+    double close;
+    qint64 volume;
+};
+
+static_assert(sizeof(FileHeader) == 16, "Bar cache header must be 16 bytes");
+static_assert(sizeof(BarRecord) == 48, "Bar cache record must be 48 bytes");
+
+FileHeader makeHeader()
+{
+    FileHeader header;
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = FILE_VERSION;
+    header.recordSize = sizeof(BarRecord);
+    header.reserved = 0;
+    return header;
+}
+
+bool isValidHeader(const uchar* data)
+{
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    return std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0
+        && header.version == FILE_VERSION
+        && header.recordSize == sizeof(BarRecord);
+}
+
+BarRecord toRecord(const CandleBar& bar)
+{
+    return BarRecord{bar.timestamp, bar.open, bar.high, bar.low, bar.close, bar.volume};
+}
+
+// Number of whole records in a file of given size (ignores a torn trailing record)
+qint64 recordCount(qint64 fileSize)
+{
+    if (fileSize < static_cast<qint64>(sizeof(FileHeader))) return 0;
+    return (fileSize - static_cast<qint64>(sizeof(FileHeader))) / static_cast<qint64>(sizeof(BarRecord));
+}
+
+} // namespace
+
+BarCache::BarCache(const QString& rootPath)
+    : m_rootPath(rootPath)
+{
+    if (m_rootPath.isEmpty()) {
+        QString dataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+        m_rootPath = QDir(dataPath).filePath("bars");
+    }
+}
+
+QString BarCache::tickerDir(const QString& tickerKey) const
+{
+    // Keep ticker keys (SYMBOL@EXCHANGE) readable but filesystem-safe
+    static const QRegularExpression unsafeChars("[^A-Za-z0-9@._-]");
+    QString safeKey = tickerKey;
+    safeKey.replace(unsafeChars, "_");
+    return QDir(m_rootPath).filePath(safeKey);
+}
+
+QString BarCache::filePath(const QString& tickerKey, int barSeconds) const
+{
+    return QDir(tickerDir(tickerKey)).filePath(QString("%1s.bin").arg(barSeconds));
+}
+
+QVector<CandleBar> BarCache::load(const QString& tickerKey, int barSeconds, int maxBars) const
+{
+    QVector<CandleBar> bars;
+    QString path = filePath(tickerKey, barSeconds);
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return bars;
+
+    qint64 count = recordCount(file.size());
+    if (count == 0) return bars;
+
+    uchar* data = file.map(0, file.size());
+    if (!data) {
+        LOG_WARNING(QString("Bar cache: failed to map %1: %2").arg(path).arg(file.errorString()));
+        return bars;
+    }
+
+    if (!isValidHeader(data)) {
+        LOG_WARNING(QString("Bar cache: ignoring %1 (unknown format)").arg(path));
+        file.unmap(data);
+        return bars;
+    }
+
+    // Only decode the newest records that fit in memory retention
+    qint64 first = qMax<qint64>(0, count - maxBars);
+    bars.reserve(static_cast<int>(count - first));
+    const uchar* records = data + sizeof(FileHeader);
+    for (qint64 i = first; i < count; ++i) {
+        BarRecord record;
+        std::memcpy(&record, records + i * sizeof(BarRecord), sizeof(record));
+        bars.append(CandleBar(record.timestamp, record.open, record.high, record.low, record.close, record.volume));
+    }
+    file.unmap(data);
+
+    m_lastTimestamps[path] = bars.last().timestamp;
+    return bars;
+}
+
+bool BarCache::append(const QString& tickerKey, int barSeconds, const CandleBar& bar)
+{
+    QString path = filePath(tickerKey, barSeconds);
+    if (bar.timestamp <= lastTimestamp(tickerKey, barSeconds)) return false;
+
+    QDir().mkpath(tickerDir(tickerKey));
+    QFile file(path);
+    if (!file.open(QIODevice::ReadWrite)) {
+        LOG_WARNING(QString("Bar cache: failed to open %1: %2").arg(path).arg(file.errorString()));
+        return false;
+    }
+
+    QByteArray existingHeader = file.read(sizeof(FileHeader));
+    bool hasValidHeader = existingHeader.size() == static_cast<int>(sizeof(FileHeader))
+        && isValidHeader(reinterpret_cast<const uchar*>(existingHeader.constData()));
+
+    if (!hasValidHeader) {
+        // New (or unreadable) file - start over
+        FileHeader header = makeHeader();
+        file.resize(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    } else {
+        // Drop a torn record left by an interrupted write
+        qint64 validSize = sizeof(FileHeader) + recordCount(file.size()) * sizeof(BarRecord);
+        if (validSize != file.size()) {
+            file.resize(validSize);
+        }
+    }
+
+    BarRecord record = toRecord(bar);
+    file.seek(file.size());
+    if (file.write(reinterpret_cast<const char*>(&record), sizeof(record)) != sizeof(record)) {
+        LOG_WARNING(QString("Bar cache: failed to append to %1: %2").arg(path).arg(file.errorString()));
+        return false;
+    }
+
+    m_lastTimestamps[path] = bar.timestamp;
+    return true;
+}
+
+bool BarCache::rewrite(const QString& tickerKey, int barSeconds, const CandleView& bars, qint64 completeBefore)
+{
+    QString path = filePath(tickerKey, barSeconds);
+    QDir().mkpath(tickerDir(tickerKey));
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_WARNING(QString("Bar cache: failed to write %1: %2").arg(path).arg(file.errorString()));
+        return false;
+    }
+
+    FileHeader header = makeHeader();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Build records in one buffer so the whole file goes out in a single write
+    QByteArray buffer;
+    buffer.reserve(bars.size() * static_cast<int>(sizeof(BarRecord)));
+    qint64 lastWritten = 0;
+    for (int i = 0; i < bars.size(); ++i) {
+        if (bars.timestamp(i) + barSeconds > completeBefore) break;
+        BarRecord record = toRecord(bars.at(i));
+        buffer.append(reinterpret_cast<const char*>(&record), sizeof(record));
+        lastWritten = record.timestamp;
+    }
+    file.write(buffer);
+
+    if (!file.commit()) {
+        LOG_WARNING(QString("Bar cache: failed to commit %1: %2").arg(path).arg(file.errorString()));
+        return false;
+    }
+
+    m_lastTimestamps[path] = lastWritten;
+    return true;
+}
+
+qint64 BarCache::lastTimestamp(const QString& tickerKey, int barSeconds) const
+{
+    QString path = filePath(tickerKey, barSeconds);
+    auto it = m_lastTimestamps.constFind(path);
+    if (it != m_lastTimestamps.constEnd()) {
+        return it.value();
+    }
+
+    qint64 last = readLastTimestamp(path);
+    m_lastTimestamps[path] = last;
+    return last;
+}
+
+qint64 BarCache::readLastTimestamp(const QString& path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return 0;
+
+    qint64 count = recordCount(file.size());
+    if (count == 0) return 0;
+
+    BarRecord record;
+    file.seek(sizeof(FileHeader) + (count - 1) * sizeof(BarRecord));
+    if (file.read(reinterpret_cast<char*>(&record), sizeof(record)) != sizeof(record)) return 0;
+    return record.timestamp;
+}
+
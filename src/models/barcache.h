@@ -0,0 +1,42 @@
+#ifndef BARCACHE_H
+#define BARCACHE_H
+
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include "models/candleseries.h"
+
+/**
+ * @brief Append-only on-disk candle store (one file per ticker and bar size)
+ *
+ * Files live in <AppData>/bars/<tickerKey>/<barSeconds>s.bin: a 16-byte header
+ * followed by fixed-width 48-byte records sorted by timestamp (native byte
+ * order). Completed live bars are appended; after merging history the file is
+ * rewritten from memory. Reads memory-map the file and only decode the tail.
+ */
+class BarCache
+{
+public:
+    explicit BarCache(const QString& rootPath = QString()); // Empty = <AppData>/bars
+
+    // Newest maxBars records (sorted), empty if no file
+    QVector<CandleBar> load(const QString& tickerKey, int barSeconds, int maxBars) const;
+
+    // Appends bar if it is newer than the last persisted one
+    bool append(const QString& tickerKey, int barSeconds, const CandleBar& bar);
+
+    // Replaces file contents with bars that closed before completeBefore (in-progress bar is skipped)
+    bool rewrite(const QString& tickerKey, int barSeconds, const CandleView& bars, qint64 completeBefore);
+
+    qint64 lastTimestamp(const QString& tickerKey, int barSeconds) const; // 0 if nothing persisted
+
+private:
+    QString tickerDir(const QString& tickerKey) const;
+    QString filePath(const QString& tickerKey, int barSeconds) const;
+    qint64 readLastTimestamp(const QString& path) const;
+
+    QString m_rootPath;
+    mutable QHash<QString, qint64> m_lastTimestamps; // file path -> last persisted timestamp
+};
+
+#endif // BARCACHE_H
@@ -0,0 +1,100 @@
+#include "models/barindicators.h"
+#include <cmath>
+#include <limits>
+
+static const qint64 EASTERN_OFFSET_SECS = -5 * 3600;
+static const double FAST_ALPHA = 2.0 / (BarIndicators::FAST_EMA_PERIOD + 1);
+static const double SLOW_ALPHA = 2.0 / (BarIndicators::SLOW_EMA_PERIOD + 1);
+
+BarIndicators::BarIndicators()
+    : m_first(0)
+{
+}
+
+qint64 BarIndicators::sessionDay(qint64 timestamp)
+{
+    qint64 local = timestamp + EASTERN_OFFSET_SECS;
+    return local >= 0 ? local / 86400 : (local - 86399) / 86400;
+}
+
+void BarIndicators::clear()
+{
+    m_beforeLast = State();
+    m_state = State();
+    m_points.clear();
+    m_first = 0;
+}
+
+IndicatorPoint BarIndicators::apply(State& state, const CandleBar& bar)
+{
+    qint64 day = sessionDay(bar.timestamp);
+    if (state.bars == 0 || day != state.day) {
+        // New session: VWAP and high/low start over
+        state.day = day;
+        state.priceVolume = 0.0;
+        state.volume = 0.0;
+        state.high = bar.high;
+        state.low = bar.low;
+    } else {
+        state.high = qMax(state.high, bar.high);
+        state.low = qMin(state.low, bar.low);
+    }
+
+    double typicalPrice = (bar.high + bar.low + bar.close) / 3.0;
+    state.priceVolume += typicalPrice * bar.volume;
+    state.volume += bar.volume;
+
+    if (state.bars == 0) {
+        state.emaFast = bar.close;
+        state.emaSlow = bar.close;
+    } else {
+        state.emaFast += FAST_ALPHA * (bar.close - state.emaFast);
+        state.emaSlow += SLOW_ALPHA * (bar.close - state.emaSlow);
+    }
+    state.bars++;
+
+    IndicatorPoint point;
+    point.timestamp = bar.timestamp;
+    point.vwap = state.volume > 0.0 ? state.priceVolume / state.volume : std::numeric_limits<double>::quiet_NaN();
+    point.emaFast = state.emaFast;
+    point.emaSlow = state.emaSlow;
+    point.sessionHigh = state.high;
+    point.sessionLow = state.low;
+    return point;
+}
+
+bool BarIndicators::update(const CandleBar& bar)
+{
+    if (!isEmpty() && bar.timestamp == lastTimestamp()) {
+        // Newest bar revised: recompute it from the state before it
+        m_state = m_beforeLast;
+        m_points.last() = apply(m_state, bar);
+        return true;
+    }
+    if (!isEmpty() && bar.timestamp < lastTimestamp()) {
+        return false;
+    }
+
+    m_beforeLast = m_state;
+    m_points.append(apply(m_state, bar));
+    return true;
+}
+
+IndicatorPoint BarIndicators::preview(const CandleBar& bar) const
+{
+    State state = (!isEmpty() && bar.timestamp == lastTimestamp()) ? m_beforeLast : m_state;
+    return apply(state, bar);
+}
+
+void BarIndicators::removeBefore(qint64 timestamp)
+{
+    while (m_first < m_points.size() && m_points[m_first].timestamp < timestamp) {
+        m_first++;
+    }
+
+    // Compact once the dropped part outweighs the rest (amortized O(1) per point)
+    if (m_first > 64 && m_first >= m_points.size() / 2) {
+        m_points.remove(0, m_first);
+        m_first = 0;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef BARINDICATORS_H
+#define BARINDICATORS_H
+
+#include <QtGlobal>
+#include <QVector>
+#include "models/candleseries.h"
+
+// Indicator values at one bar (vwap is NaN until the session has traded volume)
+struct IndicatorPoint {
+    qint64 timestamp = 0;
+    double vwap = 0.0;
+    double emaFast = 0.0;
+    double emaSlow = 0.0;
+    double sessionHigh = 0.0;
+    double sessionLow = 0.0;
+};
+
+/**
+ * @brief Streaming VWAP, EMA(9/20) and session high/low over the bars of one series
+ *
+ * update() takes bars in timestamp order, O(1) each: a bar with the newest
+ * timestamp revises it (live candle), a newer one is appended. The state before
+ * the newest bar is kept for that, and preview() computes the values of a bar
+ * not stored yet from it. VWAP and session high/low restart with each US
+ * Eastern day (fixed UTC-5, like the chart's session shading); the EMAs run on
+ * over days and are seeded with the first close.
+ */
+class BarIndicators
+{
+public:
+    static const int FAST_EMA_PERIOD = 9;
+    static const int SLOW_EMA_PERIOD = 20;
+
+    BarIndicators();
+
+    void clear();
+    bool update(const CandleBar& bar); // False (ignored) for bars older than the newest
+    IndicatorPoint preview(const CandleBar& bar) const; // As if bar were the newest, nothing stored
+    void removeBefore(qint64 timestamp); // Follows the series' ring buffer
+
+    bool isEmpty() const { return size() == 0; }
+    int size() const { return m_points.size() - m_first; }
+    const IndicatorPoint& at(int index) const { return m_points[m_first + index]; }
+    const IndicatorPoint& last() const { return m_points.last(); }
+    qint64 lastTimestamp() const { return isEmpty() ? 0 : last().timestamp; }
+
+    static qint64 sessionDay(qint64 timestamp); // US Eastern day of a bar
+
+private:
+    struct State {
+        int bars = 0;
+        qint64 day = 0;
+        double priceVolume = 0.0; // Sum of typical price * volume this session
+        double volume = 0.0;
+        double emaFast = 0.0;
+        double emaSlow = 0.0;
+        double high = 0.0;
+        double low = 0.0;
+    };
+    static IndicatorPoint apply(State& state, const CandleBar& bar);
+
+    State m_beforeLast; // Through the bar before the newest
+    State m_state;      // Including the newest
+    QVector<IndicatorPoint> m_points;
+    int m_first; // Points before it were removed (compacted in bulk)
+};
+
+#endif // BARINDICATORS_H
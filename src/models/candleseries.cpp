@@ -0,0 +1,197 @@
+#include "models/candleseries.h"
+
+int CandleView::lowerBound(qint64 timestamp) const
+{
+    int lo = 0;
+    int hi = m_size;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (this->timestamp(mid) < timestamp) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+CandleView CandleView::mid(int offset, int count) const
+{
+    offset = qBound(0, offset, m_size);
+    int available = m_size - offset;
+    if (count < 0 || count > available) {
+        count = available;
+    }
+    return CandleView(m_series, m_offset + offset, count);
+}
+
+CandleSeries::CandleSeries(int capacity)
+    : m_capacity(qMax(1, capacity))
+    , m_head(0)
+    , m_size(0)
+    , m_revision(0)
+{
+}
+
+void CandleSeries::setCapacity(int capacity)
+{
+    capacity = qMax(1, capacity);
+    if (capacity == m_capacity) return;
+
+    // Re-layout linearly (head at 0), keeping the newest bars
+    int keep = qMin(m_size, capacity);
+    int first = m_size - keep;
+
+    CandleSeries resized(capacity);
+    for (int i = first; i < m_size; ++i) {
+        resized.append(at(i));
+    }
+    resized.m_revision = m_revision + 1;
+    *this = std::move(resized);
+}
+
+CandleBar CandleSeries::at(int index) const
+{
+    int p = physicalIndex(index);
+    return CandleBar(m_timestamps[p], m_open[p], m_high[p], m_low[p], m_close[p], m_volume[p]);
+}
+
+int CandleSeries::lowerBound(qint64 timestamp) const
+{
+    return view().lowerBound(timestamp);
+}
+
+void CandleSeries::write(int physical, const CandleBar& bar)
+{
+    m_timestamps[physical] = bar.timestamp;
+    m_open[physical] = bar.open;
+    m_high[physical] = bar.high;
+    m_low[physical] = bar.low;
+    m_close[physical] = bar.close;
+    m_volume[physical] = bar.volume;
+}
+
+void CandleSeries::copy(int fromIndex, int toIndex)
+{
+    int from = physicalIndex(fromIndex);
+    int to = physicalIndex(toIndex);
+    m_timestamps[to] = m_timestamps[from];
+    m_open[to] = m_open[from];
+    m_high[to] = m_high[from];
+    m_low[to] = m_low[from];
+    m_close[to] = m_close[from];
+    m_volume[to] = m_volume[from];
+}
+
+void CandleSeries::append(const CandleBar& bar)
+{
+    if (m_size == m_capacity) {
+        // Full - overwrite oldest slot and advance head
+        write(m_head, bar);
+        m_head = (m_head + 1 == m_capacity) ? 0 : m_head + 1;
+        return;
+    }
+
+    int p = physicalIndex(m_size);
+    if (p == m_timestamps.size()) {
+        // Columns still growing towards capacity
+        m_timestamps.append(bar.timestamp);
+        m_open.append(bar.open);
+        m_high.append(bar.high);
+        m_low.append(bar.low);
+        m_close.append(bar.close);
+        m_volume.append(bar.volume);
+    } else {
+        write(p, bar);
+    }
+    ++m_size;
+}
+
+void CandleSeries::merge(const CandleBar& bar, bool replaceExisting)
+{
+    // Fast path: bars arrive in timestamp order
+    if (m_size == 0 || timestamp(m_size - 1) < bar.timestamp) {
+        append(bar);
+        return;
+    }
+
+    int index = lowerBound(bar.timestamp);
+    if (index < m_size && timestamp(index) == bar.timestamp) {
+        if (replaceExisting) {
+            write(physicalIndex(index), bar);
+            if (index != m_size - 1) {
+                ++m_revision;
+            }
+        }
+        return;
+    }
+
+    if (m_size == m_capacity) {
+        // Older than everything retained - nothing to keep
+        if (index == 0) return;
+
+        // Drop oldest bar to make room
+        m_head = (m_head + 1 == m_capacity) ? 0 : m_head + 1;
+        --m_size;
+        --index;
+    }
+
+    // Grow by one (duplicating last bar), then shift [index, size - 1) right
+    append(at(m_size - 1));
+    for (int i = m_size - 2; i > index; --i) {
+        copy(i - 1, i);
+    }
+    write(physicalIndex(index), bar);
+    ++m_revision;
+}
+
+void CandleSeries::merge(const QVector<CandleBar>& bars, bool replaceExisting)
+{
+    if (bars.isEmpty()) return;
+
+    // Fast path: incoming bars are all newer
+    if (m_size == 0 || timestamp(m_size - 1) < bars.first().timestamp) {
+        for (const CandleBar& bar : bars) {
+            append(bar);
+        }
+        return;
+    }
+
+    // Linear merge of two sorted series, then rebuild (ring keeps the newest bars)
+    QVector<CandleBar> merged;
+    merged.reserve(m_size + bars.size());
+    int i = 0;
+    int j = 0;
+    while (i < m_size && j < bars.size()) {
+        qint64 ts = timestamp(i);
+        if (ts < bars[j].timestamp) {
+            merged.append(at(i++));
+        } else if (bars[j].timestamp < ts) {
+            merged.append(bars[j++]);
+        } else {
+            merged.append(replaceExisting ? bars[j] : at(i));
+            ++i;
+            ++j;
+        }
+    }
+    while (i < m_size) merged.append(at(i++));
+    while (j < bars.size()) merged.append(bars[j++]);
+
+    clear();
+    for (int k = qMax(0, static_cast<int>(merged.size()) - m_capacity); k < merged.size(); ++k) {
+        append(merged[k]);
+    }
+}
+
+void CandleSeries::clear()
+{
+    m_timestamps.clear();
+    m_open.clear();
+    m_high.clear();
+    m_low.clear();
+    m_close.clear();
+    m_volume.clear();
+    m_head = 0;
+    m_size = 0;
+    ++m_revision;
+}
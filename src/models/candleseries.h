@@ -0,0 +1,144 @@
+#ifndef CANDLESERIES_H
+#define CANDLESERIES_H
+
+#include <QtGlobal>
+#include <QVector>
+
+struct CandleBar {
+    qint64 timestamp;
+    double open, high, low, close;
+    qint64 volume;
+    CandleBar() : timestamp(0), open(0), high(0), low(0), close(0), volume(0) {}
+    CandleBar(qint64 ts, double o, double h, double l, double c, qint64 v) : timestamp(ts), open(o), high(h), low(l), close(c), volume(v) {}
+};
+
+class CandleSeries;
+
+/**
+ * @brief Read-only, non-owning view over a range of a CandleSeries
+ *
+ * Indexes straight into the series columns (no copy). Like a QVector iterator,
+ * it is only valid until the series is modified.
+ */
+class CandleView
+{
+public:
+    class const_iterator
+    {
+    public:
+        const_iterator(const CandleView* view, int index) : m_view(view), m_index(index) {}
+        CandleBar operator*() const { return m_view->at(m_index); }
+        const_iterator& operator++() { ++m_index; return *this; }
+        bool operator==(const const_iterator& other) const { return m_index == other.m_index; }
+        bool operator!=(const const_iterator& other) const { return m_index != other.m_index; }
+
+    private:
+        const CandleView* m_view;
+        int m_index;
+    };
+
+    CandleView() : m_series(nullptr), m_offset(0), m_size(0) {}
+    CandleView(const CandleSeries* series, int offset, int size) : m_series(series), m_offset(offset), m_size(size) {}
+
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+
+    inline CandleBar at(int index) const;
+    CandleBar operator[](int index) const { return at(index); }
+    CandleBar first() const { return at(0); }
+    CandleBar last() const { return at(m_size - 1); }
+
+    // Column accessors (cheaper than at() when only one field is needed)
+    inline qint64 timestamp(int index) const;
+    inline double open(int index) const;
+    inline double high(int index) const;
+    inline double low(int index) const;
+    inline double close(int index) const;
+    inline qint64 volume(int index) const;
+
+    int lowerBound(qint64 timestamp) const; // First index with bar timestamp >= given timestamp
+    CandleView mid(int offset, int count = -1) const;
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_size); }
+
+private:
+    const CandleSeries* m_series;
+    int m_offset;
+    int m_size;
+};
+
+/**
+ * @brief Candle storage with one array per field and a fixed-capacity ring buffer
+ *
+ * Bars are kept sorted by timestamp (index 0 = oldest). Once the capacity is
+ * reached, appending a newer bar drops the oldest one, so memory per series is
+ * bounded. Columns grow lazily up to the capacity.
+ */
+class CandleSeries
+{
+public:
+    static constexpr int DEFAULT_CAPACITY = 500; // Size of one historical data request
+
+    explicit CandleSeries(int capacity = DEFAULT_CAPACITY);
+
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+    int capacity() const { return m_capacity; }
+    void setCapacity(int capacity); // Keeps the newest bars if shrinking
+
+    CandleBar at(int index) const;
+    CandleBar first() const { return at(0); }
+    CandleBar last() const { return at(m_size - 1); }
+
+    qint64 timestamp(int index) const { return m_timestamps[physicalIndex(index)]; }
+    double open(int index) const { return m_open[physicalIndex(index)]; }
+    double high(int index) const { return m_high[physicalIndex(index)]; }
+    double low(int index) const { return m_low[physicalIndex(index)]; }
+    double close(int index) const { return m_close[physicalIndex(index)]; }
+    qint64 volume(int index) const { return m_volume[physicalIndex(index)]; }
+
+    int lowerBound(qint64 timestamp) const; // First index with bar timestamp >= given timestamp
+    CandleView view() const { return CandleView(this, 0, m_size); }
+
+    // Bumped by every change other than appending or rewriting the newest bar (and the
+    // ring dropping the oldest): readers holding a copy only need to patch the tail
+    // while it is unchanged
+    quint32 revision() const { return m_revision; }
+
+    void append(const CandleBar& bar); // Bar must be newer than last()
+    void merge(const CandleBar& bar, bool replaceExisting); // Sorted insert, any position
+    void merge(const QVector<CandleBar>& bars, bool replaceExisting); // bars must be sorted
+    void clear();
+
+private:
+    int physicalIndex(int index) const
+    {
+        int p = m_head + index;
+        return p < m_capacity ? p : p - m_capacity;
+    }
+    void write(int physical, const CandleBar& bar);
+    void copy(int fromIndex, int toIndex);
+
+    QVector<qint64> m_timestamps;
+    QVector<double> m_open;
+    QVector<double> m_high;
+    QVector<double> m_low;
+    QVector<double> m_close;
+    QVector<qint64> m_volume;
+
+    int m_capacity;
+    int m_head; // Physical index of the oldest bar
+    int m_size;
+    quint32 m_revision;
+};
+
+inline CandleBar CandleView::at(int index) const { return m_series->at(m_offset + index); }
+inline qint64 CandleView::timestamp(int index) const { return m_series->timestamp(m_offset + index); }
+inline double CandleView::open(int index) const { return m_series->open(m_offset + index); }
+inline double CandleView::high(int index) const { return m_series->high(m_offset + index); }
+inline double CandleView::low(int index) const { return m_series->low(m_offset + index); }
+inline double CandleView::close(int index) const { return m_series->close(m_offset + index); }
+inline qint64 CandleView::volume(int index) const { return m_series->volume(m_offset + index); }
+
+#endif // CANDLESERIES_H
@@ -0,0 +1,60 @@
+#include "models/quotetradestream.h"
+#include <cstring>
+
+void QuoteTradeStream::addQuote(const Tick& tick)
+{
+    m_hasQuote = true;
+    m_quoteTime = tick.time;
+    m_bid = tick.bid;
+    m_ask = tick.ask;
+    m_bidSize = tick.bidSize;
+    m_askSize = tick.askSize;
+}
+
+void QuoteTradeStream::addTrade(const Tick& tick)
+{
+    if (m_trades.isEmpty()) {
+        m_trades.resize(TRADE_CAPACITY);
+    }
+
+    TradePrint& print = m_trades[m_head];
+    print.time = tick.time;
+    print.price = tick.price;
+    print.size = tick.size;
+    memcpy(print.exchange, tick.exchange, sizeof(print.exchange));
+    memcpy(print.conditions, tick.conditions, sizeof(print.conditions));
+
+    m_head = (m_head + 1) % TRADE_CAPACITY;
+    if (m_tradeCount < TRADE_CAPACITY) {
+        m_tradeCount++;
+    }
+    m_volume += tick.size;
+}
+
+void QuoteTradeStream::reset()
+{
+    m_hasQuote = false;
+    m_quoteTime = 0;
+    m_bid = m_ask = 0.0;
+    m_bidSize = m_askSize = 0.0;
+    m_head = 0;
+    m_tradeCount = 0;
+    m_volume = 0.0;
+}
+
+const TradePrint& QuoteTradeStream::trade(int index) const
+{
+    int oldest = (m_head - m_tradeCount + TRADE_CAPACITY) % TRADE_CAPACITY;
+    return m_trades[(oldest + index) % TRADE_CAPACITY];
+}
+
+double QuoteTradeStream::volumeSince(qint64 time) const
+{
+    double volume = 0.0;
+    for (int i = m_tradeCount - 1; i >= 0; --i) {
+        const TradePrint& print = trade(i);
+        if (print.time < time) break;
+        volume += print.size;
+    }
+    return volume;
+}
@@ -0,0 +1,62 @@
+#ifndef QUOTETRADESTREAM_H
+#define QUOTETRADESTREAM_H
+
+#include <QtGlobal>
+#include <QVector>
+#include "client/tickpipeline.h"
+
+// One trade print as kept per ticker (exchange / conditions as in Tick)
+struct TradePrint {
+    qint64 time = 0; // TWS timestamp (seconds)
+    double price = 0.0;
+    double size = 0.0;
+    char exchange[8] = {};
+    char conditions[8] = {};
+};
+
+/**
+ * @brief Latest quote with sizes and the recent trade prints of one ticker
+ *
+ * Fed from the tick pipeline by TickerDataManager. Trades go into a fixed
+ * ring (allocated on the first trade, then overwritten in place); volume()
+ * counts every print since the stream was (re)subscribed.
+ */
+class QuoteTradeStream
+{
+public:
+    static const int TRADE_CAPACITY = 512; // Recent prints kept per ticker
+
+    void addQuote(const Tick& tick);
+    void addTrade(const Tick& tick);
+    void reset(); // Resubscribed - sizes and prints of the old subscription are stale
+
+    bool hasQuote() const { return m_hasQuote; }
+    qint64 quoteTime() const { return m_quoteTime; }
+    double bid() const { return m_bid; }
+    double ask() const { return m_ask; }
+    double bidSize() const { return m_bidSize; }
+    double askSize() const { return m_askSize; }
+
+    // Retained prints, 0 = oldest
+    int tradeCount() const { return m_tradeCount; }
+    const TradePrint& trade(int index) const;
+    const TradePrint* lastTrade() const { return m_tradeCount > 0 ? &trade(m_tradeCount - 1) : nullptr; }
+
+    double volume() const { return m_volume; }
+    double volumeSince(qint64 time) const; // Traded size of retained prints at or after time
+
+private:
+    bool m_hasQuote = false;
+    qint64 m_quoteTime = 0;
+    double m_bid = 0.0;
+    double m_ask = 0.0;
+    double m_bidSize = 0.0;
+    double m_askSize = 0.0;
+
+    QVector<TradePrint> m_trades; // Ring buffer, TRADE_CAPACITY once the first trade arrives
+    int m_head = 0;               // Next write position
+    int m_tradeCount = 0;
+    double m_volume = 0.0;
+};
+
+#endif // QUOTETRADESTREAM_H
@@ -92,22 +92,49 @@ void Settings::initDefaults()
     m_clientId = 0;  // Client ID 0 is required for binding manual orders
     m_remoteControlPort = 8496;
     m_displayGroupId = 0;  // 0 = disabled (No Group)
+    m_maxStreamingTickers = 3;  // TWS guarantees at least 3 simultaneous tick-by-tick subscriptions
+    m_tickByTickTrades = QString();  // Quotes only
+    m_tickByTickLimit = 3;
+    m_barRetentionHours = 16;  // Full extended session (4:00 - 20:00 ET)
+    m_chartMaxFps = 30;
     m_showCancelledOrders = false;  // Hidden by default
     m_orderType = "LMT";  // Default to limit orders
+    m_capToDisplayedSize = false;
+}
+
+double Settings::budget() const
+{
+    QMutexLocker locker(&m_tradingMutex);
+    return m_budget;
 }
 
 void Settings::setBudget(double budget)
 {
+    QMutexLocker locker(&m_tradingMutex);
     m_budget = budget;
 }
 
+int Settings::askOffset() const
+{
+    QMutexLocker locker(&m_tradingMutex);
+    return m_askOffset;
+}
+
 void Settings::setAskOffset(int offset)
 {
+    QMutexLocker locker(&m_tradingMutex);
     m_askOffset = offset;
 }
 
+int Settings::bidOffset() const
+{
+    QMutexLocker locker(&m_tradingMutex);
+    return m_bidOffset;
+}
+
 void Settings::setBidOffset(int offset)
 {
+    QMutexLocker locker(&m_tradingMutex);
     m_bidOffset = offset;
 }
 
@@ -146,16 +173,60 @@ void Settings::setDisplayGroupId(int groupId)
     m_displayGroupId = groupId;
 }
 
+void Settings::setMaxStreamingTickers(int count)
+{
+    m_maxStreamingTickers = count;
+}
+
+void Settings::setTickByTickTrades(const QString& tickType)
+{
+    m_tickByTickTrades = tickType;
+}
+
+void Settings::setTickByTickLimit(int count)
+{
+    m_tickByTickLimit = count;
+}
+
+void Settings::setBarRetentionHours(int hours)
+{
+    m_barRetentionHours = hours;
+}
+
+void Settings::setChartMaxFps(int fps)
+{
+    m_chartMaxFps = fps;
+}
+
 void Settings::setShowCancelledOrders(bool show)
 {
     m_showCancelledOrders = show;
 }
 
+QString Settings::orderType() const
+{
+    QMutexLocker locker(&m_tradingMutex);
+    return m_orderType;
+}
+
 void Settings::setOrderType(const QString& type)
 {
+    QMutexLocker locker(&m_tradingMutex);
     m_orderType = type;
 }
 
+bool Settings::capToDisplayedSize() const
+{
+    QMutexLocker locker(&m_tradingMutex);
+    return m_capToDisplayedSize;
+}
+
+void Settings::setCapToDisplayedSize(bool cap)
+{
+    QMutexLocker locker(&m_tradingMutex);
+    m_capToDisplayedSize = cap;
+}
+
 QString Settings::getValue(const QString& key, const QString& defaultValue) const
 {
     QSqlQuery query(m_db);
@@ -198,8 +269,15 @@ void Settings::load()
     m_clientId = getValue("client_id", "0").toInt();  // Default to 0 for manual order binding
     m_remoteControlPort = getValue("remote_control_port", "8496").toInt();
     m_displayGroupId = getValue("display_group_id", "0").toInt();
+    m_maxStreamingTickers = getValue("max_streaming_tickers", "3").toInt();
+    m_tickByTickTrades = getValue("tick_by_tick_trades", "");
+    // Existing pools keep their size when the limit is first introduced
+    m_tickByTickLimit = getValue("tick_by_tick_limit", QString::number(qMax(3, m_maxStreamingTickers))).toInt();
+    m_barRetentionHours = getValue("bar_retention_hours", "16").toInt();
+    m_chartMaxFps = getValue("chart_max_fps", "30").toInt();
     m_showCancelledOrders = getValue("show_cancelled_orders", "0").toInt() == 1;
     m_orderType = getValue("order_type", "LMT");
+    m_capToDisplayedSize = getValue("cap_to_displayed_size", "0").toInt() == 1;
 }
 
 void Settings::save()
@@ -219,6 +297,12 @@ void Settings::save()
     setValue("client_id", QString::number(m_clientId));
     setValue("remote_control_port", QString::number(m_remoteControlPort));
     setValue("display_group_id", QString::number(m_displayGroupId));
+    setValue("max_streaming_tickers", QString::number(m_maxStreamingTickers));
+    setValue("tick_by_tick_trades", m_tickByTickTrades);
+    setValue("tick_by_tick_limit", QString::number(m_tickByTickLimit));
+    setValue("bar_retention_hours", QString::number(m_barRetentionHours));
+    setValue("chart_max_fps", QString::number(m_chartMaxFps));
     setValue("show_cancelled_orders", m_showCancelledOrders ? "1" : "0");
     setValue("order_type", m_orderType);
+    setValue("cap_to_displayed_size", m_capToDisplayedSize ? "1" : "0");
 }
@@ -4,21 +4,22 @@
 #include <QString>
 #include <QSqlDatabase>
 #include <QMap>
+#include <QMutex>
 
 class Settings
 {
 public:
     static Settings& instance();
 
-    // Trading settings
-    double budget() const { return m_budget; }
+    // Trading settings (budget, offsets and order type are also read by the engine thread)
+    double budget() const;
     void setBudget(double budget);
 
     // Limits
-    int askOffset() const { return m_askOffset; }
+    int askOffset() const;
     void setAskOffset(int offset);
 
-    int bidOffset() const { return m_bidOffset; }
+    int bidOffset() const;
     void setBidOffset(int offset);
 
     // Hotkeys percentages
@@ -44,14 +45,39 @@ public:
     int displayGroupId() const { return m_displayGroupId; }
     void setDisplayGroupId(int groupId);
 
+    // Market data settings
+    // Number of tickers kept subscribed to tick-by-tick + real-time bars (LRU pool)
+    int maxStreamingTickers() const { return m_maxStreamingTickers; }
+    void setMaxStreamingTickers(int count);
+
+    // Trade prints streamed next to tick-by-tick quotes: "" (quotes only), "Last" or "AllLast"
+    QString tickByTickTrades() const { return m_tickByTickTrades; }
+    void setTickByTickTrades(const QString& tickType);
+
+    // Simultaneous tick-by-tick subscriptions TWS allows this account (quotes + trades)
+    int tickByTickLimit() const { return m_tickByTickLimit; }
+    void setTickByTickLimit(int count);
+
+    // Hours of candles kept in memory per ticker and timeframe
+    int barRetentionHours() const { return m_barRetentionHours; }
+    void setBarRetentionHours(int hours);
+
+    // Chart redraws per second at most, however fast ticks arrive
+    int chartMaxFps() const { return m_chartMaxFps; }
+    void setChartMaxFps(int fps);
+
     // View settings
     bool showCancelledOrders() const { return m_showCancelledOrders; }
     void setShowCancelledOrders(bool show);
 
     // Order type setting (LMT or MKT)
-    QString orderType() const { return m_orderType; }
+    QString orderType() const;
     void setOrderType(const QString& type);
 
+    // Hotkey buys never exceed the size displayed at the ask
+    bool capToDisplayedSize() const;
+    void setCapToDisplayedSize(bool cap);
+
     void load();
     void save();
 
@@ -62,6 +88,7 @@ private:
     Settings& operator=(const Settings&) = delete;
 
     QSqlDatabase m_db;
+    mutable QMutex m_tradingMutex; // Guards budget, offsets, order type and size cap
 
     double m_budget;
     int m_askOffset;
@@ -72,8 +99,14 @@ private:
     int m_clientId;
     int m_remoteControlPort;
     int m_displayGroupId;
+    int m_maxStreamingTickers;
+    QString m_tickByTickTrades;
+    int m_tickByTickLimit;
+    int m_barRetentionHours;
+    int m_chartMaxFps;
     bool m_showCancelledOrders;
     QString m_orderType;  // "LMT" or "MKT"
+    bool m_capToDisplayedSize;
 
     void initDatabase();
     void initDefaults();
@@ -24,7 +24,10 @@ int SymbolSearchManager::searchSymbolWithExchange(const QString& symbol, const Q
 
     m_pendingSearches[reqId] = request;
 
-    m_client->searchSymbol(reqId, symbol);
+    // Client runs on the engine thread
+    QMetaObject::invokeMethod(m_client, [client = m_client, reqId, symbol]() {
+        client->searchSymbol(reqId, symbol);
+    });
 
     return reqId;
 }
@@ -40,7 +43,10 @@ int SymbolSearchManager::searchSymbol(const QString& symbol)
 
     m_pendingSearches[reqId] = request;
 
-    m_client->searchSymbol(reqId, symbol);
+    // Client runs on the engine thread
+    QMetaObject::invokeMethod(m_client, [client = m_client, reqId, symbol]() {
+        client->searchSymbol(reqId, symbol);
+    });
 
     return reqId;
 }
@@ -91,9 +97,11 @@ void SymbolSearchManager::onSymbolSearchResultsReceived(int reqId,
     }
 
     if (found) {
-        // Store exchange and conId in TickerDataManager
-        m_tickerDataManager->setExpectedExchange(matchedSymbol, matchedExchange);
-        m_tickerDataManager->setContractId(matchedSymbol, matchedExchange, matchedConId);
+        // Store exchange and conId in TickerDataManager (queued ahead of the activation that follows)
+        QMetaObject::invokeMethod(m_tickerDataManager, [manager = m_tickerDataManager, matchedSymbol, matchedExchange, matchedConId]() {
+            manager->setExpectedExchange(matchedSymbol, matchedExchange);
+            manager->setContractId(matchedSymbol, matchedExchange, matchedConId);
+        });
 
         // Emit success
         emit symbolFound(request.callbackId, matchedSymbol, matchedExchange, matchedConId);
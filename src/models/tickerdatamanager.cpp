@@ -1,8 +1,12 @@
 #include "models/tickerdatamanager.h"
 #include "client/ibkrclient.h"
+#include "models/settings.h"
 #include "utils/logger.h"
 #include <QDateTime>
 #include <QTimeZone>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <algorithm>
 
 // Helper functions
 QString makeTickerKey(const QString& symbol, const QString& exchange) {
@@ -62,27 +66,62 @@ int timeframeToSeconds(Timeframe tf) {
     }
 }
 
+QVector<CandleBar> resampleBars(const CandleView& bars, int targetSeconds, qint64 fromTimestamp)
+{
+    QVector<CandleBar> result;
+    int first = bars.lowerBound(fromTimestamp);
+    if (first >= bars.size()) return result;
+
+    qint64 span = bars.timestamp(bars.size() - 1) - bars.timestamp(first);
+    result.reserve(static_cast<int>(span / targetSeconds) + 1);
+
+    for (int i = first; i < bars.size(); ++i) {
+        qint64 bucket = (bars.timestamp(i) / targetSeconds) * targetSeconds;
+        if (result.isEmpty() || result.last().timestamp != bucket) {
+            result.append(bars.at(i));
+            result.last().timestamp = bucket;
+        } else {
+            CandleBar& bar = result.last();
+            bar.high = qMax(bar.high, bars.high(i));
+            bar.low = qMin(bar.low, bars.low(i));
+            bar.close = bars.close(i);
+            bar.volume += bars.volume(i);
+        }
+    }
+    return result;
+}
+
 TickerDataManager::TickerDataManager(IBKRClient* client, QObject* parent)
     : QObject(parent)
     , m_client(client)
     , m_nextReqId(2000)
+    , m_barRetentionHours(qMax(1, Settings::instance().barRetentionHours()))
+    , m_simulatedTime(0)
+    , m_currentTicker(INVALID_TICKER)
     , m_currentTimeframe(Timeframe::SEC_10)
-    , m_tickByTickReqId(-1)
-    , m_realTimeBarsReqId(-1)
-    , m_hasDynamicBar(false)
-    , m_lastCompletedBarTime(0)
-    , m_isAggregating(false)
-    , m_lastPriceUpdateTime(0)
-    , m_currentBarStartTime(0)
-    , m_hasPriceUpdateForCurrentBar(false)
+    , m_maxStreamingTickers(qMax(1, Settings::instance().maxStreamingTickers()))
+    , m_streamUseCounter(0)
+    , m_tradeTickType(Settings::instance().tickByTickTrades())
+    , m_tickByTickLimit(qMax(1, Settings::instance().tickByTickLimit()))
+    , m_tickByTickBudget(m_tickByTickLimit)
+    , m_nextGapId(1)
+    , m_gapsFound(0)
+    , m_gapsFilled(0)
 {
     connect(m_client, &IBKRClient::historicalBarReceived, this, &TickerDataManager::onHistoricalBarReceived);
     connect(m_client, &IBKRClient::historicalDataFinished, this, &TickerDataManager::onHistoricalDataFinished);
     connect(m_client, &IBKRClient::realTimeBarReceived, this, &TickerDataManager::onRealTimeBarReceived);
-    connect(m_client, &IBKRClient::tickByTickUpdated, this, &TickerDataManager::onTickByTickUpdate);
     connect(m_client, &IBKRClient::symbolFound, this, &TickerDataManager::onContractDetailsReceived);
     connect(m_client, &IBKRClient::symbolSearchFinished, this, &TickerDataManager::onContractSearchFinished);
     connect(m_client, &IBKRClient::connected, this, &TickerDataManager::onReconnected);
+    connect(m_client, &IBKRClient::error, this, &TickerDataManager::onStreamError);
+
+    // Tick-by-tick comes straight from the wrapper (no signal hops)
+    m_client->tickPipeline().addConsumer(this);
+
+    // All historical requests are queued and paced here
+    m_historyScheduler = new HistoricalRequestScheduler(m_client, this);
+    connect(m_historyScheduler, &HistoricalRequestScheduler::requestFailed, this, &TickerDataManager::onHistoricalRequestFailed);
 
     // Timer to detect new candle boundaries (aligned to 5s)
     m_candleBoundaryTimer = new QTimer(this);
@@ -96,6 +135,11 @@ TickerDataManager::TickerDataManager(IBKRClient* client, QObject* parent)
         m_candleBoundaryTimer->start(5000); // Start repeating timer
         onCandleBoundaryCheck(); // Fire immediately on alignment
     });
+
+    m_priceFlushTimer = new QTimer(this);
+    m_priceFlushTimer->setSingleShot(true);
+    m_priceFlushTimer->setInterval(PRICE_FLUSH_INTERVAL_MS);
+    connect(m_priceFlushTimer, &QTimer::timeout, this, &TickerDataManager::flushBackgroundPrices);
 }
 
 TickerDataManager::~TickerDataManager()
@@ -113,6 +157,7 @@ QString TickerDataManager::getExchange(const QString& symbol, const QString& exc
 int TickerDataManager::getContractId(const QString& symbol, const QString& exchange) const
 {
     QString tickerKey = makeTickerKey(symbol, exchange);
+    QReadLocker locker(&m_snapshotLock);
     return m_tickerKeyToContractId.value(tickerKey, 0);
 }
 
@@ -133,21 +178,87 @@ void TickerDataManager::activateTicker(const QString& symbol, const QString& exc
     }
 
     // Add ticker if new
-    bool isNewTicker = !m_tickerData.contains(tickerKey);
-    if (isNewTicker) {
-        int conId = m_symbolToContractId.value(symbol, 0);
-        if (conId == 0) {
-            conId = m_tickerKeyToContractId.value(tickerKey, 0);
-        }
-        m_tickerData[tickerKey] = TickerData{symbol, exchange, conId};
+    TickerHandle ticker = m_registry.find(tickerKey);
+    if (ticker == INVALID_TICKER) {
+        ticker = addTickerData(tickerKey, symbol, exchange);
     }
 
-    // Switch to this ticker (will subscribe to tick-by-tick only)
+    // Switch to this ticker (subscribes to tick-by-tick unless it is already streaming)
     // Historical data and real-time bars will be loaded after first tick
-    setCurrentSymbol(tickerKey);
+    setCurrentTicker(ticker);
 
     // Emit signal so UI can update (chart will show cached data if available)
     emit tickerActivated(symbol, exchange);
+
+    // Ticker was already streaming - push its last quote right away instead of waiting for next tick
+    replayLastQuote(ticker);
+
+    // Chart load may have been cancelled when switching away - request it again
+    auto streamIt = m_streams.constFind(ticker);
+    if (streamIt != m_streams.constEnd() && streamIt->realTimeBarsReqId != -1
+        && !m_tickerData[ticker].isLoadedByTimeframe.value(m_currentTimeframe, false)) {
+        loadTimeframe(ticker, m_currentTimeframe);
+    }
+}
+
+TickerHandle TickerDataManager::addTickerData(const QString& tickerKey, const QString& symbol, const QString& exchange)
+{
+    int conId = m_symbolToContractId.value(symbol, 0);
+    if (conId == 0) {
+        conId = m_tickerKeyToContractId.value(tickerKey, 0);
+    }
+    TickerHandle ticker;
+    {
+        QWriteLocker locker(&m_snapshotLock);
+        ticker = m_registry.intern(tickerKey);
+        m_tickerData[ticker] = TickerData{symbol, exchange, conId};
+    }
+
+    // Show bars from previous sessions right away, TWS only tops up the gap
+    restoreFromDisk(ticker);
+    return ticker;
+}
+
+void TickerDataManager::prefetchTickers(const QList<QPair<QString, QString>>& tickers)
+{
+    if (!m_client || !m_client->isConnected()) return;
+
+    qint64 now = clockSeconds();
+    Timeframe timeframe = m_currentTimeframe;
+    int barSeconds = timeframeToSeconds(timeframe);
+    int queued = 0;
+
+    for (const auto& entry : tickers) {
+        QString tickerKey = makeTickerKey(entry.first, entry.second);
+        if (!entry.second.isEmpty()) {
+            m_tickerKeyToExchange[tickerKey] = entry.second;
+        }
+        TickerHandle ticker = m_registry.find(tickerKey);
+        if (ticker == INVALID_TICKER) {
+            ticker = addTickerData(tickerKey, entry.first, entry.second);
+        }
+
+        // Streamed tickers load (and keep up to date) on their own
+        if (m_streams.contains(ticker)) continue;
+
+        const TickerData& data = m_tickerData[ticker];
+        if (data.isLoadedByTimeframe.value(timeframe, false) || isLoadPending(ticker, timeframe)) continue;
+
+        // Only fetch what the disk cache doesn't have
+        qint64 windowStart = now - historyWindowSeconds(timeframe);
+        qint64 gapStart = qMax(windowStart, data.persistedUntilByTimeframe.value(timeframe, 0));
+        if (now - gapStart < barSeconds) continue;
+
+        int reqId = (gapStart > windowStart)
+            ? requestMissingBars(ticker, timeframe, gapStart, now, HistoricalRequestPriority::Normal, HistoricalRequestPurpose::Prefetch)
+            : requestHistoricalBars(ticker, timeframe, HistoricalRequestPriority::Normal, HistoricalRequestPurpose::Prefetch);
+        m_prefetchRequests.insert(reqId);
+        queued++;
+    }
+
+    if (queued > 0) {
+        LOG_INFO(QString("Prefetching %1 bars for %2 of %3 watchlist ticker(s)").arg(timeframeToString(timeframe)).arg(queued).arg(tickers.size()));
+    }
 }
 
 void TickerDataManager::setExpectedExchange(const QString& symbol, const QString& exchange)
@@ -162,92 +273,366 @@ void TickerDataManager::setContractId(const QString& symbol, const QString& exch
     if (conId > 0) {
         QString tickerKey = makeTickerKey(symbol, exchange);
         m_symbolToContractId[symbol] = conId;
+        QWriteLocker locker(&m_snapshotLock);
         m_tickerKeyToContractId[tickerKey] = conId;
     }
 }
 
+void TickerDataManager::setMaxStreamingTickers(int count)
+{
+    m_maxStreamingTickers = qMax(1, count);
+
+    // Shrink pool if limit was lowered
+    while (m_streams.size() > streamCapacity() && evictLeastRecentlyUsedStream()) {
+    }
+    rebalanceTradeStreams();
+}
+
+void TickerDataManager::setTickByTickMode(const QString& tradeTickType, int limit)
+{
+    limit = qMax(1, limit);
+    if (tradeTickType == m_tradeTickType && limit == m_tickByTickLimit) return;
+
+    LOG_INFO(QString("Tick-by-tick mode: %1, limit %2 subscriptions")
+        .arg(tradeTickType.isEmpty() ? QString("quotes only") : "quotes + " + tradeTickType).arg(limit));
+    bool typeChanged = (tradeTickType != m_tradeTickType);
+    m_tradeTickType = tradeTickType;
+    m_tickByTickLimit = limit;
+    m_tickByTickBudget = limit;
+
+    // Streams of the other type are replaced, not kept next to the new ones
+    if (typeChanged) {
+        for (auto it = m_streams.begin(); it != m_streams.end(); ++it) {
+            cancelTrades(it.value());
+        }
+    }
+    while (m_streams.size() > streamCapacity() && evictLeastRecentlyUsedStream()) {
+    }
+    rebalanceTradeStreams();
+}
+
+int TickerDataManager::tickByTickSubscriptions() const
+{
+    int count = 0;
+    for (auto it = m_streams.constBegin(); it != m_streams.constEnd(); ++it) {
+        count += (it->tickByTickReqId != -1) + (it->tradesReqId != -1);
+    }
+    return count;
+}
+
+int TickerDataManager::streamCapacity() const
+{
+    // With trades on, one subscription stays free for the current ticker's prints
+    int quoteBudget = m_tradeTickType.isEmpty() ? m_tickByTickBudget : m_tickByTickBudget - 1;
+    return qMax(1, qMin(m_maxStreamingTickers, quoteBudget));
+}
+
 void TickerDataManager::removeTicker(const QString& symbol, const QString& exchange)
 {
     // Create ticker key
     QString tickerKey = makeTickerKey(symbol, exchange);
+    TickerHandle ticker = m_registry.find(tickerKey);
+    if (ticker == INVALID_TICKER) return;
 
-    if (m_tickerData.contains(tickerKey)) {
-        m_tickerData.remove(tickerKey);
+    // Cancel tick-by-tick and real-time bars for this ticker
+    cancelStream(ticker);
+    m_streamedTickers.remove(ticker);
+    m_pendingPrices.remove(ticker);
 
-        // Clean up request ID mappings
-        QList<int> reqIdsToRemove;
-        for (auto it = m_reqIdToSymbol.begin(); it != m_reqIdToSymbol.end(); ++it) {
-            if (it.value() == tickerKey) {
-                reqIdsToRemove.append(it.key());
-            }
-        }
-        for (int reqId : reqIdsToRemove) {
-            m_reqIdToSymbol.remove(reqId);
-            m_reqIdToTimeframe.remove(reqId);
-        }
+    {
+        QWriteLocker locker(&m_snapshotLock);
+        m_tickerData.remove(ticker);
+    }
+    if (ticker == m_currentTicker) {
+        m_currentTicker = INVALID_TICKER;
+        m_currentSymbol.clear();
+        updateTickFocus();
+    }
+    rebalanceTradeStreams(); // The freed subscriptions go to the next tickers in line
 
-        // Clean up real-time bars mappings
-        QList<int> rtReqIdsToRemove;
-        for (auto it = m_realTimeBarsReqIdToSymbol.begin(); it != m_realTimeBarsReqIdToSymbol.end(); ++it) {
-            if (it.value() == tickerKey) {
-                rtReqIdsToRemove.append(it.key());
-            }
-        }
-        for (int reqId : rtReqIdsToRemove) {
-            m_realTimeBarsReqIdToSymbol.remove(reqId);
-            m_realTimeBarsLogged.remove(reqId);
+    // Clean up request ID mappings (only this ticker's own reqIds)
+    for (int reqId : m_registry.takeRoutes(ticker)) {
+        m_pendingHistoricalBars.remove(reqId);
+        m_backfillRequests.remove(reqId);
+        m_prefetchRequests.remove(reqId);
+    }
+    m_historyScheduler->cancelOwner(tickerKey, HistoricalRequestPriority::Low);
+
+    // Drop pending gap backfills
+    for (auto it = m_gaps.begin(); it != m_gaps.end();) {
+        if (it->ticker == ticker) {
+            it = m_gaps.erase(it);
+        } else {
+            ++it;
         }
     }
+
+    QWriteLocker locker(&m_snapshotLock);
+    m_registry.release(ticker);
 }
 
 void TickerDataManager::loadTimeframe(const QString& tickerKey, Timeframe timeframe)
 {
-    if (!m_tickerData.contains(tickerKey)) return;
+    loadTimeframe(m_registry.find(tickerKey), timeframe);
+}
+
+void TickerDataManager::loadTimeframe(TickerHandle ticker, Timeframe timeframe)
+{
+    auto dataIt = m_tickerData.find(ticker);
+    if (dataIt == m_tickerData.end()) return;
 
-    TickerData& data = m_tickerData[tickerKey];
+    TickerData& data = dataIt.value();
     if (data.isLoadedByTimeframe.value(timeframe, false)) {
         emit tickerDataLoaded(data.symbol);
         return;
     }
 
-    int reqId = m_nextReqId++;
-    m_reqIdToSymbol[reqId] = tickerKey; // Store ticker key
-    m_reqIdToTimeframe[reqId] = timeframe;
-    requestHistoricalBars(data.symbol, reqId, timeframe); // TWS API gets pure symbol
+    // Same chart load already on its way
+    if (isLoadPending(ticker, timeframe)) return;
+
+    qint64 now = clockSeconds();
+    qint64 windowStart = now - historyWindowSeconds(timeframe);
+
+    // Build as much as possible from finer cached bars (live tail) and bars restored from disk,
+    // only the uncovered part of the window goes to TWS
+    qint64 coveredFrom = resampleFromCache(ticker, timeframe);
+    qint64 gapEnd = (coveredFrom >= 0) ? coveredFrom : now;
+    qint64 gapStart = qMax(windowStart, data.persistedUntilByTimeframe.value(timeframe, 0));
+
+    if (gapEnd - gapStart < timeframeToSeconds(timeframe)) {
+        data.isLoadedByTimeframe[timeframe] = true;
+        persistSeries(ticker, timeframe);
+        emit tickerDataLoaded(data.symbol);
+        return;
+    }
+
+    // Displayed ticker goes first, background ones wait
+    HistoricalRequestPriority priority = (ticker == m_currentTicker) ? HistoricalRequestPriority::High : HistoricalRequestPriority::Normal;
+    if (gapStart > windowStart || gapEnd < now) {
+        requestMissingBars(ticker, timeframe, gapStart, gapEnd, priority);
+        return;
+    }
+
+    requestHistoricalBars(ticker, timeframe, priority);
+}
+
+bool TickerDataManager::isLoadPending(TickerHandle ticker, Timeframe timeframe) const
+{
+    for (int reqId : m_registry.routes(ticker)) {
+        RequestRoute route = m_registry.route(reqId);
+        if (route.kind == RequestKind::Historical && route.timeframe == static_cast<int>(timeframe)
+            && !m_backfillRequests.contains(reqId)) {
+            return true;
+        }
+    }
+    return false;
 }
 
-const QVector<CandleBar>* TickerDataManager::getBars(const QString& tickerKey, Timeframe timeframe) const
+qint64 TickerDataManager::resampleFromCache(TickerHandle ticker, Timeframe timeframe)
 {
-    auto it = m_tickerData.constFind(tickerKey);
+    // Cached tail is only up to date while real-time bars are streaming for this ticker
+    auto streamIt = m_streams.constFind(ticker);
+    if (streamIt == m_streams.constEnd() || streamIt->realTimeBarsReqId == -1) return -1;
+
+    TickerData& data = m_tickerData[ticker];
+    int targetSeconds = timeframeToSeconds(timeframe);
+
+    // Pick the finer series reaching furthest back (ties go to the finer one)
+    Timeframe source = Timeframe::SEC_5;
+    qint64 coveredFrom = -1;
+    for (int i = 0; i < static_cast<int>(timeframe); ++i) {
+        Timeframe candidate = static_cast<Timeframe>(i);
+        if (targetSeconds % timeframeToSeconds(candidate) != 0) continue;
+
+        auto barsIt = data.barsByTimeframe.constFind(candidate);
+        if (barsIt == data.barsByTimeframe.constEnd() || barsIt->isEmpty()) continue;
+
+        // First target bucket fully covered by this series
+        qint64 first = barsIt->first().timestamp;
+        qint64 alignedStart = ((first + targetSeconds - 1) / targetSeconds) * targetSeconds;
+        if (alignedStart > barsIt->last().timestamp) continue;
+
+        if (coveredFrom < 0 || alignedStart < coveredFrom) {
+            coveredFrom = alignedStart;
+            source = candidate;
+        }
+    }
+
+    if (coveredFrom < 0) return -1;
+
+    QVector<CandleBar> resampled = resampleBars(data.barsByTimeframe[source].view(), targetSeconds, coveredFrom);
+    const CandleSeries& bars = mergeBars(data, timeframe, resampled, false);
+    data.lastBarTimestampByTimeframe[timeframe] = bars.last().timestamp;
+
+    LOG_DEBUG(QString("Resampled %1 %2 bars for %3 from cached %4 bars (covered from %5)")
+        .arg(resampled.size()).arg(timeframeToString(timeframe)).arg(data.symbol)
+        .arg(timeframeToString(source)).arg(coveredFrom));
+    return coveredFrom;
+}
+
+CandleView TickerDataManager::getBars(const QString& tickerKey, Timeframe timeframe) const
+{
+    auto it = m_tickerData.constFind(m_registry.find(tickerKey));
     if (it != m_tickerData.constEnd()) {
         auto barIt = it->barsByTimeframe.constFind(timeframe);
         if (barIt != it->barsByTimeframe.constEnd()) {
-            return &barIt.value();
+            return barIt->view();
+        }
+    }
+    return CandleView();
+}
+
+CandleSeries TickerDataManager::barsSnapshot(const QString& tickerKey, Timeframe timeframe) const
+{
+    // Columns are implicitly shared: the copy is O(1) here, and the engine only
+    // deep-copies a series if it modifies it while the caller still holds the snapshot
+    QReadLocker locker(&m_snapshotLock);
+    auto it = m_tickerData.constFind(m_registry.find(tickerKey));
+    if (it != m_tickerData.constEnd()) {
+        auto barIt = it->barsByTimeframe.constFind(timeframe);
+        if (barIt != it->barsByTimeframe.constEnd()) {
+            return barIt.value();
+        }
+    }
+    return CandleSeries();
+}
+
+int TickerDataManager::seriesCapacity(Timeframe timeframe) const
+{
+    int retentionBars = m_barRetentionHours * 3600 / timeframeToSeconds(timeframe);
+    return qMax(CandleSeries::DEFAULT_CAPACITY, retentionBars);
+}
+
+CandleSeries& TickerDataManager::seriesFor(TickerData& data, Timeframe timeframe)
+{
+    auto it = data.barsByTimeframe.find(timeframe);
+    if (it == data.barsByTimeframe.end()) {
+        it = data.barsByTimeframe.insert(timeframe, CandleSeries(seriesCapacity(timeframe)));
+    }
+    return it.value();
+}
+
+const CandleSeries& TickerDataManager::mergeBars(TickerData& data, Timeframe timeframe, const QVector<CandleBar>& bars, bool replaceExisting)
+{
+    QWriteLocker locker(&m_snapshotLock);
+    CandleSeries& series = seriesFor(data, timeframe);
+    series.merge(bars, replaceExisting);
+    return series;
+}
+
+const CandleSeries& TickerDataManager::mergeBar(TickerData& data, Timeframe timeframe, const CandleBar& bar, bool replaceExisting)
+{
+    QWriteLocker locker(&m_snapshotLock);
+    CandleSeries& series = seriesFor(data, timeframe);
+    series.merge(bar, replaceExisting);
+    return series;
+}
+
+void TickerDataManager::restoreFromDisk(TickerHandle ticker)
+{
+    const QString& tickerKey = m_registry.key(ticker);
+    TickerData& data = m_tickerData[ticker];
+    QStringList restored;
+
+    for (int i = 0; i < TIMEFRAME_COUNT; ++i) {
+        Timeframe timeframe = static_cast<Timeframe>(i);
+        QVector<CandleBar> bars = m_barCache.load(tickerKey, timeframeToSeconds(timeframe), seriesCapacity(timeframe));
+        if (bars.isEmpty()) continue;
+
+        const CandleSeries& series = mergeBars(data, timeframe, bars, false);
+        data.lastBarTimestampByTimeframe[timeframe] = series.last().timestamp;
+        data.persistedUntilByTimeframe[timeframe] = bars.last().timestamp;
+        restored.append(QString("%1=%2").arg(timeframeToString(timeframe)).arg(bars.size()));
+    }
+
+    if (!restored.isEmpty()) {
+        LOG_DEBUG(QString("Restored bars for %1 from disk cache: %2").arg(tickerKey).arg(restored.join(", ")));
+    }
+}
+
+void TickerDataManager::persistBar(TickerHandle ticker, Timeframe timeframe, qint64 timestamp)
+{
+    auto dataIt = m_tickerData.constFind(ticker);
+    if (dataIt == m_tickerData.constEnd()) return;
+
+    // Only append once the in-memory series is contiguous with what's on disk
+    // (otherwise the file would get a hole that the next launch can't detect)
+    if (!dataIt->isLoadedByTimeframe.value(timeframe, false)) return;
+
+    auto seriesIt = dataIt->barsByTimeframe.constFind(timeframe);
+    if (seriesIt == dataIt->barsByTimeframe.constEnd()) return;
+
+    int index = seriesIt->lowerBound(timestamp);
+    if (index < seriesIt->size() && seriesIt->timestamp(index) == timestamp) {
+        m_barCache.append(m_registry.key(ticker), timeframeToSeconds(timeframe), seriesIt->at(index));
+    }
+}
+
+void TickerDataManager::persistSeries(TickerHandle ticker, Timeframe timeframe)
+{
+    auto dataIt = m_tickerData.constFind(ticker);
+    if (dataIt == m_tickerData.constEnd()) return;
+
+    auto seriesIt = dataIt->barsByTimeframe.constFind(timeframe);
+    if (seriesIt == dataIt->barsByTimeframe.constEnd()) return;
+
+    // In-progress bar is skipped, it gets appended once completed
+    m_barCache.rewrite(m_registry.key(ticker), timeframeToSeconds(timeframe), seriesIt->view(), clockSeconds());
+}
+
+void TickerDataManager::setBarRetentionHours(int hours)
+{
+    hours = qMax(1, hours);
+    if (hours == m_barRetentionHours) return;
+    m_barRetentionHours = hours;
+
+    // Resize existing ring buffers (shrinking drops the oldest bars)
+    QWriteLocker locker(&m_snapshotLock);
+    for (auto tickerIt = m_tickerData.begin(); tickerIt != m_tickerData.end(); ++tickerIt) {
+        for (auto it = tickerIt->barsByTimeframe.begin(); it != tickerIt->barsByTimeframe.end(); ++it) {
+            it->setCapacity(seriesCapacity(it.key()));
         }
     }
-    return nullptr;
+    LOG_DEBUG(QString("Bar retention set to %1 hours").arg(hours));
 }
 
 bool TickerDataManager::isLoaded(const QString& tickerKey, Timeframe timeframe) const
 {
-    auto it = m_tickerData.find(tickerKey);
-    return (it != m_tickerData.end()) ? it->isLoadedByTimeframe.value(timeframe, false) : false;
+    auto it = m_tickerData.constFind(m_registry.find(tickerKey));
+    return (it != m_tickerData.constEnd()) ? it->isLoadedByTimeframe.value(timeframe, false) : false;
 }
 
 void TickerDataManager::setCurrentSymbol(const QString& tickerKey)
 {
-    if (m_currentSymbol != tickerKey) {
-        unsubscribeFromCurrentTicker();
-        m_currentSymbol = tickerKey;
-        m_isAggregating = false; // Reset aggregation state to prevent mixing prices from different tickers
+    setCurrentTicker(m_registry.find(tickerKey));
+}
+
+void TickerDataManager::setCurrentTicker(TickerHandle ticker)
+{
+    if (m_currentTicker != ticker) {
+        // Previous ticker keeps streaming in the pool (evicted later by LRU if needed),
+        // but its pending chart loads are dropped (gap backfills keep going)
+        if (m_currentTicker != INVALID_TICKER) {
+            for (int reqId : m_historyScheduler->cancelOwner(m_currentSymbol)) {
+                dropHistoricalRequest(reqId);
+            }
+        }
+        m_currentTicker = ticker;
+        m_currentSymbol = (ticker != INVALID_TICKER) ? m_registry.key(ticker) : QString();
+        m_historyScheduler->setFocusOwner(m_currentSymbol);
+
+        LOG_INFO(QString("Switched to symbol: %1 (key: %2)").arg(pureSymbol(ticker)).arg(m_currentSymbol));
 
-        // Extract symbol from tickerKey for logging
-        QString symbol = m_tickerData.contains(tickerKey) ? m_tickerData[tickerKey].symbol : tickerKey;
-        LOG_INFO(QString("Switched to symbol: %1 (key: %2)").arg(symbol).arg(tickerKey));
+        if (ticker != INVALID_TICKER) {
+            acquireStream(ticker);
+        }
+        updateTickFocus();
 
-        // Subscribe to tick-by-tick ONLY (for immediate price updates)
-        // Historical data and real-time bars will be loaded after first tick
-        subscribeToTickByTick();
+        // Orders must never be sent for one symbol priced from another's ticks, so trading
+        // follows in the same step instead of waiting for the GUI round trip
+        auto dataIt = m_tickerData.constFind(ticker);
+        emit tradingSymbolChanged(dataIt != m_tickerData.constEnd() ? dataIt->symbol : QString(),
+                                  dataIt != m_tickerData.constEnd() ? dataIt->exchange : QString());
     }
 }
 
@@ -256,279 +641,629 @@ void TickerDataManager::setCurrentTimeframe(Timeframe timeframe)
     if (m_currentTimeframe != timeframe) {
         LOG_DEBUG(QString("Switching timeframe to %1").arg(timeframeToString(timeframe)));
         m_currentTimeframe = timeframe;
-        m_isAggregating = false; // Reset aggregation on timeframe change
-        if (!m_currentSymbol.isEmpty()) {
-            loadTimeframe(m_currentSymbol, m_currentTimeframe);
+        if (m_currentTicker != INVALID_TICKER) {
+            loadTimeframe(m_currentTicker, m_currentTimeframe);
+        }
+    }
+}
+
+QString TickerDataManager::pureSymbol(TickerHandle ticker) const
+{
+    auto it = m_tickerData.constFind(ticker);
+    return (it != m_tickerData.constEnd()) ? it->symbol : QString();
+}
+
+void TickerDataManager::acquireStream(TickerHandle ticker)
+{
+    auto it = m_streams.find(ticker);
+    if (it == m_streams.end()) {
+        // Make room for new ticker (never evicts the current one)
+        while (m_streams.size() >= streamCapacity() && evictLeastRecentlyUsedStream()) {
+        }
+        it = m_streams.insert(ticker, TickerStream());
+    } else {
+        LOG_DEBUG(QString("%1 is already streaming (tick-by-tick reqId: %2, real-time bars reqId: %3)")
+            .arg(pureSymbol(ticker)).arg(it->tickByTickReqId).arg(it->realTimeBarsReqId));
+    }
+
+    it->lastUsed = ++m_streamUseCounter;
+
+    // Subscribe to tick-by-tick ONLY (for immediate price updates)
+    // Historical data and real-time bars will be loaded after first tick
+    if (it->tickByTickReqId == -1) {
+        subscribeToTickByTick(ticker, *it);
+    }
+    rebalanceTradeStreams();
+}
+
+bool TickerDataManager::evictLeastRecentlyUsedStream()
+{
+    TickerHandle victim = INVALID_TICKER;
+    quint64 oldest = 0;
+    for (auto it = m_streams.constBegin(); it != m_streams.constEnd(); ++it) {
+        if (it.key() == m_currentTicker) continue;
+        if (victim == INVALID_TICKER || it->lastUsed < oldest) {
+            victim = it.key();
+            oldest = it->lastUsed;
+        }
+    }
+
+    if (victim == INVALID_TICKER) return false;
+
+    LOG_DEBUG(QString("Streaming pool full (%1), evicting least recently used ticker %2")
+        .arg(streamCapacity()).arg(m_registry.key(victim)));
+    cancelStream(victim);
+    return true;
+}
+
+void TickerDataManager::cancelStream(TickerHandle ticker)
+{
+    auto it = m_streams.find(ticker);
+    if (it == m_streams.end()) return;
+
+    bool canCancel = m_client && m_client->isConnected();
+
+    if (it->realTimeBarsReqId != -1) {
+        if (canCancel) {
+            LOG_DEBUG(QString("Unsubscribing from real-time bars (reqId: %1)").arg(it->realTimeBarsReqId));
+            m_client->cancelRealTimeBars(it->realTimeBarsReqId);
         }
+        m_registry.removeRoute(it->realTimeBarsReqId);
     }
+
+    cancelTrades(*it);
+    if (it->tickByTickReqId != -1) {
+        if (canCancel) {
+            LOG_DEBUG(QString("Unsubscribing from tick-by-tick data (reqId: %1)").arg(it->tickByTickReqId));
+            m_client->cancelTickByTick(it->tickByTickReqId);
+        }
+        m_registry.removeRoute(it->tickByTickReqId);
+    }
+
+    m_streams.erase(it);
 }
 
-void TickerDataManager::subscribeToTickByTick()
+void TickerDataManager::subscribeToTrades(TickerHandle ticker, TickerStream& stream)
 {
-    if (m_currentSymbol.isEmpty() || !m_client || !m_client->isConnected()) return;
+    if (ticker == INVALID_TICKER || !m_client || !m_client->isConnected() || stream.tickByTickReqId == -1) return;
+
+    QString symbol = pureSymbol(ticker);
+    stream.tradesReqId = m_nextReqId++;
+    m_registry.addRoute(stream.tradesReqId, ticker, RequestKind::TickByTick);
+    LOG_DEBUG(QString("Subscribing to tick-by-tick %1 for %2 (reqId: %3, merged into %4)")
+        .arg(m_tradeTickType).arg(symbol).arg(stream.tradesReqId).arg(stream.tickByTickReqId));
+    m_client->requestTickByTickTrades(stream.tradesReqId, stream.tickByTickReqId, symbol, m_tradeTickType);
+}
+
+void TickerDataManager::cancelTrades(TickerStream& stream)
+{
+    if (stream.tradesReqId == -1) return;
+
+    if (m_client && m_client->isConnected()) {
+        LOG_DEBUG(QString("Unsubscribing from tick-by-tick trades (reqId: %1)").arg(stream.tradesReqId));
+        m_client->cancelTickByTick(stream.tradesReqId);
+    }
+    m_registry.removeRoute(stream.tradesReqId);
+    stream.tradesReqId = -1;
+}
+
+void TickerDataManager::rebalanceTradeStreams()
+{
+    if (!m_client || !m_client->isConnected()) return;
+
+    // Current ticker first, then most recently used
+    QVector<TickerHandle> order;
+    order.reserve(m_streams.size());
+    for (auto it = m_streams.constBegin(); it != m_streams.constEnd(); ++it) {
+        if (it->tickByTickReqId != -1) {
+            order.append(it.key());
+        }
+    }
+    std::sort(order.begin(), order.end(), [this](TickerHandle a, TickerHandle b) {
+        if ((a == m_currentTicker) != (b == m_currentTicker)) return a == m_currentTicker;
+        return m_streams.value(a).lastUsed > m_streams.value(b).lastUsed;
+    });
+
+    int budget = m_tradeTickType.isEmpty() ? 0 : m_tickByTickBudget - order.size();
+    int granted = qBound(0, budget, order.size());
+
+    // Cancel before subscribing so the total never goes over the limit
+    for (int i = granted; i < order.size(); ++i) {
+        cancelTrades(m_streams[order[i]]);
+    }
+    for (int i = 0; i < granted; ++i) {
+        TickerStream& stream = m_streams[order[i]];
+        if (stream.tradesReqId == -1) {
+            subscribeToTrades(order[i], stream);
+        }
+    }
+}
+
+void TickerDataManager::onStreamError(int reqId, int code, const QString& message)
+{
+    // TWS refused a trade stream: the account's limit is below the configured one
+    if (code != 10190) return;
+    for (auto it = m_streams.begin(); it != m_streams.end(); ++it) {
+        if (it->tradesReqId != reqId) continue;
+
+        m_registry.removeRoute(reqId);
+        m_client->cancelTickByTick(reqId); // Drops the client's bookkeeping of the refused request
+        it->tradesReqId = -1;
+        m_tickByTickBudget = qMax(1, tickByTickSubscriptions());
+        LOG_WARNING(QString("Tick-by-tick trades for %1 refused (%2), using %3 tick-by-tick subscriptions until reconnect")
+            .arg(pureSymbol(it.key())).arg(message).arg(m_tickByTickBudget));
+        return;
+    }
+}
+
+void TickerDataManager::subscribeToTickByTick(TickerHandle ticker, TickerStream& stream)
+{
+    if (ticker == INVALID_TICKER || !m_client || !m_client->isConnected()) return;
 
     // Get pure symbol for TWS API (not symbol@exchange)
-    QString symbol = m_tickerData.contains(m_currentSymbol) ? m_tickerData[m_currentSymbol].symbol : m_currentSymbol;
+    QString symbol = pureSymbol(ticker);
 
     // Subscribe to tick-by-tick for price lines and current dynamic candle
-    m_tickByTickReqId = m_nextReqId++;
-    m_reqIdToSymbol[m_tickByTickReqId] = m_currentSymbol; // Store ticker key
-    LOG_DEBUG(QString("Subscribing to tick-by-tick data for %1 (reqId: %2)").arg(symbol).arg(m_tickByTickReqId));
-    m_client->requestTickByTick(m_tickByTickReqId, symbol);
+    stream.tickByTickReqId = m_nextReqId++;
+    stream.quotesAndTrades.reset();
+    m_registry.addRoute(stream.tickByTickReqId, ticker, RequestKind::TickByTick);
+    LOG_DEBUG(QString("Subscribing to tick-by-tick data for %1 (reqId: %2)").arg(symbol).arg(stream.tickByTickReqId));
+    m_client->requestTickByTick(stream.tickByTickReqId, symbol);
+    if (ticker == m_currentTicker) {
+        updateTickFocus();
+    }
 }
 
-void TickerDataManager::subscribeToRealTimeBars()
+void TickerDataManager::subscribeToRealTimeBars(TickerHandle ticker, TickerStream& stream)
 {
-    if (m_currentSymbol.isEmpty() || !m_client || !m_client->isConnected()) return;
+    if (ticker == INVALID_TICKER || !m_client || !m_client->isConnected()) return;
 
     // Get pure symbol for TWS API (not symbol@exchange)
-    QString symbol = m_tickerData.contains(m_currentSymbol) ? m_tickerData[m_currentSymbol].symbol : m_currentSymbol;
+    QString symbol = pureSymbol(ticker);
 
     // Subscribe to real-time 5s bars (completed bars go to cache)
-    m_realTimeBarsReqId = m_nextReqId++;
-    m_realTimeBarsReqIdToSymbol[m_realTimeBarsReqId] = m_currentSymbol; // Map reqId to ticker key
-    m_realTimeBarsLogged[m_realTimeBarsReqId] = false; // Reset logging for this reqId
-    LOG_DEBUG(QString("Subscribing to real-time bars for %1 (reqId: %2)").arg(symbol).arg(m_realTimeBarsReqId));
-    m_client->requestRealTimeBars(m_realTimeBarsReqId, symbol);
+    stream.realTimeBarsReqId = m_nextReqId++;
+    stream.realTimeBarsLogged = false; // Reset logging for this reqId
+    // Bars may have been missed while not subscribed - not on first activation, the
+    // initial history load covers everything up to now
+    stream.checkGapOnNextBar = m_streamedTickers.contains(ticker);
+    m_streamedTickers.insert(ticker);
+    m_registry.addRoute(stream.realTimeBarsReqId, ticker, RequestKind::RealTimeBars);
+    LOG_DEBUG(QString("Subscribing to real-time bars for %1 (reqId: %2)").arg(symbol).arg(stream.realTimeBarsReqId));
+    m_client->requestRealTimeBars(stream.realTimeBarsReqId, symbol);
 }
 
-void TickerDataManager::subscribeToCurrentTicker()
+void TickerDataManager::replayLastQuote(TickerHandle ticker)
 {
-    subscribeToTickByTick();
-    subscribeToRealTimeBars();
+    auto it = m_streams.constFind(ticker);
+    auto dataIt = m_tickerData.constFind(ticker);
+    if (it == m_streams.constEnd() || !it->hasQuote || dataIt == m_tickerData.constEnd()) return;
+
+    const TickerStream& stream = *it;
+    const QString& symbol = dataIt->symbol;
+    LOG_DEBUG(QString("Replaying last quote for %1: price=%2, bid=%3, ask=%4")
+        .arg(symbol).arg(stream.lastPrice).arg(stream.bid).arg(stream.ask));
+
+    emit currentTickUpdated(stream.lastTickReqId, stream.lastPrice, stream.bid, stream.ask);
+    emit priceUpdated(symbol, stream.lastPrice, calculateChangePercent(*dataIt, stream.lastPrice),
+                      stream.bid, stream.ask, stream.mid);
+    if (stream.hasDynamicBar) {
+        emit currentBarUpdated(symbol, m_currentTimeframe, liveBar(ticker, stream));
+    }
+
+    // Data is already flowing - same as first tick for Display Group sync etc.
+    emit firstTickReceived(symbol);
 }
 
-void TickerDataManager::unsubscribeFromCurrentTicker()
+void TickerDataManager::updateTickFocus()
 {
-    if (m_realTimeBarsReqId != -1 && m_client && m_client->isConnected()) {
-        LOG_DEBUG(QString("Unsubscribing from real-time bars (reqId: %1)").arg(m_realTimeBarsReqId));
-        m_client->cancelRealTimeBars(m_realTimeBarsReqId);
-        m_realTimeBarsReqIdToSymbol.remove(m_realTimeBarsReqId); // Remove mapping
-        m_realTimeBarsLogged.remove(m_realTimeBarsReqId); // Remove logging tracker
-        m_realTimeBarsReqId = -1;
-    }
+    auto it = m_streams.constFind(m_currentTicker);
+    int reqId = (it != m_streams.constEnd()) ? it->tickByTickReqId : -1;
+    m_client->tickPipeline().setFocus(reqId);
+}
 
-    if (m_tickByTickReqId != -1 && m_client && m_client->isConnected()) {
-        LOG_DEBUG(QString("Unsubscribing from tick-by-tick data (reqId: %1)").arg(m_tickByTickReqId));
-        m_client->cancelTickByTick(m_tickByTickReqId);
-        m_tickByTickReqId = -1;
+double TickerDataManager::calculateChangePercent(const TickerData& data, double price) const
+{
+    double changePercent = 0.0;
+    auto barsIt = data.barsByTimeframe.constFind(m_currentTimeframe);
+    if (barsIt != data.barsByTimeframe.constEnd() && barsIt->size() >= 2) {
+        // Compare with previous bar's close (1 bar ago for 10s = 10 seconds ago)
+        double oldPrice = barsIt->close(barsIt->size() - 2);
+        if (oldPrice > 0) {
+            changePercent = ((price - oldPrice) / oldPrice) * 100.0;
+        }
     }
-
-    m_hasDynamicBar = false;
-    m_lastCompletedBarTime = 0;
+    return changePercent;
 }
 
 void TickerDataManager::onHistoricalBarReceived(int reqId, long time, double open, double high, double low, double close, long volume)
 {
-    if (!m_reqIdToSymbol.contains(reqId)) return;
-    QString tickerKey = m_reqIdToSymbol[reqId]; // This is now ticker key (symbol@exchange)
-    Timeframe timeframe = m_reqIdToTimeframe[reqId];
-    TickerData& data = m_tickerData[tickerKey];
-    QVector<CandleBar>& bars = data.barsByTimeframe[timeframe];
-    if (bars.isEmpty() || bars.last().timestamp < time) {
-        bars.append({time, open, high, low, close, volume});
-        data.lastBarTimestampByTimeframe[timeframe] = time;
-    }
+    if (!m_registry.hasRoute(reqId)) return;
+
+    // Collected and merged in one pass when the request finishes
+    m_pendingHistoricalBars[reqId].append(CandleBar(time, open, high, low, close, volume));
 }
 
 void TickerDataManager::onHistoricalDataFinished(int reqId)
 {
-    if (!m_reqIdToSymbol.contains(reqId)) return;
-    QString tickerKey = m_reqIdToSymbol[reqId]; // This is now ticker key
-    Timeframe timeframe = m_reqIdToTimeframe[reqId];
-    m_tickerData[tickerKey].isLoadedByTimeframe[timeframe] = true;
+    RequestRoute route = m_registry.route(reqId);
+    if (route.ticker == INVALID_TICKER || route.kind != RequestKind::Historical) return;
+    m_registry.removeRoute(reqId);
+
+    TickerHandle ticker = route.ticker;
+    Timeframe timeframe = static_cast<Timeframe>(route.timeframe);
+    QVector<CandleBar> received = m_pendingHistoricalBars.take(reqId);
+    bool isBackfill = m_backfillRequests.contains(reqId);
+    bool isPrefetch = m_prefetchRequests.remove(reqId);
+
+    auto dataIt = m_tickerData.find(ticker);
+    if (dataIt == m_tickerData.end()) {
+        if (isBackfill) {
+            finishBackfillRequest(reqId);
+        }
+        return;
+    }
 
-    // Count how many bars were loaded
-    int barCount = 0;
-    if (m_tickerData.contains(tickerKey)) {
-        auto it = m_tickerData[tickerKey].barsByTimeframe.find(timeframe);
-        if (it != m_tickerData[tickerKey].barsByTimeframe.end()) {
-            barCount = it.value().size();
+    // Bars already received live take precedence over historical ones,
+    // except for gap backfills which replace partial bars built around the hole
+    TickerData& data = dataIt.value();
+    std::sort(received.begin(), received.end(), [](const CandleBar& a, const CandleBar& b) { return a.timestamp < b.timestamp; });
+    if (isPrefetch) {
+        // Nothing keeps the in-progress bar updated until the ticker streams - keep completed bars only
+        qint64 now = clockSeconds();
+        int barSeconds = timeframeToSeconds(timeframe);
+        while (!received.isEmpty() && received.last().timestamp + barSeconds > now) {
+            received.removeLast();
         }
     }
+    const CandleSeries& bars = mergeBars(data, timeframe, received, isBackfill);
+    if (!bars.isEmpty()) {
+        data.lastBarTimestampByTimeframe[timeframe] = bars.last().timestamp;
+    }
+    if (isPrefetch) {
+        // Not live yet - stays unloaded so activation only tops up from here
+        if (!bars.isEmpty()) {
+            data.persistedUntilByTimeframe[timeframe] = bars.last().timestamp;
+        }
+    } else if (!isBackfill) {
+        data.isLoadedByTimeframe[timeframe] = true;
+    }
+    if (isPrefetch || data.isLoadedByTimeframe.value(timeframe, false)) {
+        persistSeries(ticker, timeframe);
+    }
 
     // Get pure symbol for logging and signal emission
-    QString symbol = m_tickerData.contains(tickerKey) ? m_tickerData[tickerKey].symbol : tickerKey;
-    LOG_DEBUG(QString("Historical data loaded for %1 (key=%2) [%3]: %4 bars").arg(symbol).arg(tickerKey).arg(timeframeToString(timeframe)).arg(barCount));
+    QString symbol = data.symbol;
+    LOG_DEBUG(QString("Historical data loaded for %1 (key=%2) [%3]: %4 bars (%5 received)").arg(symbol).arg(m_registry.key(ticker)).arg(timeframeToString(timeframe)).arg(bars.size()).arg(received.size()));
     emit tickerDataLoaded(symbol);
-    m_reqIdToSymbol.remove(reqId);
-    m_reqIdToTimeframe.remove(reqId);
+
+    if (isBackfill) {
+        finishBackfillRequest(reqId);
+    }
+
+    // Ticker started streaming while the prefetch was pending (its own load was skipped) - top up now
+    auto streamIt = m_streams.constFind(ticker);
+    if (isPrefetch && streamIt != m_streams.constEnd() && streamIt->realTimeBarsReqId != -1) {
+        loadTimeframe(ticker, timeframe);
+    }
 }
 
 void TickerDataManager::onRealTimeBarReceived(int reqId, long time, double open, double high, double low, double close, long volume)
 {
-    // Log first bar for each reqId (for debugging)
-    if (!m_realTimeBarsLogged.value(reqId, false)) {
-        QString mappedTickerKey = m_realTimeBarsReqIdToSymbol.value(reqId, "NOT_FOUND");
-        LOG_DEBUG(QString("First real-time bar received: reqId=%1, mappedTickerKey=%2, currentSymbol=%3, O=%4, H=%5, L=%6, C=%7, V=%8")
-            .arg(reqId).arg(mappedTickerKey).arg(m_currentSymbol)
-            .arg(open).arg(high).arg(low).arg(close).arg(volume));
-        m_realTimeBarsLogged[reqId] = true;
-    }
-
-    // Verify this bar belongs to a known ticker (prevent race condition on ticker switch)
-    if (!m_realTimeBarsReqIdToSymbol.contains(reqId)) {
-        LOG_DEBUG(QString("Ignoring real-time bar from unknown reqId %1 (ticker switched)").arg(reqId));
+    // Verify this bar belongs to a streamed ticker (subscription may have been evicted or removed)
+    RequestRoute route = m_registry.route(reqId);
+    if (route.ticker == INVALID_TICKER || route.kind != RequestKind::RealTimeBars) {
+        LOG_DEBUG(QString("Ignoring real-time bar from unknown reqId %1 (stream cancelled)").arg(reqId));
         return;
     }
 
-    QString tickerKey = m_realTimeBarsReqIdToSymbol[reqId]; // This is now ticker key
+    TickerHandle ticker = route.ticker;
+    auto streamIt = m_streams.find(ticker);
+    auto dataIt = m_tickerData.find(ticker);
+    if (streamIt == m_streams.end() || dataIt == m_tickerData.end()) return;
+    TickerStream& stream = *streamIt;
 
-    // Only process bars from current ticker
-    if (tickerKey != m_currentSymbol) {
-        LOG_DEBUG(QString("Ignoring real-time bar for %1 (current ticker is %2)").arg(tickerKey).arg(m_currentSymbol));
-        return;
+    // Log first bar for each subscription (for debugging)
+    if (!stream.realTimeBarsLogged) {
+        LOG_DEBUG(QString("First real-time bar received: reqId=%1, mappedTickerKey=%2, currentSymbol=%3, O=%4, H=%5, L=%6, C=%7, V=%8")
+            .arg(reqId).arg(m_registry.key(ticker)).arg(m_currentSymbol)
+            .arg(open).arg(high).arg(low).arg(close).arg(volume));
+        stream.realTimeBarsLogged = true;
     }
 
     // Ignore duplicates
-    if (time == m_lastCompletedBarTime) return;
-    m_lastCompletedBarTime = time;
+    if (time == stream.lastCompletedBarTime) return;
+    stream.lastCompletedBarTime = time;
+
+    // First bar after (re)subscribing - check for a hole since last cached bar
+    if (stream.checkGapOnNextBar) {
+        stream.checkGapOnNextBar = false;
+        detectGap(ticker, time);
+    }
 
     CandleBar bar{time, open, high, low, close, volume};
 
-    // Add to 5s cache
-    TickerData& data = m_tickerData[tickerKey];
-    QVector<CandleBar>& s5_bars = data.barsByTimeframe[Timeframe::SEC_5];
-    s5_bars.append(bar);
-    data.lastBarTimestampByTimeframe[Timeframe::SEC_5] = time;
+    // Ticks build the next candle from this close (completed period, replaced on the next tick)
+    if (!stream.hasDynamicBar) {
+        stream.currentDynamicBar = bar;
+        stream.hasDynamicBar = true;
+    }
+
+    // Add to 5s cache (every streamed ticker keeps its 5s series warm)
+    TickerData& data = dataIt.value();
+    const CandleSeries& s5_bars = mergeBar(data, Timeframe::SEC_5, bar, true);
+    data.lastBarTimestampByTimeframe[Timeframe::SEC_5] = s5_bars.last().timestamp;
+    persistBar(ticker, Timeframe::SEC_5, time);
 
     // Emit signal with pure symbol (not ticker key)
     emit barsUpdated(data.symbol, Timeframe::SEC_5);
 
-    // If viewing 5s, done
-    if (m_currentTimeframe == Timeframe::SEC_5) return;
-
-    // Aggregate into larger timeframe (only for current ticker)
-    if (tickerKey != m_currentSymbol) return;
+    // Fold into every coarser timeframe (keeps all timeframes of all streamed tickers live)
+    aggregateRealTimeBar(ticker, stream, bar);
+}
 
-    int barSeconds = timeframeToSeconds(m_currentTimeframe);
-    qint64 barTimestamp = (time / barSeconds) * barSeconds;
+void TickerDataManager::aggregateRealTimeBar(TickerHandle ticker, TickerStream& stream, const CandleBar& bar)
+{
+    for (int i = static_cast<int>(Timeframe::SEC_10); i < TIMEFRAME_COUNT; ++i) {
+        Timeframe timeframe = static_cast<Timeframe>(i);
+        AggregationSlot& slot = stream.aggregation[i];
+        int barSeconds = timeframeToSeconds(timeframe);
+        qint64 barTimestamp = (bar.timestamp / barSeconds) * barSeconds;
+
+        // 5s bar belongs to a new bucket - close the previous one
+        if (slot.active && slot.bar.timestamp != barTimestamp) {
+            finalizeAggregationBar(ticker, timeframe, slot);
+        }
 
-    if (!m_isAggregating || m_aggregationBar.timestamp != barTimestamp) {
-        if (m_isAggregating) {
-            finalizeAggregationBar();
+        if (!slot.active) {
+            slot.bar = bar;
+            slot.bar.timestamp = barTimestamp;
+            slot.active = true;
+            slot.complete = (bar.timestamp == barTimestamp);
+        } else {
+            slot.bar.high = qMax(slot.bar.high, bar.high);
+            slot.bar.low = qMin(slot.bar.low, bar.low);
+            slot.bar.close = bar.close;
+            slot.bar.volume += bar.volume;
         }
-        m_aggregationBar = bar;
-        m_aggregationBar.timestamp = barTimestamp;
-        m_isAggregating = true;
-    } else {
-        m_aggregationBar.high = qMax(m_aggregationBar.high, bar.high);
-        m_aggregationBar.low = qMin(m_aggregationBar.low, bar.low);
-        m_aggregationBar.close = bar.close;
-        m_aggregationBar.volume += bar.volume;
-    }
 
-    // Check if aggregation period complete
-    if ((time + 5) % barSeconds == 0) {
-        finalizeAggregationBar();
+        // Check if aggregation period complete
+        if ((bar.timestamp + 5) % barSeconds == 0) {
+            finalizeAggregationBar(ticker, timeframe, slot);
+        }
     }
 }
 
-void TickerDataManager::onTickByTickUpdate(int reqId, double price, double bid, double ask)
+void TickerDataManager::onTick(const Tick& tick)
 {
-    if (reqId != m_tickByTickReqId) return;
+    const int reqId = tick.reqId;
+    const bool isTrade = tick.isTrade();
+
+    RequestRoute route = m_registry.route(reqId);
+    if (route.ticker == INVALID_TICKER || route.kind != RequestKind::TickByTick) return;
+
+    TickerHandle ticker = route.ticker;
+    auto streamIt = m_streams.find(ticker);
+    auto dataIt = m_tickerData.constFind(ticker);
+    if (streamIt == m_streams.end() || streamIt->tickByTickReqId != reqId || dataIt == m_tickerData.constEnd()) return;
+    TickerStream& stream = *streamIt;
+    bool isCurrent = (ticker == m_currentTicker);
+
+    // Trade prints carry no quote - keep the last one
+    QuoteTradeStream& quotes = stream.quotesAndTrades;
+    if (isTrade) {
+        quotes.addTrade(tick);
+    } else {
+        quotes.addQuote(tick);
+    }
+    const double bid = quotes.bid();
+    const double ask = quotes.ask();
+    const TradePrint* lastTrade = quotes.lastTrade();
+    const double price = lastTrade ? lastTrade->price : 0.0;
 
     // Only use mid price for dynamic candle if we have both bid and ask
     double midPrice = (bid > 0 && ask > 0) ? (bid + ask) / 2.0 : price;
     if (midPrice <= 0) return;
 
-    // Get pure symbol for signal emission
-    QString symbol = m_tickerData.contains(m_currentSymbol) ? m_tickerData[m_currentSymbol].symbol : m_currentSymbol;
+    // Get pure symbol for signal emission (implicitly shared, no copy)
+    QString symbol = dataIt->symbol;
 
-    // Check if this is the first tick for current ticker
+    // Check if this is the first tick for this ticker
     // If so, start loading historical data and subscribe to real-time bars
-    if (m_realTimeBarsReqId == -1) {
-        loadTimeframe(m_currentSymbol, m_currentTimeframe); // Pass ticker key
-        subscribeToRealTimeBars();
+    if (stream.realTimeBarsReqId == -1) {
+        loadTimeframe(ticker, m_currentTimeframe);
+        subscribeToRealTimeBars(ticker, stream);
 
         // Emit signal for first tick (used for Display Group sync, etc.)
-        emit firstTickReceived(symbol); // Emit pure symbol
+        // For background tickers it is emitted by replayLastQuote() once they become current
+        if (isCurrent) {
+            emit firstTickReceived(symbol); // Emit pure symbol
+        }
     }
 
-    qint64 currentTime = QDateTime::currentSecsSinceEpoch();
+    qint64 currentTime = clockSeconds();
     qint64 barTimestamp = (currentTime / 5) * 5; // 5-second boundary
 
     // Track price update for current bar
-    m_lastPriceUpdateTime = currentTime;
-    if (!m_hasPriceUpdateForCurrentBar) {
-        m_hasPriceUpdateForCurrentBar = true;
+    if (!stream.hasPriceUpdateForCurrentBar) {
+        stream.hasPriceUpdateForCurrentBar = true;
         emit priceUpdateReceived(symbol); // Emit pure symbol
     }
 
     // Only update dynamic candle if we already have at least one real-time bar
     // (need to know the close price of previous bar to start new candle correctly)
-    if (m_hasDynamicBar) {
-        if (m_currentDynamicBar.timestamp != barTimestamp) {
+    if (stream.hasDynamicBar) {
+        CandleBar& dynamicBar = stream.currentDynamicBar;
+        if (dynamicBar.timestamp != barTimestamp) {
             // Start new dynamic candle with close of previous
-            double startPrice = m_currentDynamicBar.close;
-            m_currentDynamicBar = {barTimestamp, startPrice, startPrice, startPrice, startPrice, 0};
+            double startPrice = dynamicBar.close;
+            dynamicBar = {barTimestamp, startPrice, startPrice, startPrice, startPrice, 0};
         }
 
         // Update with new tick
-        m_currentDynamicBar.high = qMax(m_currentDynamicBar.high, midPrice);
-        m_currentDynamicBar.low = qMin(m_currentDynamicBar.low, midPrice);
-        m_currentDynamicBar.close = midPrice;
+        dynamicBar.high = qMax(dynamicBar.high, midPrice);
+        dynamicBar.low = qMin(dynamicBar.low, midPrice);
+        dynamicBar.close = midPrice;
+        if (isTrade) {
+            dynamicBar.volume += qRound64(tick.size);
+        }
 
-        // Emit for chart update (NOT added to cache!)
-        emit currentBarUpdated(symbol, m_currentDynamicBar); // Emit pure symbol
+        // Emit for chart update (NOT added to cache!) - the chart only shows the current ticker
+        if (isCurrent) {
+            emit currentBarUpdated(symbol, m_currentTimeframe, liveBar(ticker, stream)); // Emit pure symbol
+        }
     }
 
     // Calculate price for ticker list (use last trade price, fallback to mid-price)
     double displayPrice = (price > 0) ? price : midPrice;
 
-    // Calculate change percent from previous bar
-    double changePercent = 0.0;
-    const QVector<CandleBar>* bars = getBars(m_currentSymbol, m_currentTimeframe); // Pass ticker key
-    if (bars && bars->size() >= 2) {
-        // Compare with previous bar's close (1 bar ago for 10s = 10 seconds ago)
-        double oldPrice = (*bars)[bars->size() - 2].close;
-        if (oldPrice > 0) {
-            changePercent = ((displayPrice - oldPrice) / oldPrice) * 100.0;
+    // Remember last quote for instant replay when switching back to this ticker
+    stream.lastTickReqId = reqId;
+    stream.lastPrice = displayPrice;
+    stream.bid = bid;
+    stream.ask = ask;
+    stream.mid = midPrice;
+    stream.hasQuote = true;
+
+    // Current ticker drives order panel and price lines (immediate!), the others only the
+    // ticker list: a queued signal per tick of every streamed ticker would flood the GUI thread
+    if (isCurrent) {
+        m_pendingPrices.remove(ticker);
+        emit currentTickUpdated(reqId, price, bid, ask);
+        emit priceUpdated(symbol, displayPrice, calculateChangePercent(*dataIt, displayPrice), bid, ask, midPrice); // Emit pure symbol
+    } else {
+        m_pendingPrices.insert(ticker);
+        if (!m_priceFlushTimer->isActive()) {
+            m_priceFlushTimer->start();
         }
     }
+}
 
-    // Emit price update for ticker list and price lines (immediate!)
-    emit priceUpdated(symbol, displayPrice, changePercent, bid, ask, midPrice); // Emit pure symbol
+void TickerDataManager::flushBackgroundPrices()
+{
+    for (TickerHandle ticker : m_pendingPrices) {
+        auto streamIt = m_streams.constFind(ticker);
+        auto dataIt = m_tickerData.constFind(ticker);
+        if (streamIt == m_streams.constEnd() || !streamIt->hasQuote || dataIt == m_tickerData.constEnd()) continue;
+
+        const TickerStream& stream = *streamIt;
+        emit priceUpdated(dataIt->symbol, stream.lastPrice, calculateChangePercent(*dataIt, stream.lastPrice),
+                          stream.bid, stream.ask, stream.mid);
+    }
+    m_pendingPrices.clear();
 }
 
-void TickerDataManager::onCandleBoundaryCheck()
+const QuoteTradeStream* TickerDataManager::quotesAndTrades(const QString& tickerKey) const
 {
-    if (m_currentSymbol.isEmpty() || !m_hasDynamicBar) return;
+    auto it = m_streams.constFind(m_registry.find(tickerKey));
+    return it != m_streams.constEnd() ? &it->quotesAndTrades : nullptr;
+}
 
-    qint64 currentTime = QDateTime::currentSecsSinceEpoch();
+CandleBar TickerDataManager::liveBar(TickerHandle ticker, const TickerStream& stream) const
+{
+    const CandleBar& dynamicBar = stream.currentDynamicBar;
+    if (m_currentTimeframe == Timeframe::SEC_5) {
+        return dynamicBar;
+    }
+
+    // Coarser timeframe: completed 5s bars of this bucket plus the one being built
+    int barSeconds = timeframeToSeconds(m_currentTimeframe);
+    CandleBar bar = dynamicBar;
+    bar.timestamp = (dynamicBar.timestamp / barSeconds) * barSeconds;
+
+    CandleBar earlier;
+    bool hasEarlier = false;
+    const AggregationSlot& slot = stream.aggregation[static_cast<int>(m_currentTimeframe)];
+    if (slot.active && slot.bar.timestamp == bar.timestamp) {
+        earlier = slot.bar;
+        hasEarlier = true;
+    } else {
+        // Bucket started before streaming (history) - continue the cached bar
+        auto dataIt = m_tickerData.constFind(ticker);
+        if (dataIt != m_tickerData.constEnd()) {
+            auto seriesIt = dataIt->barsByTimeframe.constFind(m_currentTimeframe);
+            if (seriesIt != dataIt->barsByTimeframe.constEnd() && !seriesIt->isEmpty()
+                && seriesIt->last().timestamp == bar.timestamp) {
+                earlier = seriesIt->last();
+                hasEarlier = true;
+            }
+        }
+    }
+
+    if (hasEarlier) {
+        bar.open = earlier.open;
+        bar.high = qMax(earlier.high, dynamicBar.high);
+        bar.low = qMin(earlier.low, dynamicBar.low);
+        bar.volume += earlier.volume;
+    }
+    return bar;
+}
+
+void TickerDataManager::onCandleBoundaryCheck()
+{
+    qint64 currentTime = clockSeconds();
     qint64 currentBoundary = (currentTime / 5) * 5;
 
-    // Get pure symbol for signal emission
-    QString symbol = m_tickerData.contains(m_currentSymbol) ? m_tickerData[m_currentSymbol].symbol : m_currentSymbol;
+    for (auto it = m_streams.begin(); it != m_streams.end(); ++it) {
+        TickerStream& stream = it.value();
+        if (!stream.hasDynamicBar) continue;
 
-    // If dynamic bar is from previous period, start new one
-    if (m_currentDynamicBar.timestamp < currentBoundary) {
-        // Check if previous bar had any price updates
-        if (m_currentBarStartTime > 0 && !m_hasPriceUpdateForCurrentBar) {
-            emit noPriceUpdate(symbol); // Emit pure symbol
-        }
+        // If dynamic bar is from previous period, start new one
+        if (stream.currentDynamicBar.timestamp < currentBoundary) {
+            // Get pure symbol for signal emission
+            QString symbol = pureSymbol(it.key());
 
-        // Start new bar with close of previous
-        double startPrice = m_currentDynamicBar.close;
-        m_currentDynamicBar = {currentBoundary, startPrice, startPrice, startPrice, startPrice, 0};
-        m_currentBarStartTime = currentBoundary;
-        m_hasPriceUpdateForCurrentBar = false; // Reset for new bar
-        emit currentBarUpdated(symbol, m_currentDynamicBar); // Emit pure symbol
+            // Check if previous bar had any price updates
+            if (stream.currentBarStartTime > 0 && !stream.hasPriceUpdateForCurrentBar) {
+                emit noPriceUpdate(symbol); // Emit pure symbol
+            }
+
+            // Start new bar with close of previous
+            double startPrice = stream.currentDynamicBar.close;
+            stream.currentDynamicBar = {currentBoundary, startPrice, startPrice, startPrice, startPrice, 0};
+            stream.currentBarStartTime = currentBoundary;
+            stream.hasPriceUpdateForCurrentBar = false; // Reset for new bar
+            if (it.key() == m_currentTicker) {
+                emit currentBarUpdated(symbol, m_currentTimeframe, liveBar(it.key(), stream)); // Emit pure symbol
+            }
+        }
     }
 }
 
-void TickerDataManager::finalizeAggregationBar()
+void TickerDataManager::finalizeAggregationBar(TickerHandle ticker, Timeframe timeframe, AggregationSlot& slot)
 {
-    if (!m_isAggregating) return;
-    TickerData& data = m_tickerData[m_currentSymbol]; // m_currentSymbol is now ticker key
-    QVector<CandleBar>& bars = data.barsByTimeframe[m_currentTimeframe];
-    bars.append(m_aggregationBar);
-    data.lastBarTimestampByTimeframe[m_currentTimeframe] = m_aggregationBar.timestamp;
-    emit barsUpdated(data.symbol, m_currentTimeframe); // Emit pure symbol
-    m_isAggregating = false;
+    if (!slot.active) return;
+    slot.active = false;
+
+    auto dataIt = m_tickerData.find(ticker);
+    if (dataIt == m_tickerData.end()) return;
+
+    TickerData& data = dataIt.value();
+
+    // Bucket joined mid-way: rebuild it from 5s bars if they cover it from the start (history or backfill)
+    if (!slot.complete) {
+        auto s5It = data.barsByTimeframe.constFind(Timeframe::SEC_5);
+        if (s5It != data.barsByTimeframe.constEnd()) {
+            CandleView s5 = s5It->view();
+            int first = s5.lowerBound(slot.bar.timestamp);
+            if (first < s5.size() && s5.timestamp(first) == slot.bar.timestamp) {
+                QVector<CandleBar> rebuilt = resampleBars(s5.mid(first), timeframeToSeconds(timeframe), slot.bar.timestamp);
+                slot.bar = rebuilt.first();
+                slot.complete = true;
+            }
+        }
+    }
+
+    // A bucket we joined mid-way must not overwrite a full historical bar
+    const CandleSeries& bars = mergeBar(data, timeframe, slot.bar, slot.complete);
+    data.lastBarTimestampByTimeframe[timeframe] = bars.last().timestamp;
+    if (slot.complete) {
+        persistBar(ticker, timeframe, slot.bar.timestamp);
+    }
+    emit barsUpdated(data.symbol, timeframe); // Emit pure symbol
 }
 
-void TickerDataManager::requestHistoricalBars(const QString& symbol, int reqId, Timeframe timeframe)
+int TickerDataManager::historyWindowSeconds(Timeframe timeframe)
 {
     int barSeconds = timeframeToSeconds(timeframe);
     int durationSeconds = barSeconds * 500; // Request 500 bars
@@ -539,28 +1274,185 @@ void TickerDataManager::requestHistoricalBars(const QString& symbol, int reqId,
     if (timeframe == Timeframe::SEC_10 && durationSeconds > 7200) {
         durationSeconds = 7200;
     }
-    QString duration = QString("%1 S").arg(durationSeconds);
-    QString barSize = timeframeToBarSize(timeframe);
-    LOG_DEBUG(QString("Requesting historical data for %1: duration=%2, barSize=%3").arg(symbol).arg(duration).arg(barSize));
-    m_client->requestHistoricalData(reqId, symbol, "", duration, barSize);
+    return durationSeconds;
 }
 
-void TickerDataManager::requestMissingBars(const QString& symbol, qint64 fromTime, qint64 toTime)
+qint64 TickerDataManager::extendedSessionStart(qint64 timestamp)
+{
+    // US/Eastern with DST, like TradingManager's trading hours
+    QTimeZone estTz("America/New_York");
+    QDateTime est = QDateTime::fromSecsSinceEpoch(timestamp, estTz);
+    int dayOfWeek = est.date().dayOfWeek();
+    if (dayOfWeek > 5 || est.time() < QTime(4, 0) || est.time() >= QTime(20, 0)) {
+        return -1;
+    }
+    return QDateTime(est.date(), QTime(4, 0), estTz).toSecsSinceEpoch();
+}
+
+int TickerDataManager::requestHistoricalBars(TickerHandle ticker, Timeframe timeframe, HistoricalRequestPriority priority,
+                                             HistoricalRequestPurpose purpose)
+{
+    int durationSeconds = historyWindowSeconds(timeframe);
+    LOG_DEBUG(QString("Requesting historical data for %1: duration=%2 S, barSize=%3").arg(pureSymbol(ticker)).arg(durationSeconds).arg(timeframeToBarSize(timeframe)));
+    return submitHistoricalRequest(ticker, timeframe, "", durationSeconds, priority, purpose);
+}
+
+int TickerDataManager::requestMissingBars(TickerHandle ticker, Timeframe timeframe, qint64 fromTime, qint64 toTime, HistoricalRequestPriority priority,
+                                          HistoricalRequestPurpose purpose)
 {
-    if (!m_client || !m_client->isConnected()) return;
-    int reqId = m_nextReqId++;
-    m_reqIdToSymbol[reqId] = symbol;
-    m_reqIdToTimeframe[reqId] = m_currentTimeframe;
     qint64 durationSeconds = toTime - fromTime;
 
     // TWS does not allow historical data requests for more than 86400 seconds (24 hours)
-    durationSeconds = qMin(durationSeconds, 86400);
+    durationSeconds = qMin<qint64>(durationSeconds, 86400);
 
-    QString duration = QString("%1 S").arg(durationSeconds);
     QString endTimeStr = QDateTime::fromSecsSinceEpoch(toTime, QTimeZone("UTC")).toString("yyyyMMdd-HH:mm:ss");
-    QString barSize = timeframeToBarSize(m_currentTimeframe);
-    LOG_DEBUG(QString("Requesting missing bars for %1: from=%2 to=%3").arg(symbol).arg(fromTime).arg(toTime));
-    m_client->requestHistoricalData(reqId, symbol, endTimeStr, duration, barSize);
+    LOG_DEBUG(QString("Requesting missing bars for %1 [%2]: from=%3 to=%4").arg(pureSymbol(ticker)).arg(timeframeToString(timeframe)).arg(fromTime).arg(toTime));
+    return submitHistoricalRequest(ticker, timeframe, endTimeStr, static_cast<int>(durationSeconds), priority, purpose);
+}
+
+int TickerDataManager::submitHistoricalRequest(TickerHandle ticker, Timeframe timeframe, const QString& endDateTime, int durationSeconds,
+                                               HistoricalRequestPriority priority, HistoricalRequestPurpose purpose)
+{
+    HistoricalRequest request;
+    request.owner = m_registry.key(ticker);
+    request.symbol = pureSymbol(ticker); // TWS API gets pure symbol
+    request.endDateTime = endDateTime;
+    request.duration = QString("%1 S").arg(durationSeconds);
+    request.barSize = timeframeToBarSize(timeframe);
+    request.priority = priority;
+    request.purpose = purpose;
+
+    int reqId = m_nextReqId++;
+    int queuedReqId = m_historyScheduler->submit(reqId, request);
+    if (queuedReqId == reqId) {
+        m_registry.addRoute(reqId, ticker, RequestKind::Historical, static_cast<int>(timeframe));
+    }
+    return queuedReqId; // Coalesced requests (same ticker, same purpose) are already routed
+}
+
+void TickerDataManager::dropHistoricalRequest(int reqId)
+{
+    m_registry.removeRoute(reqId);
+    m_pendingHistoricalBars.remove(reqId);
+    m_prefetchRequests.remove(reqId);
+}
+
+void TickerDataManager::onHistoricalRequestFailed(int reqId, int code, const QString& message)
+{
+    RequestRoute route = m_registry.route(reqId);
+    if (route.ticker == INVALID_TICKER) return;
+
+    // 162 is any HMDS error - only "query returned no data" (e.g. market closed for the whole
+    // range) is an empty answer; others (no permissions, ...) leave the timeframe unloaded
+    if (code == 162 && message.contains("returned no data", Qt::CaseInsensitive)) {
+        onHistoricalDataFinished(reqId);
+        return;
+    }
+
+    LOG_WARNING(QString("Historical request %1 for %2 failed [code=%3]: %4").arg(reqId).arg(m_registry.key(route.ticker)).arg(code).arg(message));
+    dropHistoricalRequest(reqId);
+    if (m_backfillRequests.contains(reqId)) {
+        finishBackfillRequest(reqId);
+    }
+}
+
+void TickerDataManager::detectGap(TickerHandle ticker, qint64 firstBarTime)
+{
+    TickerData& data = m_tickerData[ticker];
+    qint64 lastBarTime = data.lastBarTimestampByTimeframe.value(Timeframe::SEC_5, 0);
+    if (lastBarTime <= 0 || firstBarTime - lastBarTime <= 5) return;
+    if (data.barsByTimeframe.value(Timeframe::SEC_5).isEmpty()) return;
+
+    // Only the part within the current extended-hours session (04:00 ET on) can be
+    // missing - nothing trades overnight or over the weekend
+    qint64 sessionStart = extendedSessionStart(firstBarTime);
+    qint64 fromTime = qMax(lastBarTime + 5, sessionStart);
+    if (sessionStart < 0 || firstBarTime - fromTime < 5) return;
+
+    GapBackfill gap;
+    gap.ticker = ticker;
+    gap.fromTime = fromTime;
+    gap.toTime = firstBarTime;
+    int gapId = m_nextGapId++;
+
+    // 5s history only reaches back a short window - older part of a long gap is filled per timeframe
+    qint64 fiveSecFrom = qMax(gap.fromTime, gap.toTime - historyWindowSeconds(Timeframe::SEC_5));
+    QList<BackfillRequest> requests;
+    requests.append({gapId, Timeframe::SEC_5, fiveSecFrom, gap.toTime});
+
+    qint64 firstFiveSecBar = data.barsByTimeframe[Timeframe::SEC_5].first().timestamp;
+    for (int i = static_cast<int>(Timeframe::SEC_10); i < TIMEFRAME_COUNT; ++i) {
+        Timeframe timeframe = static_cast<Timeframe>(i);
+        if (!data.isLoadedByTimeframe.value(timeframe, false)) continue; // Fetched in full when viewed
+
+        int barSeconds = timeframeToSeconds(timeframe);
+        qint64 bucketFrom = (gap.fromTime / barSeconds) * barSeconds;
+        if (fiveSecFrom == gap.fromTime && firstFiveSecBar <= bucketFrom) {
+            // Whole affected range is covered by 5s bars - derive instead of spending a request
+            gap.derivedTimeframes.append(timeframe);
+        } else {
+            qint64 from = qMax(bucketFrom, gap.toTime - historyWindowSeconds(timeframe));
+            requests.append({gapId, timeframe, from, gap.toTime});
+        }
+    }
+
+    gap.pendingRequests = requests.size();
+    m_gaps[gapId] = gap;
+    m_gapsFound++;
+    LOG_INFO(QString("Gap detected for %1: %2s missing (from %3 to %4), %5 backfill request(s) queued")
+        .arg(m_registry.key(ticker)).arg(gap.toTime - gap.fromTime).arg(gap.fromTime).arg(gap.toTime).arg(gap.pendingRequests));
+
+    // Low priority - chart loads of the displayed ticker go first
+    for (const BackfillRequest& request : requests) {
+        int reqId = requestMissingBars(ticker, request.timeframe, request.fromTime, request.toTime, HistoricalRequestPriority::Low,
+                                       HistoricalRequestPurpose::Backfill);
+        if (m_backfillRequests.contains(reqId)) {
+            m_gaps[gapId].pendingRequests--; // Coalesced with an identical backfill
+            continue;
+        }
+        m_backfillRequests[reqId] = request;
+    }
+}
+
+void TickerDataManager::finishBackfillRequest(int reqId)
+{
+    BackfillRequest request = m_backfillRequests.take(reqId);
+    auto gapIt = m_gaps.find(request.gapId);
+    if (gapIt == m_gaps.end()) return;
+    GapBackfill& gap = gapIt.value();
+
+    // Rebuild coarser timeframes from the freshly backfilled 5s bars
+    auto dataIt = m_tickerData.find(gap.ticker);
+    if (request.timeframe == Timeframe::SEC_5 && dataIt != m_tickerData.end() && !gap.derivedTimeframes.isEmpty()) {
+        TickerData& data = dataIt.value();
+        CandleView s5 = data.barsByTimeframe[Timeframe::SEC_5].view();
+        qint64 closedUntil = s5.isEmpty() ? 0 : s5.timestamp(s5.size() - 1) + 5;
+
+        for (Timeframe timeframe : gap.derivedTimeframes) {
+            int barSeconds = timeframeToSeconds(timeframe);
+            qint64 bucketFrom = (gap.fromTime / barSeconds) * barSeconds;
+            QVector<CandleBar> rebuilt = resampleBars(s5, barSeconds, bucketFrom);
+
+            // In-progress bucket stays with the live aggregation slot
+            while (!rebuilt.isEmpty() && rebuilt.last().timestamp + barSeconds > closedUntil) {
+                rebuilt.removeLast();
+            }
+            if (rebuilt.isEmpty()) continue;
+
+            const CandleSeries& bars = mergeBars(data, timeframe, rebuilt, true);
+            data.lastBarTimestampByTimeframe[timeframe] = bars.last().timestamp;
+            persistSeries(gap.ticker, timeframe);
+            emit barsUpdated(data.symbol, timeframe);
+        }
+    }
+
+    if (--gap.pendingRequests <= 0) {
+        m_gapsFilled++;
+        QString tickerKey = m_registry.contains(gap.ticker) ? m_registry.key(gap.ticker) : QString();
+        LOG_INFO(QString("Gap filled for %1 (from %2 to %3), gaps found/filled: %4/%5")
+            .arg(tickerKey).arg(gap.fromTime).arg(gap.toTime).arg(m_gapsFound).arg(m_gapsFilled));
+        m_gaps.erase(gapIt);
+    }
 }
 
 void TickerDataManager::onContractDetailsReceived(int reqId, const QString& symbol, const QString& exchange, int conId)
@@ -585,6 +1477,7 @@ void TickerDataManager::onContractDetailsReceived(int reqId, const QString& symb
             m_symbolToContractId[symbol] = conId;
             // Also store in tickerKey map
             QString tickerKey = makeTickerKey(symbol, exchange);
+            QWriteLocker locker(&m_snapshotLock);
             m_tickerKeyToContractId[tickerKey] = conId;
             wasStored = true;
         } else {
@@ -598,6 +1491,7 @@ void TickerDataManager::onContractDetailsReceived(int reqId, const QString& symb
         m_symbolToContractId[symbol] = conId;
         // Also store in tickerKey map
         QString tickerKey = makeTickerKey(symbol, exchange);
+        QWriteLocker locker(&m_snapshotLock);
         m_tickerKeyToContractId[tickerKey] = conId;
         wasStored = true;
     }
@@ -640,7 +1534,19 @@ void TickerDataManager::onContractSearchFinished(int reqId)
 
 void TickerDataManager::onReconnected()
 {
-    // Clear all logging trackers on reconnect
-    m_realTimeBarsLogged.clear();
-    subscribeToCurrentTicker();
+    // TWS drops all market data subscriptions on disconnect - resubscribe whole pool with fresh reqIds
+    m_registry.clearRoutes(RequestKind::TickByTick);
+    m_registry.clearRoutes(RequestKind::RealTimeBars);
+    m_tickByTickBudget = m_tickByTickLimit;
+    for (auto it = m_streams.begin(); it != m_streams.end(); ++it) {
+        it->tickByTickReqId = -1;
+        it->tradesReqId = -1;
+        it->realTimeBarsReqId = -1;
+        subscribeToTickByTick(it.key(), it.value());
+        subscribeToRealTimeBars(it.key(), it.value());
+    }
+    rebalanceTradeStreams();
+
+    // Historical requests cut off by the disconnect are re-sent by the scheduler (same reqIds) - drop partial bars
+    m_pendingHistoricalBars.clear();
 }
@@ -3,9 +3,18 @@
 
 #include <QObject>
 #include <QMap>
+#include <QHash>
+#include <QSet>
 #include <QVector>
 #include <QTimer>
 #include <QDateTime>
+#include <QReadWriteLock>
+#include "models/candleseries.h"
+#include "models/barcache.h"
+#include "models/tickerregistry.h"
+#include "models/quotetradestream.h"
+#include "client/historicalrequestscheduler.h"
+#include "client/tickpipeline.h"
 
 class IBKRClient;
 
@@ -23,6 +32,8 @@ enum class Timeframe {
 
 Q_DECLARE_METATYPE(Timeframe)
 
+const int TIMEFRAME_COUNT = static_cast<int>(Timeframe::HOUR_1) + 1; // Number of Timeframe values (for per-timeframe arrays)
+
 // Helper functions
 QString timeframeToString(Timeframe tf);
 QString timeframeToBarSize(Timeframe tf);
@@ -30,28 +41,32 @@ int timeframeToSeconds(Timeframe tf);
 QString makeTickerKey(const QString& symbol, const QString& exchange);
 QPair<QString, QString> parseTickerKey(const QString& tickerKey); // Returns (symbol, exchange)
 
-struct CandleBar {
-    qint64 timestamp;
-    double open, high, low, close;
-    qint64 volume;
-    CandleBar() : timestamp(0), open(0), high(0), low(0), close(0), volume(0) {}
-    CandleBar(qint64 ts, double o, double h, double l, double c, qint64 v) : timestamp(ts), open(o), high(h), low(l), close(c), volume(v) {}
-};
+// Build coarser bars from a sorted finer series, starting at fromTimestamp
+// (targetSeconds must be a multiple of the source bar size)
+QVector<CandleBar> resampleBars(const CandleView& bars, int targetSeconds, qint64 fromTimestamp = 0);
 
 struct TickerData {
     QString symbol;
     QString exchange;
     int conId;
-    QMap<Timeframe, QVector<CandleBar>> barsByTimeframe;
+    QMap<Timeframe, CandleSeries> barsByTimeframe; // Ring buffers sized by bar retention
     QMap<Timeframe, bool> isLoadedByTimeframe;
     QMap<Timeframe, qint64> lastBarTimestampByTimeframe;
+    QMap<Timeframe, qint64> persistedUntilByTimeframe; // Last bar restored from disk cache (top-up starts here)
 
     TickerData() : conId(0) {}
     TickerData(const QString& sym, const QString& exch = QString(), int contractId = 0)
         : symbol(sym), exchange(exch), conId(contractId) {}
 };
 
-class TickerDataManager : public QObject
+/**
+ * @brief Market data state of all tickers (bars, streams, history requests)
+ *
+ * Lives on the engine thread (see EngineThread). Widgets call it through queued
+ * invocations and read bars only via barsSnapshot(); getContractId() is also
+ * safe from any thread. All other getters are for the engine thread.
+ */
+class TickerDataManager : public QObject, public TickConsumer
 {
     Q_OBJECT
 
@@ -62,7 +77,8 @@ public:
     void activateTicker(const QString& symbol, const QString& exchange = QString());
     void removeTicker(const QString& symbol, const QString& exchange = QString());
     void loadTimeframe(const QString& tickerKey, Timeframe timeframe);
-    const QVector<CandleBar>* getBars(const QString& tickerKey, Timeframe timeframe) const;
+    CandleView getBars(const QString& tickerKey, Timeframe timeframe) const; // Empty view if nothing cached (engine thread)
+    CandleSeries barsSnapshot(const QString& tickerKey, Timeframe timeframe) const; // Copy for other threads, empty if nothing cached
     bool isLoaded(const QString& tickerKey, Timeframe timeframe) const;
     void setCurrentSymbol(const QString& tickerKey);
     void setCurrentTimeframe(Timeframe timeframe);
@@ -75,44 +91,186 @@ public:
     void setExpectedExchange(const QString& symbol, const QString& exchange);
     void setContractId(const QString& symbol, const QString& exchange, int conId);
 
+    // Streaming pool: recently used tickers keep their tick-by-tick and real-time bar
+    // subscriptions alive, so switching back to them is instant (LRU eviction over the limit)
+    void setMaxStreamingTickers(int count);
+    int maxStreamingTickers() const { return m_maxStreamingTickers; }
+    bool isStreaming(const QString& tickerKey) const { return m_streams.contains(m_registry.find(tickerKey)); }
+
+    // Trade prints ("Last" / "AllLast", empty = quotes only) next to the quote streams, within
+    // limit tick-by-tick subscriptions in total: quotes of the pool first (one slot kept for
+    // trades), then trades of the current ticker and of the most recently used ones
+    void setTickByTickMode(const QString& tradeTickType, int limit);
+    QString tradeTickType() const { return m_tradeTickType; }
+    int tickByTickSubscriptions() const; // Quote + trade streams open now
+
+    // How many hours of bars each timeframe keeps in memory (at least one historical request worth)
+    void setBarRetentionHours(int hours);
+    int barRetentionHours() const { return m_barRetentionHours; }
+
+    // Holes in the 5s series detected after resubscribing (reconnect, ticker back in pool)
+    int gapsFound() const { return m_gapsFound; }
+    int gapsFilled() const { return m_gapsFilled; }
+
+    HistoricalRequestScheduler* historyScheduler() const { return m_historyScheduler; }
+
+    // Replays (feed_bench) run on the feed's clock instead of the wall clock; 0 = wall clock
+    void setSimulatedTime(qint64 secsSinceEpoch) { m_simulatedTime = secsSinceEpoch; }
+
+    // Warm up bars of watchlist tickers (current timeframe) in the background, behind interactive requests
+    void prefetchTickers(const QList<QPair<QString, QString>>& tickers); // (symbol, exchange) pairs
+
+    // Tick-by-tick of every streamed ticker (consumer of the client's tick pipeline)
+    void onTick(const Tick& tick) override;
+
+    // Quote sizes and recent trades of a streamed ticker, nullptr if not streaming (engine thread)
+    const QuoteTradeStream* quotesAndTrades(const QString& tickerKey) const;
+
 signals:
     void tickerDataLoaded(const QString& symbol);
     void tickerActivated(const QString& symbol, const QString& exchange); // Emitted when ticker is ready (UI should update)
-    void priceUpdated(const QString& symbol, double price, double changePercent, double bid, double ask, double mid); // For ticker list and price lines
+    void priceUpdated(const QString& symbol, double price, double changePercent, double bid, double ask, double mid); // Every tick of the current ticker, others coalesced (ticker list, price lines)
     void barsUpdated(const QString& symbol, Timeframe timeframe);
-    void currentBarUpdated(const QString& symbol, const CandleBar& bar); // For live tick updates (not in cache)
+    void currentBarUpdated(const QString& symbol, Timeframe timeframe, const CandleBar& bar); // Live candle of the current ticker (not in cache), current timeframe
     void noPriceUpdate(const QString& symbol); // Emitted when no price update received for previous bar
     void priceUpdateReceived(const QString& symbol); // Emitted when price update received for current bar
     void firstTickReceived(const QString& symbol); // Emitted once when first tick is received for a symbol
+    void currentTickUpdated(int reqId, double price, double bid, double ask); // Ticks of the current ticker only (order panel)
+    void tradingSymbolChanged(const QString& symbol, const QString& exchange); // Right after the tick focus moved (engine thread, connect directly)
 
 private slots:
     void onHistoricalBarReceived(int reqId, long time, double open, double high, double low, double close, long volume);
     void onHistoricalDataFinished(int reqId);
     void onRealTimeBarReceived(int reqId, long time, double open, double high, double low, double close, long volume);
-    void onTickByTickUpdate(int reqId, double price, double bid, double ask);
     void onContractDetailsReceived(int reqId, const QString& symbol, const QString& exchange, int conId);
     void onContractSearchFinished(int reqId); // Called when contract details search is complete
     void onCandleBoundaryCheck(); // Timer to detect new candle start
     void onReconnected();
+    void onHistoricalRequestFailed(int reqId, int code, const QString& message);
+    void onStreamError(int reqId, int code, const QString& message);
+    void flushBackgroundPrices(); // One priceUpdated per background ticker that ticked since the last flush
 
 private:
-    void subscribeToCurrentTicker();
-    void subscribeToTickByTick();
-    void subscribeToRealTimeBars();
-    void unsubscribeFromCurrentTicker();
-    void requestHistoricalBars(const QString& symbol, int reqId, Timeframe timeframe);
-    void requestMissingBars(const QString& symbol, qint64 fromTime, qint64 toTime);
-    void finalizeAggregationBar();
+    // Coarser-timeframe bar being built from 5s real-time bars
+    struct AggregationSlot {
+        CandleBar bar;
+        bool active = false;
+        bool complete = false; // Started on the bucket boundary (no 5s bars missing at the front)
+    };
+
+    // Per-ticker streaming state (one entry per ticker in the pool)
+    struct TickerStream {
+        int tickByTickReqId = -1;
+        int tradesReqId = -1; // Trade prints, merged into tickByTickReqId by the tick pipeline
+        int realTimeBarsReqId = -1;
+        quint64 lastUsed = 0; // LRU stamp, bumped every time the ticker becomes current
+        bool realTimeBarsLogged = false;
+
+        // Quote sizes and trade prints of this subscription
+        QuoteTradeStream quotesAndTrades;
+
+        // Last quote (replayed immediately when switching back to this ticker)
+        int lastTickReqId = -1;
+        double lastPrice = 0.0;
+        double bid = 0.0;
+        double ask = 0.0;
+        double mid = 0.0;
+        bool hasQuote = false;
+
+        // For building current dynamic candle from ticks (not in cache): OHLC from
+        // the mid price, volume from trade prints; started by the first real-time bar
+        CandleBar currentDynamicBar;
+        bool hasDynamicBar = false;
+        qint64 lastCompletedBarTime = 0; // Track last completed bar to avoid duplicates
+        bool checkGapOnNextBar = false; // First real-time bar after reconnect / pool re-entry is compared with cache
+
+        // For tracking price updates per candle (for tray blinking)
+        qint64 currentBarStartTime = 0;
+        bool hasPriceUpdateForCurrentBar = false;
+
+        // Every 5s bar is folded into all coarser timeframes at once (indexed by Timeframe)
+        AggregationSlot aggregation[TIMEFRAME_COUNT];
+    };
+
+    // Gap backfill: one detected hole, filled by one or more historical requests
+    struct GapBackfill {
+        TickerHandle ticker = INVALID_TICKER;
+        qint64 fromTime = 0;
+        qint64 toTime = 0;
+        int pendingRequests = 0;
+        QList<Timeframe> derivedTimeframes; // Rebuilt from backfilled 5s bars instead of own requests
+    };
+
+    struct BackfillRequest {
+        int gapId = 0;
+        Timeframe timeframe = Timeframe::SEC_5;
+        qint64 fromTime = 0;
+        qint64 toTime = 0;
+    };
+
+    void detectGap(TickerHandle ticker, qint64 firstBarTime);
+    void finishBackfillRequest(int reqId);
+
+    // Internally tickers are addressed by registry handle, public API takes ticker keys
+    TickerHandle addTickerData(const QString& tickerKey, const QString& symbol, const QString& exchange);
+    void loadTimeframe(TickerHandle ticker, Timeframe timeframe);
+    void setCurrentTicker(TickerHandle ticker);
+    void acquireStream(TickerHandle ticker); // Subscribe (evicting LRU if full) or bump existing
+    bool evictLeastRecentlyUsedStream();
+    void cancelStream(TickerHandle ticker);
+    void subscribeToTickByTick(TickerHandle ticker, TickerStream& stream);
+    void subscribeToRealTimeBars(TickerHandle ticker, TickerStream& stream);
+    void subscribeToTrades(TickerHandle ticker, TickerStream& stream);
+    void cancelTrades(TickerStream& stream);
+    void rebalanceTradeStreams(); // Hands the budget left after quotes to trade streams by recency
+    int streamCapacity() const;   // Tickers the pool may hold
+    void replayLastQuote(TickerHandle ticker);
+    void updateTickFocus(); // Points the pipeline's focus consumers (trading) at the current ticker's stream
+    double calculateChangePercent(const TickerData& data, double price) const;
+    QString pureSymbol(TickerHandle ticker) const;
+    CandleSeries& seriesFor(TickerData& data, Timeframe timeframe); // Creates ring buffer with retention capacity
+    // Series are only modified through these (under the snapshot lock)
+    const CandleSeries& mergeBars(TickerData& data, Timeframe timeframe, const QVector<CandleBar>& bars, bool replaceExisting);
+    const CandleSeries& mergeBar(TickerData& data, Timeframe timeframe, const CandleBar& bar, bool replaceExisting);
+    void restoreFromDisk(TickerHandle ticker);
+    void persistBar(TickerHandle ticker, Timeframe timeframe, qint64 timestamp);
+    void persistSeries(TickerHandle ticker, Timeframe timeframe);
+    int seriesCapacity(Timeframe timeframe) const;
+
+    // History requests go through the scheduler, all return the reqId bars will arrive with
+    int requestHistoricalBars(TickerHandle ticker, Timeframe timeframe, HistoricalRequestPriority priority,
+                              HistoricalRequestPurpose purpose = HistoricalRequestPurpose::Load);
+    int requestMissingBars(TickerHandle ticker, Timeframe timeframe, qint64 fromTime, qint64 toTime, HistoricalRequestPriority priority,
+                           HistoricalRequestPurpose purpose = HistoricalRequestPurpose::Load);
+    int submitHistoricalRequest(TickerHandle ticker, Timeframe timeframe, const QString& endDateTime, int durationSeconds,
+                                HistoricalRequestPriority priority, HistoricalRequestPurpose purpose);
+    bool isLoadPending(TickerHandle ticker, Timeframe timeframe) const; // Chart load (not backfill) queued or in flight
+    void dropHistoricalRequest(int reqId);
+    qint64 resampleFromCache(TickerHandle ticker, Timeframe timeframe); // Returns start of local coverage, -1 if none
+    static int historyWindowSeconds(Timeframe timeframe);
+    qint64 clockSeconds() const { return m_simulatedTime > 0 ? m_simulatedTime : QDateTime::currentSecsSinceEpoch(); }
+    static qint64 extendedSessionStart(qint64 timestamp); // 04:00 ET of a weekday 04:00-20:00 ET, -1 outside
+    void aggregateRealTimeBar(TickerHandle ticker, TickerStream& stream, const CandleBar& bar);
+    CandleBar liveBar(TickerHandle ticker, const TickerStream& stream) const; // Dynamic candle in the current timeframe
+    void finalizeAggregationBar(TickerHandle ticker, Timeframe timeframe, AggregationSlot& slot);
 
     IBKRClient* m_client;
-    QMap<QString, TickerData> m_tickerData; // key: tickerKey (symbol@exchange)
-    QMap<QString, QString> m_symbolToExchange; // symbol -> exchange (DEPRECATED: use m_tickerKeyToExchange)
-    QMap<QString, int> m_symbolToContractId; // symbol -> conId (DEPRECATED: use m_tickerKeyToContractId)
-    QMap<QString, QString> m_tickerKeyToExchange; // tickerKey -> exchange
-    QMap<QString, int> m_tickerKeyToContractId; // tickerKey -> conId
-    QMap<int, QString> m_reqIdToSymbol; // reqId -> symbol
-    QMap<int, Timeframe> m_reqIdToTimeframe;
+    TickerRegistry m_registry; // tickerKey <-> handle, reqId -> (ticker, request kind, timeframe)
+
+    // Held for writing while the engine changes what other threads read (bar series,
+    // ticker keys, conIds); engine-thread reads go without it
+    mutable QReadWriteLock m_snapshotLock;
+    QHash<TickerHandle, TickerData> m_tickerData;
+    QHash<QString, QString> m_symbolToExchange; // symbol -> exchange (DEPRECATED: use m_tickerKeyToExchange)
+    QHash<QString, int> m_symbolToContractId; // symbol -> conId (DEPRECATED: use m_tickerKeyToContractId)
+    QHash<QString, QString> m_tickerKeyToExchange; // tickerKey -> exchange (also known before the ticker is added)
+    QHash<QString, int> m_tickerKeyToContractId; // tickerKey -> conId
+    QHash<int, QVector<CandleBar>> m_pendingHistoricalBars; // reqId -> bars received so far (merged on finish)
+    BarCache m_barCache;
+    HistoricalRequestScheduler* m_historyScheduler;
     int m_nextReqId;
+    int m_barRetentionHours;
+    qint64 m_simulatedTime;
 
     // For contract search logging
     struct ContractSearchInfo {
@@ -122,27 +280,35 @@ private:
     };
     QMap<int, ContractSearchInfo> m_contractSearches; // reqId -> search info
 
-    QString m_currentSymbol;
+    QString m_currentSymbol; // Ticker key
+    TickerHandle m_currentTicker;
     Timeframe m_currentTimeframe;
-    int m_tickByTickReqId;
-    int m_realTimeBarsReqId;
-    QMap<int, QString> m_realTimeBarsReqIdToSymbol; // Map reqId to symbol to prevent race condition
-    QMap<int, bool> m_realTimeBarsLogged; // Track first bar logged per reqId
 
-    // For building current dynamic candle from ticks (not in cache)
+    // Streaming pool
+    QHash<TickerHandle, TickerStream> m_streams; // Streaming state of pooled tickers
+    int m_maxStreamingTickers;
+    quint64 m_streamUseCounter;
+    QString m_tradeTickType;  // Empty = quotes only
+    int m_tickByTickLimit;    // Configured
+    int m_tickByTickBudget;   // Lowered when TWS rejects a trade stream (10190), reset on reconnect
+
+    // Aligned 5s timer that rolls dynamic candles of all streamed tickers
     QTimer* m_candleBoundaryTimer;
-    CandleBar m_currentDynamicBar;
-    bool m_hasDynamicBar;
-    qint64 m_lastCompletedBarTime; // Track last completed bar to avoid duplicates
-
-    // For aggregating 5s bars into larger timeframes
-    CandleBar m_aggregationBar;
-    bool m_isAggregating;
-
-    // For tracking price updates per candle (for tray blinking)
-    qint64 m_lastPriceUpdateTime;
-    qint64 m_currentBarStartTime;
-    bool m_hasPriceUpdateForCurrentBar;
+
+    // Ticker list prices of the other streamed tickers go to the GUI at most once per frame
+    static const int PRICE_FLUSH_INTERVAL_MS = 33;
+    QTimer* m_priceFlushTimer; // Single shot, started by the first background tick after a flush
+    QSet<TickerHandle> m_pendingPrices; // Ticked since the last flush
+
+    // Gap backfill (requests are paced by the scheduler at low priority)
+    QMap<int, GapBackfill> m_gaps; // gapId -> gap
+    QSet<TickerHandle> m_streamedTickers; // Had real-time bars before (gaps only possible after that)
+    QHash<int, BackfillRequest> m_backfillRequests; // reqId -> request (queued or in flight)
+
+    QSet<int> m_prefetchRequests; // Watchlist warm-up requests (don't mark timeframe loaded)
+    int m_nextGapId;
+    int m_gapsFound;
+    int m_gapsFilled;
 };
 
 #endif // TICKERDATAMANAGER_H
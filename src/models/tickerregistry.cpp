@@ -0,0 +1,84 @@
+#include "models/tickerregistry.h"
+
+TickerHandle TickerRegistry::intern(const QString& tickerKey)
+{
+    auto it = m_handles.constFind(tickerKey);
+    if (it != m_handles.constEnd()) {
+        return it.value();
+    }
+
+    TickerHandle ticker;
+    if (!m_freeHandles.isEmpty()) {
+        ticker = m_freeHandles.takeLast();
+    } else {
+        ticker = m_slots.size();
+        m_slots.append(Slot());
+    }
+
+    Slot& slot = m_slots[ticker];
+    slot.key = tickerKey;
+    slot.used = true;
+    m_handles.insert(tickerKey, ticker);
+    return ticker;
+}
+
+void TickerRegistry::release(TickerHandle ticker)
+{
+    if (!contains(ticker)) return;
+
+    takeRoutes(ticker);
+    Slot& slot = m_slots[ticker];
+    m_handles.remove(slot.key);
+    slot.key.clear();
+    slot.used = false;
+    m_freeHandles.append(ticker);
+}
+
+void TickerRegistry::addRoute(int reqId, TickerHandle ticker, RequestKind kind, int timeframe)
+{
+    if (!contains(ticker)) return;
+
+    removeRoute(reqId); // reqIds are unique, but never leave a stale entry in another ticker's list
+    m_routes.insert(reqId, RequestRoute{ticker, kind, timeframe});
+    m_slots[ticker].reqIds.append(reqId);
+}
+
+void TickerRegistry::removeRoute(int reqId)
+{
+    auto it = m_routes.find(reqId);
+    if (it == m_routes.end()) return;
+
+    // Per-ticker lists are short (a few subscriptions and pending history requests)
+    QVector<int>& reqIds = m_slots[it->ticker].reqIds;
+    int index = reqIds.indexOf(reqId);
+    if (index >= 0) {
+        reqIds[index] = reqIds.last();
+        reqIds.removeLast();
+    }
+    m_routes.erase(it);
+}
+
+QVector<int> TickerRegistry::takeRoutes(TickerHandle ticker)
+{
+    if (!contains(ticker)) return QVector<int>();
+
+    QVector<int> reqIds;
+    reqIds.swap(m_slots[ticker].reqIds);
+    for (int reqId : reqIds) {
+        m_routes.remove(reqId);
+    }
+    return reqIds;
+}
+
+void TickerRegistry::clearRoutes(RequestKind kind)
+{
+    for (auto it = m_routes.begin(); it != m_routes.end();) {
+        if (it->kind == kind) {
+            QVector<int>& reqIds = m_slots[it->ticker].reqIds;
+            reqIds.removeOne(it.key());
+            it = m_routes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef TICKERREGISTRY_H
+#define TICKERREGISTRY_H
+
+#include <QString>
+#include <QHash>
+#include <QVector>
+
+// Small integer id of a ticker, valid until the ticker is released
+using TickerHandle = int;
+const TickerHandle INVALID_TICKER = -1;
+
+enum class RequestKind : quint8 {
+    TickByTick,
+    RealTimeBars,
+    Historical
+};
+
+struct RequestRoute {
+    TickerHandle ticker = INVALID_TICKER;
+    RequestKind kind = RequestKind::Historical;
+    int timeframe = 0; // Timeframe index (historical requests only)
+};
+
+/**
+ * @brief Interns ticker keys (SYMBOL@EXCHANGE) as integer handles and routes TWS reqIds to them
+ *
+ * Handles index a flat slot array and are reused after release(). The reqId
+ * table is a hash, and every ticker keeps the list of its own reqIds, so
+ * routing a callback and dropping all requests of a ticker never walk the
+ * whole table or touch strings.
+ */
+class TickerRegistry
+{
+public:
+    TickerHandle intern(const QString& tickerKey); // Existing handle or a new one
+    TickerHandle find(const QString& tickerKey) const { return m_handles.value(tickerKey, INVALID_TICKER); }
+    bool contains(TickerHandle ticker) const { return ticker >= 0 && ticker < m_slots.size() && m_slots[ticker].used; }
+    const QString& key(TickerHandle ticker) const { return m_slots[ticker].key; }
+    void release(TickerHandle ticker); // Drops its routes, the handle may be handed out again
+
+    void addRoute(int reqId, TickerHandle ticker, RequestKind kind, int timeframe = 0);
+    RequestRoute route(int reqId) const { return m_routes.value(reqId); } // ticker == INVALID_TICKER if unknown
+    bool hasRoute(int reqId) const { return m_routes.contains(reqId); }
+    void removeRoute(int reqId);
+    QVector<int> takeRoutes(TickerHandle ticker); // Removes all routes of ticker, returns their reqIds
+    void clearRoutes(RequestKind kind);
+
+    // All routed reqIds of ticker (valid until routes change)
+    const QVector<int>& routes(TickerHandle ticker) const { return m_slots[ticker].reqIds; }
+
+private:
+    struct Slot {
+        QString key;
+        QVector<int> reqIds;
+        bool used = false;
+    };
+
+    QVector<Slot> m_slots;                  // Indexed by handle
+    QVector<TickerHandle> m_freeHandles;
+    QHash<QString, TickerHandle> m_handles; // tickerKey -> handle
+    QHash<int, RequestRoute> m_routes;      // reqId -> route
+};
+
+#endif // TICKERREGISTRY_H
@@ -0,0 +1,127 @@
+#include "trading/orderlane.h"
+#include "trading/tradingmanager.h"
+#include "client/ibkrclient.h"
+#include "utils/latencyhistogram.h"
+#include "utils/logger.h"
+#include <QCoreApplication>
+
+OrderLane::OrderLane(TradingManager* tradingManager, IBKRClient* client, QObject* parent)
+    : QObject(parent)
+    , m_tradingManager(tradingManager)
+    , m_client(client)
+    , m_queue(QUEUE_CAPACITY)
+    , m_wakePending(false)
+{
+}
+
+QEvent::Type OrderLane::wakeEventType()
+{
+    static const QEvent::Type type = static_cast<QEvent::Type>(QEvent::registerEventType());
+    return type;
+}
+
+void OrderLane::openPosition(int percentage)
+{
+    OrderCommand command;
+    command.kind = OrderCommand::Open;
+    command.percentage = percentage;
+    submit(command);
+}
+
+void OrderLane::addToPosition(int percentage)
+{
+    OrderCommand command;
+    command.kind = OrderCommand::Add;
+    command.percentage = percentage;
+    submit(command);
+}
+
+void OrderLane::closePosition(int percentage)
+{
+    OrderCommand command;
+    command.kind = OrderCommand::Close;
+    command.percentage = percentage;
+    submit(command);
+}
+
+void OrderLane::cancelAllOrders()
+{
+    OrderCommand command;
+    command.kind = OrderCommand::CancelAll;
+    submit(command);
+}
+
+void OrderLane::setTargetBuyPrice(double price)
+{
+    OrderCommand command;
+    command.kind = OrderCommand::SetBuyPrice;
+    command.price = price;
+    submit(command);
+}
+
+void OrderLane::setTargetSellPrice(double price)
+{
+    OrderCommand command;
+    command.kind = OrderCommand::SetSellPrice;
+    command.price = price;
+    submit(command);
+}
+
+void OrderLane::submit(OrderCommand command)
+{
+    command.submittedNs = LatencyHistogram::nowNs();
+    if (!m_queue.push(command)) {
+        LOG_WARNING(QString("Order lane full, command dropped (kind=%1)").arg(command.kind));
+        return;
+    }
+
+    // One wake event per batch; the engine clears the flag before draining, so a
+    // command pushed after the drain started always gets a new event
+    if (!m_wakePending.exchange(true, std::memory_order_acq_rel)) {
+        QCoreApplication::postEvent(this, new QEvent(wakeEventType()), Qt::HighEventPriority);
+    }
+}
+
+bool OrderLane::event(QEvent* event)
+{
+    if (event->type() != wakeEventType()) {
+        return QObject::event(event);
+    }
+
+    m_wakePending.store(false, std::memory_order_release);
+
+    OrderCommand command;
+    while (m_queue.pop(command)) {
+        execute(command);
+    }
+    return true;
+}
+
+void OrderLane::execute(const OrderCommand& command)
+{
+    switch (command.kind) {
+    case OrderCommand::Open:
+    case OrderCommand::Add:
+    case OrderCommand::Close:
+    case OrderCommand::CancelAll:
+        // Armed only for the command itself - the first socket write records the latency
+        m_client->setOrderOrigin(command.submittedNs);
+        if (command.kind == OrderCommand::Open) {
+            m_tradingManager->openPosition(command.percentage);
+        } else if (command.kind == OrderCommand::Add) {
+            m_tradingManager->addToPosition(command.percentage);
+        } else if (command.kind == OrderCommand::Close) {
+            m_tradingManager->closePosition(command.percentage);
+        } else {
+            m_tradingManager->cancelAllOrders();
+        }
+        m_client->setOrderOrigin(0); // Rejected commands (no write) must not arm the next one
+        break;
+    case OrderCommand::SetBuyPrice:
+        m_tradingManager->setTargetBuyPrice(command.price);
+        break;
+    case OrderCommand::SetSellPrice:
+        m_tradingManager->setTargetSellPrice(command.price);
+        break;
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef ORDERLANE_H
+#define ORDERLANE_H
+
+#include <QObject>
+#include <QEvent>
+#include <atomic>
+#include "utils/spscqueue.h"
+
+class IBKRClient;
+class TradingManager;
+
+// Trading command from a hotkey / button (plain data, copied through the lane)
+struct OrderCommand {
+    enum Kind { Open, Add, Close, CancelAll, SetBuyPrice, SetSellPrice };
+
+    Kind kind = CancelAll;
+    int percentage = 0;
+    double price = 0.0;
+    qint64 submittedNs = 0; // LatencyHistogram::nowNs() when the GUI queued it
+};
+
+/**
+ * @brief Fast lane for trading commands from the GUI thread to the engine thread
+ *
+ * Hotkeys push commands into a lock-free queue and wake the engine thread with a
+ * single high-priority posted event, so placeOrder/updateOrder/cancelOrder reach
+ * the socket ahead of market data callbacks, bar requests and other queued calls
+ * already waiting in the engine event loop. Target prices go through the same lane to
+ * keep their order relative to the hotkeys; the symbol is not a GUI command, the
+ * engine switches it together with the tick focus (TickerDataManager). Keypress -> socket write latency is recorded by
+ * IBKRClient (orderTracker()).
+ *
+ * Push methods: GUI thread only (single producer). Lives on the engine thread.
+ */
+class OrderLane : public QObject
+{
+    Q_OBJECT
+
+public:
+    OrderLane(TradingManager* tradingManager, IBKRClient* client, QObject* parent = nullptr);
+
+    void openPosition(int percentage);
+    void addToPosition(int percentage);
+    void closePosition(int percentage);
+    void cancelAllOrders();
+    void setTargetBuyPrice(double price);
+    void setTargetSellPrice(double price);
+
+protected:
+    bool event(QEvent* event) override;
+
+private:
+    static const int QUEUE_CAPACITY = 64; // Far more than anyone can press between two engine wakeups
+
+    void submit(OrderCommand command);
+    void execute(const OrderCommand& command);
+    static QEvent::Type wakeEventType();
+
+    TradingManager* m_tradingManager;
+    IBKRClient* m_client;
+    SpscQueue<OrderCommand> m_queue;
+    std::atomic<bool> m_wakePending; // A wake event is posted and not yet handled
+};
+
+#endif // ORDERLANE_H
@@ -11,13 +11,17 @@ TradingManager::TradingManager(IBKRClient *client, QObject *parent)
     , m_currentPrice(0.0)
     , m_bidPrice(0.0)
     , m_askPrice(0.0)
+    , m_bidSize(0.0)
+    , m_askSize(0.0)
     , m_targetBuyPrice(0.0)
     , m_targetSellPrice(0.0)
     , m_pendingBuyOrderId(-1)
     , m_pendingSellOrderId(-1)
+    , m_loggedTickReqId(-1)
 {
+    m_client->tickPipeline().addFocusConsumer(this);
+
     // Connect to IBKR client signals
-    connect(m_client, &IBKRClient::tickByTickUpdated, this, &TradingManager::onTickByTickUpdated);
     connect(m_client, &IBKRClient::orderConfirmed, this, &TradingManager::onOrderConfirmed);
     connect(m_client, &IBKRClient::orderStatusUpdated, this, &TradingManager::onOrderStatusUpdated);
     connect(m_client, &IBKRClient::error, this, &TradingManager::onError);
@@ -25,30 +29,39 @@ TradingManager::TradingManager(IBKRClient *client, QObject *parent)
         // Only track positions for active account
         if (account == m_client->activeAccount()) {
             m_positions[symbol] = position;
+            publishSnapshot();
             emit positionUpdated(symbol, position, avgCost);
         }
     });
 }
 
-void TradingManager::setSymbol(const QString& symbol)
+void TradingManager::setSymbol(const QString& symbol, const QString& exchange)
 {
-    if (m_currentSymbol == symbol) {
+    if (m_currentSymbol == symbol && m_currentExchange == exchange) {
         return;
     }
 
     m_currentSymbol = symbol;
-}
+    m_currentExchange = exchange;
 
-void TradingManager::setSymbolExchange(const QString& symbol, const QString& exchange)
-{
-    if (m_currentSymbol == symbol) {
-        m_currentExchange = exchange;
+    // Nothing of the previous symbol may size or price orders. The focus has already moved
+    // to this symbol's stream, so its last ticks are taken again
+    resetMarketData();
+    const TickPipeline& pipeline = m_client->tickPipeline();
+    if (const Tick* quote = pipeline.latest(pipeline.focus())) {
+        onTick(*quote);
     }
+    if (const Tick* trade = pipeline.latestTrade(pipeline.focus())) {
+        onTick(*trade);
+    }
+    publishSnapshot();
 }
 
 void TradingManager::resetTickLogging(int reqId)
 {
-    m_tickByTickLogged.remove(reqId);
+    if (m_loggedTickReqId == reqId) {
+        m_loggedTickReqId = -1;
+    }
 }
 
 void TradingManager::openPosition(int percentage)
@@ -213,6 +226,7 @@ void TradingManager::cancelAllOrders()
             m_client->cancelOrder(it.key());
         }
     }
+    publishSnapshot();
 }
 
 
@@ -269,41 +283,79 @@ double TradingManager::getPendingBuyPercentageOfBudget() const
     return (pendingBuy * m_currentPrice / budget) * 100.0;
 }
 
-bool TradingManager::canAddPercentage(int percentage) const
+TradingSnapshot TradingManager::snapshot() const
 {
-    double positionPct = getPositionPercentageOfBudget();
-    double pendingBuyPct = getPendingBuyPercentageOfBudget();
-    return (positionPct + pendingBuyPct + percentage) <= 100.0;
+    QReadLocker locker(&m_snapshotLock);
+    return m_snapshot;
 }
 
-bool TradingManager::canClosePercentage(int percentage) const
+void TradingManager::publishSnapshot(bool notify)
 {
-    double position = getCurrentPosition();
-    int sharesToSell = static_cast<int>(position * percentage / 100.0); // floor
-    return sharesToSell >= 1;
+    TradingSnapshot snapshot;
+    snapshot.symbol = m_currentSymbol;
+    snapshot.position = getCurrentPosition();
+    snapshot.targetBuyPrice = m_targetBuyPrice;
+    snapshot.targetSellPrice = m_targetSellPrice;
+    snapshot.positionPercentageOfBudget = getPositionPercentageOfBudget();
+    snapshot.pendingBuyPercentageOfBudget = getPendingBuyPercentageOfBudget();
+
+    {
+        QWriteLocker locker(&m_snapshotLock);
+        m_snapshot = snapshot;
+    }
+
+    if (notify) {
+        emit snapshotChanged();
+    }
 }
 
-void TradingManager::onTickByTickUpdated(int reqId, double price, double bidPrice, double askPrice)
+void TradingManager::onTick(const Tick& tick)
 {
-    m_currentPrice = price;
-    m_bidPrice = bidPrice;
-    m_askPrice = askPrice;
+    if (tick.isTrade()) {
+        m_currentPrice = tick.price; // Quote and targets stay as they are
+        return;
+    }
+
+    m_bidPrice = tick.bid;
+    m_askPrice = tick.ask;
+    m_bidSize = tick.bidSize;
+    m_askSize = tick.askSize;
 
     // Auto-update target prices with offsets (will be used if not manually set)
     m_targetBuyPrice = m_askPrice + (getAskOffset() / 100.0);
     m_targetSellPrice = m_bidPrice - (getBidOffset() / 100.0);
+    publishSnapshot(false); // Widgets refresh on their own price updates
 
-    // Log only first successful tick for each reqId
-    if (!m_tickByTickLogged.value(reqId, false)) {
+    // Log only first tick of the focused stream
+    if (tick.reqId != m_loggedTickReqId) {
         LOG_DEBUG(QString("First tick received [reqId=%1, symbol=%2]: bid=%3, ask=%4, price=%5, targetBuy=%6, targetSell=%7")
-            .arg(reqId).arg(m_currentSymbol).arg(bidPrice).arg(askPrice).arg(price).arg(m_targetBuyPrice).arg(m_targetSellPrice));
-        m_tickByTickLogged[reqId] = true;
+            .arg(tick.reqId).arg(m_currentSymbol).arg(tick.bid).arg(tick.ask).arg(tick.price).arg(m_targetBuyPrice).arg(m_targetSellPrice));
+        m_loggedTickReqId = tick.reqId;
     }
 }
 
+void TradingManager::onFocusChanged(int reqId)
+{
+    Q_UNUSED(reqId);
+    resetMarketData(); // The new stream's last ticks follow right away, if it has any
+    publishSnapshot();
+}
+
+void TradingManager::resetMarketData()
+{
+    m_currentPrice = 0.0;
+    m_bidPrice = 0.0;
+    m_askPrice = 0.0;
+    m_bidSize = 0.0;
+    m_askSize = 0.0;
+    m_targetBuyPrice = 0.0;
+    m_targetSellPrice = 0.0;
+}
+
 void TradingManager::setTargetBuyPrice(double price)
 {
     m_targetBuyPrice = price;
+    publishSnapshot(false);
     // Only log when user sets a limit price (not when resetting to 0)
     if (price > 0) {
         LOG_INFO(QString("Target buy price set to: %1").arg(price));
@@ -313,6 +365,7 @@ void TradingManager::setTargetBuyPrice(double price)
 void TradingManager::setTargetSellPrice(double price)
 {
     m_targetSellPrice = price;
+    publishSnapshot(false);
     // Only log when user sets a limit price (not when resetting to 0)
     if (price > 0) {
         LOG_INFO(QString("Target sell price set to: %1").arg(price));
@@ -382,6 +435,8 @@ void TradingManager::onError(int id, int code, const QString& message)
                 m_pendingSellOrderId = -1;
             }
 
+            publishSnapshot();
+
             // Emit error to show in UI
             emit error(QString("Order failed: %1").arg(message));
         }
@@ -434,6 +489,7 @@ void TradingManager::onOrderStatusUpdated(int orderId, const QString& status, do
             emit orderCancelled(orderId);
         }
 
+        publishSnapshot();
         emit orderUpdated(order);
     }
 }
@@ -453,6 +509,12 @@ int TradingManager::calculateSharesFromPercentage(int percentage)
     }
 
     int shares = static_cast<int>(amount / priceForCalc);
+
+    // Optionally don't buy more than is shown at the ask (0 = size unknown)
+    if (Settings::instance().capToDisplayedSize() && m_askSize > 0 && shares > m_askSize) {
+        LOG_INFO(QString("Order size capped to displayed ask size: %1 -> %2 shares").arg(shares).arg(m_askSize));
+        shares = static_cast<int>(m_askSize);
+    }
     return shares;
 }
 
@@ -531,6 +593,7 @@ int TradingManager::placeOrder(const QString& action, int quantity, double price
     } else {
         m_pendingSellOrderId = orderId;
     }
+    publishSnapshot();
 
     // Do NOT emit orderPlaced here - wait for TWS confirmation via onOrderConfirmed
     return orderId;
@@ -583,6 +646,7 @@ void TradingManager::updatePendingOrder(int& pendingOrderId, const QString& acti
         order.sortOrder = order.timestamp.toMSecsSinceEpoch();
 
         // Emit update to UI immediately (optimistic update)
+        publishSnapshot();
         emit orderUpdated(order);
     }
 }
\ No newline at end of file
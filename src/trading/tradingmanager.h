@@ -3,19 +3,36 @@
 
 #include <QObject>
 #include <QMap>
+#include <QReadWriteLock>
 #include "models/order.h"
+#include "client/tickpipeline.h"
 
 class IBKRClient;
 
-class TradingManager : public QObject
+// Copy of the state trading buttons depend on, readable from the GUI thread
+struct TradingSnapshot {
+    QString symbol;
+    double position = 0.0;
+    double targetBuyPrice = 0.0;
+    double targetSellPrice = 0.0;
+    double positionPercentageOfBudget = 0.0;
+    double pendingBuyPercentageOfBudget = 0.0;
+
+    // Adding X% must not exceed 100% of budget
+    bool canAddPercentage(int percentage) const { return (positionPercentageOfBudget + pendingBuyPercentageOfBudget + percentage) <= 100.0; }
+    // floor(position * %) >= 1
+    bool canClosePercentage(int percentage) const { return static_cast<int>(position * percentage / 100.0) >= 1; }
+};
+
+class TradingManager : public QObject, public TickConsumer
 {
     Q_OBJECT
 
 public:
     explicit TradingManager(IBKRClient *client, QObject *parent = nullptr);
 
-    void setSymbol(const QString& symbol);
-    void setSymbolExchange(const QString& symbol, const QString& exchange);
+    // Driven by TickerDataManager on the engine thread, in step with the tick focus
+    void setSymbol(const QString& symbol, const QString& exchange);
     void resetTickLogging(int reqId); // Reset tick logging for new subscription
     QString currentSymbol() const { return m_currentSymbol; }
     QString currentExchange() const { return m_currentExchange; }
@@ -29,7 +46,7 @@ public:
     void setTargetBuyPrice(double price);
     void setTargetSellPrice(double price);
 
-    // Get target prices (for button state checks)
+    // Get target prices
     double targetBuyPrice() const { return m_targetBuyPrice; }
     double targetSellPrice() const { return m_targetSellPrice; }
 
@@ -37,15 +54,19 @@ public:
     double getPendingBuyQuantity() const;
     double getPendingSellQuantity() const;
 
-    // Helper methods for button state calculation
     double getPositionPercentageOfBudget() const; // Returns % of budget that current position occupies
     double getPendingBuyPercentageOfBudget() const; // Returns % of budget that pending buy orders occupy
-    bool canAddPercentage(int percentage) const; // Check if can add X% without exceeding 100% budget
-    bool canClosePercentage(int percentage) const; // Check if floor(position * %) >= 1
 
-    // Trading hours check
+    // Button state for widgets (any thread; everything else runs on the engine thread)
+    TradingSnapshot snapshot() const;
+
+    // Trading hours check (wall clock only, any thread)
     bool isRegularTradingHours() const;
 
+    // Ticks of the active ticker only (focus consumer of the tick pipeline, set by TickerDataManager)
+    void onTick(const Tick& tick) override;
+    void onFocusChanged(int reqId) override; // Another ticker's stream - drop the previous one's prices
+
 signals:
     void orderPlaced(const TradeOrder& order);
     void orderUpdated(const TradeOrder& order);
@@ -53,9 +74,9 @@ signals:
     void positionUpdated(const QString& symbol, double quantity, double avgCost);
     void warning(const QString& message);
     void error(const QString& message);
+    void snapshotChanged(); // Position, orders or symbol changed (not emitted per tick)
 
 private slots:
-    void onTickByTickUpdated(int reqId, double price, double bidPrice, double askPrice);
     void onOrderConfirmed(int orderId, const QString& symbol, const QString& action, int quantity, double price, long long permId);
     void onOrderStatusUpdated(int orderId, const QString& status, double filled, double remaining, double avgFillPrice);
     void onError(int id, int code, const QString& message);
@@ -68,15 +89,19 @@ private:
 
     int placeOrder(const QString& action, int quantity, double price);
     void updatePendingOrder(int& pendingOrderId, const QString& action, int quantity, double price);
+    void publishSnapshot(bool notify = true); // Refresh m_snapshot, emit snapshotChanged() if notify
+    void resetMarketData(); // Price, quote, sizes and the targets derived from them
 
     IBKRClient *m_client;
     QString m_currentSymbol;
     QString m_currentExchange;
 
     // Current market data (for chart and other purposes)
-    double m_currentPrice;
+    double m_currentPrice; // Last trade
     double m_bidPrice;
     double m_askPrice;
+    double m_bidSize;      // Displayed liquidity (shares)
+    double m_askSize;
 
     // Target prices for orders (auto-calculated or manually set from OrderPanel)
     double m_targetBuyPrice;   // Ask + offset, or manual price
@@ -91,7 +116,10 @@ private:
     int m_pendingSellOrderId;
 
     // Logging tracking
-    QMap<int, bool> m_tickByTickLogged; // Track which reqIds have logged at least one tick
+    int m_loggedTickReqId; // Stream whose first tick was logged (logged again after focus changes)
+
+    TradingSnapshot m_snapshot;
+    mutable QReadWriteLock m_snapshotLock;
 };
 
 #endif // TRADINGMANAGER_H
\ No newline at end of file
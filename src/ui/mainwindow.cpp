@@ -1,6 +1,9 @@
 #include "ui/mainwindow.h"
+#include "client/enginethread.h"
+#include "trading/orderlane.h"
 #include "client/ibkrclient.h"
 #include "client/displaygroupmanager.h"
+#include "client/marketjournal.h"
 #include "trading/tradingmanager.h"
 #include "widgets/tickerlistwidget.h"
 #include "widgets/chartwidget.h"
@@ -9,6 +12,7 @@
 #include "dialogs/settingsdialog.h"
 #include "dialogs/symbolsearchdialog.h"
 #include "dialogs/debuglogdialog.h"
+#include "dialogs/diagnosticsdialog.h"
 #include "ui/toastnotification.h"
 #include "models/settings.h"
 #include "models/uistate.h"
@@ -30,7 +34,7 @@
 #include <QScreen>
 #include <QCloseEvent>
 
-MainWindow::MainWindow(QWidget *parent)
+MainWindow::MainWindow(const LaunchOptions& options, QWidget *parent)
     : QMainWindow(parent)
     , m_tickerLabel(nullptr)
     , m_settingsButton(nullptr)
@@ -43,18 +47,25 @@ MainWindow::MainWindow(QWidget *parent)
     , m_orderHistory(nullptr)
     , m_settingsDialog(nullptr)
     , m_symbolSearch(nullptr)
+    , m_engine(nullptr)
     , m_ibkrClient(nullptr)
     , m_tradingManager(nullptr)
+    , m_orderLane(nullptr)
     , m_historicalOrderCounter(1)  // Start from 1 for historical orders
     , m_nextHistoricalOrderId(-1)  // Start from -1 for unique historical order IDs
 {
     setWindowTitle("IBKR Hotkey Trader");
     resize(1400, 800);
 
-    // Initialize components
-    m_ibkrClient = new IBKRClient(this);
-    m_tradingManager = new TradingManager(m_ibkrClient, this);
-    m_tickerDataManager = new TickerDataManager(m_ibkrClient, this);
+    // Settings are loaded here (GUI thread) before the engine starts reading them
+    Settings& settings = Settings::instance();
+
+    // Initialize components (client, market data and trading live on the engine thread)
+    m_engine = new EngineThread(this);
+    m_ibkrClient = m_engine->client();
+    m_tradingManager = m_engine->tradingManager();
+    m_orderLane = m_engine->orderLane();
+    m_tickerDataManager = m_engine->tickerDataManager();
     m_symbolSearchManager = new SymbolSearchManager(m_ibkrClient, m_tickerDataManager, this);
     m_settingsDialog = new SettingsDialog(this);
     m_symbolSearch = new SymbolSearchDialog(m_symbolSearchManager, this);
@@ -70,11 +81,32 @@ MainWindow::MainWindow(QWidget *parent)
     m_globalHotkeyManager->registerHotkeys();
 
     // Apply saved settings to order history
-    Settings& settings = Settings::instance();
     m_orderHistory->setShowCancelledAndZeroPositions(settings.showCancelledOrders());
 
-    // Try to connect to TWS on startup
-    m_ibkrClient->connect(settings.host(), settings.port(), settings.clientId());
+    if (!options.replayJournal.isEmpty()) {
+        // Journal replay instead of TWS, following the recorded ticker switches
+        JournalReplayer* replayer = m_engine->replayer();
+        connect(replayer, &JournalReplayer::tickerRequested, this, [this](const QString& symbol) {
+            onSymbolSelected(symbol, m_symbolToExchange.value(symbol), 0);
+        });
+        connect(replayer, &JournalReplayer::finished, this, [this](quint64 records, quint64 unmatched, double seconds) {
+            showToast(QString("Replay finished: %1 records in %2 s (%3 unmatched)")
+                .arg(records).arg(seconds, 0, 'f', 1).arg(unmatched), "success");
+        });
+        setWindowTitle(windowTitle() + " - Replay");
+        QMetaObject::invokeMethod(replayer, [replayer, path = options.replayJournal, speed = options.replaySpeed]() {
+            replayer->start(path, speed);
+        });
+    } else {
+        // Try to connect to TWS on startup
+        QMetaObject::invokeMethod(m_ibkrClient, [client = m_ibkrClient, recordPath = options.recordJournal,
+                                                 host = settings.host(), port = settings.port(), clientId = settings.clientId()]() {
+            if (!recordPath.isEmpty()) {
+                client->startRecording(recordPath);
+            }
+            client->connect(host, port, clientId);
+        });
+    }
 
     // Initialize Display Group Manager (TWS UI synchronization)
     m_displayGroupManager = new DisplayGroupManager(m_ibkrClient, this);
@@ -331,6 +363,10 @@ void MainWindow::setupMenuBar()
     QAction *debugAction = helpMenu->addAction("Debug");
     debugAction->setShortcut(QKeySequence("Ctrl+Alt+I"));
     connect(debugAction, &QAction::triggered, this, &MainWindow::onDebugLogs);
+
+    QAction *diagnosticsAction = helpMenu->addAction("Diagnostics");
+    diagnosticsAction->setShortcut(QKeySequence("Ctrl+Alt+L"));
+    connect(diagnosticsAction, &QAction::triggered, this, &MainWindow::onDiagnostics);
 }
 
 void MainWindow::setupToolbar()
@@ -489,9 +525,12 @@ void MainWindow::setupConnections()
     connect(m_ibkrClient, &IBKRClient::disconnected, this, &MainWindow::onDisconnected);
     connect(m_ibkrClient, &IBKRClient::error, this, &MainWindow::onError);
     connect(m_ibkrClient, &IBKRClient::activeAccountChanged, m_orderHistory, &OrderHistoryWidget::setAccount);
+    connect(m_ibkrClient, &IBKRClient::activeAccountChanged, this, [this](const QString& account) {
+        m_activeAccount = account;
+    });
     connect(m_ibkrClient, &IBKRClient::accountUpdated, this, [this](const QString& key, const QString& value, const QString& currency, const QString& account) {
         // Update balance when NetLiquidation value is received
-        if (key == "NetLiquidation" && account == m_ibkrClient->activeAccount()) {
+        if (key == "NetLiquidation" && account == m_activeAccount) {
             m_orderHistory->setBalance(value.toDouble());
             updateTradingButtonsState();
         }
@@ -549,13 +588,14 @@ void MainWindow::setupConnections()
     connect(m_tickerDataManager, &TickerDataManager::tickerActivated, this, &MainWindow::onTickerActivated);
     connect(m_tickerDataManager, &TickerDataManager::priceUpdated, this, &MainWindow::onPriceUpdated);
 
-    // IBKR Client tick-by-tick for order panel price updates
-    connect(m_ibkrClient, &IBKRClient::tickByTickUpdated, this, &MainWindow::onTickByTickUpdated);
+    // Current ticker tick-by-tick for order panel price updates
+    // (trading targets come straight from the tick pipeline, other streamed tickers only update the ticker list via priceUpdated)
+    connect(m_tickerDataManager, &TickerDataManager::currentTickUpdated, this, &MainWindow::onTickByTickUpdated);
 
     // Chart updates from TickerDataManager (dynamic candle and bars)
-    connect(m_tickerDataManager, &TickerDataManager::currentBarUpdated, this, [this](const QString& symbol, const CandleBar& bar) {
+    connect(m_tickerDataManager, &TickerDataManager::currentBarUpdated, this, [this](const QString& symbol, Timeframe timeframe, const CandleBar& bar) {
         if (symbol == m_currentSymbol) {
-            m_chart->updateCurrentBar(bar);
+            m_chart->updateCurrentBar(timeframe, bar);
         }
     });
 
@@ -573,9 +613,17 @@ void MainWindow::setupConnections()
         showToast(message, "error");
     });
 
-    // OrderPanel -> TradingManager (manual price updates)
-    connect(m_orderPanel, &OrderPanel::buyPriceChanged, m_tradingManager, &TradingManager::setTargetBuyPrice);
-    connect(m_orderPanel, &OrderPanel::sellPriceChanged, m_tradingManager, &TradingManager::setTargetSellPrice);
+    // OrderPanel -> TradingManager (manual price updates, through the order lane so a
+    // price typed right before a hotkey is applied before the order)
+    connect(m_orderPanel, &OrderPanel::buyPriceChanged, this, [this](double price) {
+        m_orderLane->setTargetBuyPrice(price);
+    });
+    connect(m_orderPanel, &OrderPanel::sellPriceChanged, this, [this](double price) {
+        m_orderLane->setTargetSellPrice(price);
+    });
+
+    // Position, orders or symbol changed on the engine thread - refresh button state from its snapshot
+    connect(m_tradingManager, &TradingManager::snapshotChanged, this, &MainWindow::updateTradingButtonsState);
 
     // Global hotkey manager
     connect(m_globalHotkeyManager, &GlobalHotkeyManager::hotkeyPressed, this, [this](GlobalHotkeyManager::HotkeyAction action) {
@@ -649,12 +697,8 @@ void MainWindow::setupConnections()
     // Handle first tick received - sync Display Group for fast price updates
     connect(m_tickerDataManager, &TickerDataManager::firstTickReceived, this, [this](const QString& symbol) {
         // Synchronize TWS Display Group after first tick (when we have conId and fast price is priority)
-        // Parse current ticker key to get symbol and exchange
-        QString tickerKey = m_tickerDataManager->currentSymbol();
-        QPair<QString, QString> parsed = parseTickerKey(tickerKey);
-        QString parsedSymbol = parsed.first;
-        QString exchange = parsed.second;
-        int conId = m_tickerDataManager->getContractId(parsedSymbol, exchange);
+        QString exchange = m_symbolToExchange.value(symbol, QString());
+        int conId = m_tickerDataManager->getContractId(symbol, exchange);
         m_displayGroupManager->updateActiveSymbol(symbol, exchange, conId);
     });
 }
@@ -687,13 +731,15 @@ void MainWindow::onSymbolSelected(const QString& symbol, const QString& exchange
         m_symbolToExchange[symbol] = exchange;
     }
 
-    // Set conId if provided (from search dialog)
-    if (conId > 0) {
-        m_tickerDataManager->setContractId(symbol, exchange, conId);
-    }
+    QMetaObject::invokeMethod(m_tickerDataManager, [manager = m_tickerDataManager, symbol, exchange, conId]() {
+        // Set conId if provided (from search dialog)
+        if (conId > 0) {
+            manager->setContractId(symbol, exchange, conId);
+        }
 
-    // TickerDataManager handles all the logic: adding ticker, loading data, and subscribing
-    m_tickerDataManager->activateTicker(symbol, exchange);
+        // TickerDataManager handles all the logic: adding ticker, loading data, and subscribing
+        manager->activateTicker(symbol, exchange);
+    });
 }
 
 void MainWindow::onTickerActivated(const QString& symbol, const QString& exchange)
@@ -710,7 +756,6 @@ void MainWindow::onTickerActivated(const QString& symbol, const QString& exchang
     m_tickerList->addSymbol(symbol, exchange);
     m_tickerList->setCurrentSymbol(symbol, exchange);
     m_chart->setSymbol(symbol, exchange);
-    m_tradingManager->setSymbol(symbol);
     m_orderHistory->setCurrentSymbol(symbol);
     m_systemTrayManager->setTickerSymbol(symbol);
     m_systemTrayManager->stopBlinking();
@@ -725,15 +770,9 @@ void MainWindow::onTickerActivated(const QString& symbol, const QString& exchang
     bool isRegularHours = m_tradingManager->isRegularTradingHours();
     m_orderPanel->setMarketOrdersEnabled(isRegularHours);
 
-    // Update trading buttons state
+    // Update trading buttons state (refreshed again once TradingManager has switched symbol)
     updateTradingButtonsState();
 
-    // Update TradingManager with exchange info (must be after setSymbol!)
-    // In normal flow exchange is always provided, but check for safety
-    if (!exchange.isEmpty()) {
-        m_tradingManager->setSymbolExchange(symbol, exchange);
-    }
-
     // Note: ticker sync in TWS group will happen after first tick is received for better performance  (see onPriceUpdateReceived)
 }
 
@@ -796,7 +835,9 @@ void MainWindow::onSymbolDelete(const QString& symbol)
     LOG_DEBUG(QString("User deleted ticker: %1").arg(tickerKey));
 
     // Remove from ticker data manager (will unsubscribe from all data feeds)
-    m_tickerDataManager->removeTicker(symbol, exchange);
+    QMetaObject::invokeMethod(m_tickerDataManager, [manager = m_tickerDataManager, symbol, exchange]() {
+        manager->removeTicker(symbol, exchange);
+    });
 
     // Remove from ticker list widget
     m_tickerList->removeSymbol(symbol, exchange);
@@ -821,13 +862,14 @@ void MainWindow::onSymbolDelete(const QString& symbol)
             m_currentSymbol.clear();
 
             // Unsubscribe from market data
-            m_tickerDataManager->setCurrentSymbol("");
+            QMetaObject::invokeMethod(m_tickerDataManager, [manager = m_tickerDataManager]() {
+                manager->setCurrentSymbol("");
+            });
 
             // Clear UI
             m_tickerList->setTickerLabel("N/A");
             m_chart->setSymbol("");
             m_chart->clearChart();
-            m_tradingManager->setSymbol("");
             m_orderHistory->setCurrentSymbol("");
             m_systemTrayManager->setTickerSymbol("");
             m_systemTrayManager->stopBlinking();
@@ -840,7 +882,19 @@ void MainWindow::onSymbolDelete(const QString& symbol)
 
 void MainWindow::onSettingsClicked()
 {
-    m_settingsDialog->exec();
+    if (m_settingsDialog->exec() == QDialog::Accepted) {
+        int maxStreamingTickers = Settings::instance().maxStreamingTickers();
+        int barRetentionHours = Settings::instance().barRetentionHours();
+        QString tickByTickTrades = Settings::instance().tickByTickTrades();
+        int tickByTickLimit = Settings::instance().tickByTickLimit();
+        QMetaObject::invokeMethod(m_tickerDataManager, [manager = m_tickerDataManager, maxStreamingTickers, barRetentionHours,
+                                                        tickByTickTrades, tickByTickLimit]() {
+            manager->setTickByTickMode(tickByTickTrades, tickByTickLimit);
+            manager->setMaxStreamingTickers(maxStreamingTickers);
+            manager->setBarRetentionHours(barRetentionHours);
+        });
+        m_chart->setMaxFps(Settings::instance().chartMaxFps());
+    }
 }
 
 void MainWindow::onResetSession()
@@ -851,7 +905,7 @@ void MainWindow::onResetSession()
 
     if (reply == QMessageBox::Yes) {
         // TODO: Implement session reset
-        m_tradingManager->cancelAllOrders();
+        m_orderLane->cancelAllOrders();
         m_currentSymbol.clear();
         m_tickerList->setTickerLabel("N/A");
         m_tickerList->clear();
@@ -867,7 +921,8 @@ void MainWindow::onQuit()
 
     if (reply == QMessageBox::Yes) {
         // TODO: Close all positions and orders, then quit
-        m_tradingManager->cancelAllOrders();
+        // (EngineThread processes queued commands before it stops)
+        m_orderLane->cancelAllOrders();
         QApplication::quit();
     }
 }
@@ -879,11 +934,23 @@ void MainWindow::onDebugLogs()
     dialog->show();
 }
 
+void MainWindow::onDiagnostics()
+{
+    DiagnosticsDialog *dialog = new DiagnosticsDialog(m_ibkrClient, m_tickerDataManager, this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->show();
+}
+
 void MainWindow::onConnected()
 {
     // Connection logged in IBKRClient
     showToast("Connected to TWS", "success");
     updateTradingButtonsState();
+
+    // Warm up charts of the whole watchlist (queued behind the active ticker's requests)
+    QMetaObject::invokeMethod(m_tickerDataManager, [manager = m_tickerDataManager, tickers = m_tickerList->getAllTickersWithExchange()]() {
+        manager->prefetchTickers(tickers);
+    });
 }
 
 void MainWindow::onDisconnected()
@@ -930,87 +997,87 @@ void MainWindow::onError(int id, int code, const QString& message)
 
 void MainWindow::onOpen100()
 {
-    m_tradingManager->openPosition(100);
+    m_orderLane->openPosition(100);
 }
 
 void MainWindow::onOpen50()
 {
-    m_tradingManager->openPosition(50);
+    m_orderLane->openPosition(50);
 }
 
 void MainWindow::onAdd5()
 {
-    m_tradingManager->addToPosition(5);
+    m_orderLane->addToPosition(5);
 }
 
 void MainWindow::onAdd10()
 {
-    m_tradingManager->addToPosition(10);
+    m_orderLane->addToPosition(10);
 }
 
 void MainWindow::onAdd15()
 {
-    m_tradingManager->addToPosition(15);
+    m_orderLane->addToPosition(15);
 }
 
 void MainWindow::onAdd20()
 {
-    m_tradingManager->addToPosition(20);
+    m_orderLane->addToPosition(20);
 }
 
 void MainWindow::onAdd25()
 {
-    m_tradingManager->addToPosition(25);
+    m_orderLane->addToPosition(25);
 }
 
 void MainWindow::onAdd30()
 {
-    m_tradingManager->addToPosition(30);
+    m_orderLane->addToPosition(30);
 }
 
 void MainWindow::onAdd35()
 {
-    m_tradingManager->addToPosition(35);
+    m_orderLane->addToPosition(35);
 }
 
 void MainWindow::onAdd40()
 {
-    m_tradingManager->addToPosition(40);
+    m_orderLane->addToPosition(40);
 }
 
 void MainWindow::onAdd45()
 {
-    m_tradingManager->addToPosition(45);
+    m_orderLane->addToPosition(45);
 }
 
 void MainWindow::onAdd50()
 {
-    m_tradingManager->addToPosition(50);
+    m_orderLane->addToPosition(50);
 }
 
 void MainWindow::onClose25()
 {
-    m_tradingManager->closePosition(25);
+    m_orderLane->closePosition(25);
 }
 
 void MainWindow::onClose50()
 {
-    m_tradingManager->closePosition(50);
+    m_orderLane->closePosition(50);
 }
 
 void MainWindow::onClose75()
 {
-    m_tradingManager->closePosition(75);
+    m_orderLane->closePosition(75);
 }
 
 void MainWindow::onClose100()
 {
-    m_tradingManager->closePosition(100);
+    m_orderLane->closePosition(100);
 }
 
 void MainWindow::onCancelOrders()
 {
-    m_tradingManager->cancelAllOrders();
+    m_orderLane->cancelAllOrders();
 }
 
 void MainWindow::onToggleShowCancelledAndZeroPositions(bool checked)
@@ -1031,11 +1098,8 @@ void MainWindow::onDisplayGroupSelected(int groupId)
 
     // If we have an active ticker, immediately sync to the new group
     if (!m_currentSymbol.isEmpty()) {
-        QString tickerKey = m_tickerDataManager->currentSymbol();
-        QPair<QString, QString> parsed = parseTickerKey(tickerKey);
-        QString symbol = parsed.first;
-        QString exchange = parsed.second;
-        int conId = m_tickerDataManager->getContractId(symbol, exchange);
+        QString exchange = m_symbolToExchange.value(m_currentSymbol, QString());
+        int conId = m_tickerDataManager->getContractId(m_currentSymbol, exchange);
         m_displayGroupManager->updateActiveSymbol(m_currentSymbol, exchange, conId);
     }
 }
@@ -1114,12 +1178,15 @@ void MainWindow::updateTradingButtonsState()
     // Enable order panel when connected and have symbol
     m_orderPanel->setOrderPanelEnabled(true);
 
-    // Get current data
+    // Get current data (trading state is a snapshot published by the engine thread;
+    // right after a ticker switch it may still describe the previous symbol)
+    TradingSnapshot trading = m_tradingManager->snapshot();
+    bool isSnapshotCurrent = (trading.symbol == m_currentSymbol);
     double price = m_orderHistory->getCurrentPrice(m_currentSymbol);
     double balance = m_orderHistory->getBalance();
-    double position = m_tradingManager->getCurrentPosition();
-    double targetBuyPrice = m_tradingManager->targetBuyPrice();
-    double targetSellPrice = m_tradingManager->targetSellPrice();
+    double position = trading.position;
+    double targetBuyPrice = trading.targetBuyPrice;
+    double targetSellPrice = trading.targetSellPrice;
 
     // Basic requirements
     bool hasPrice = (price > 0.0);
@@ -1129,7 +1196,7 @@ void MainWindow::updateTradingButtonsState()
 
     // Check if target prices are set (for LMT orders) or if using MKT
     QString orderType = Settings::instance().orderType();
-    bool hasValidPrices = (orderType == "MKT") || (targetBuyPrice > 0.0 && targetSellPrice > 0.0);
+    bool hasValidPrices = isSnapshotCurrent && ((orderType == "MKT") || (targetBuyPrice > 0.0 && targetSellPrice > 0.0));
 
     // Open buttons: enabled ONLY if NO position AND has price AND balance AND valid target prices
     // (From REQUIREMENTS: "Спрацює тільки якщо немає відкритих позицій")
@@ -1141,16 +1208,16 @@ void MainWindow::updateTradingButtonsState()
 
     // Add buttons: enabled if HAS position AND price AND balance AND valid target prices AND doesn't exceed 100% budget
     // (From REQUIREMENTS: "Спрацює тільки коли вже є відкриті позиції" + check budget limit)
-    bool canAdd5 = hasPosition && hasPrice && hasBalance && hasValidPrices && m_tradingManager->canAddPercentage(5);
-    bool canAdd10 = hasPosition && hasPrice && hasBalance && hasValidPrices && m_tradingManager->canAddPercentage(10);
-    bool canAdd15 = hasPosition && hasPrice && hasBalance && hasValidPrices && m_tradingManager->canAddPercentage(15);
-    bool canAdd20 = hasPosition && hasPrice && hasBalance && hasValidPrices && m_tradingManager->canAddPercentage(20);
-    bool canAdd25 = hasPosition && hasPrice && hasBalance && hasValidPrices && m_tradingManager->canAddPercentage(25);
-    bool canAdd30 = hasPosition && hasPrice && hasBalance && hasValidPrices && m_tradingManager->canAddPercentage(30);
-    bool canAdd35 = hasPosition && hasPrice && hasBalance && hasValidPrices && m_tradingManager->canAddPercentage(35);
-    bool canAdd40 = hasPosition && hasPrice && hasBalance && hasValidPrices && m_tradingManager->canAddPercentage(40);
-    bool canAdd45 = hasPosition && hasPrice && hasBalance && hasValidPrices && m_tradingManager->canAddPercentage(45);
-    bool canAdd50 = hasPosition && hasPrice && hasBalance && hasValidPrices && m_tradingManager->canAddPercentage(50);
+    bool canAdd5 = hasPosition && hasPrice && hasBalance && hasValidPrices && trading.canAddPercentage(5);
+    bool canAdd10 = hasPosition && hasPrice && hasBalance && hasValidPrices && trading.canAddPercentage(10);
+    bool canAdd15 = hasPosition && hasPrice && hasBalance && hasValidPrices && trading.canAddPercentage(15);
+    bool canAdd20 = hasPosition && hasPrice && hasBalance && hasValidPrices && trading.canAddPercentage(20);
+    bool canAdd25 = hasPosition && hasPrice && hasBalance && hasValidPrices && trading.canAddPercentage(25);
+    bool canAdd30 = hasPosition && hasPrice && hasBalance && hasValidPrices && trading.canAddPercentage(30);
+    bool canAdd35 = hasPosition && hasPrice && hasBalance && hasValidPrices && trading.canAddPercentage(35);
+    bool canAdd40 = hasPosition && hasPrice && hasBalance && hasValidPrices && trading.canAddPercentage(40);
+    bool canAdd45 = hasPosition && hasPrice && hasBalance && hasValidPrices && trading.canAddPercentage(45);
+    bool canAdd50 = hasPosition && hasPrice && hasBalance && hasValidPrices && trading.canAddPercentage(50);
 
     m_btnAdd5->setEnabled(canAdd5);
     m_btnAdd10->setEnabled(canAdd10);
@@ -1175,10 +1242,10 @@ void MainWindow::updateTradingButtonsState()
 
     // Close buttons: enabled if has position AND valid target prices AND floor(position * %) >= 1
     // (From REQUIREMENTS: "Ті кнопки неактивні що створять округлену заявку менше однієї акції")
-    bool canClose25 = hasPosition && hasValidPrices && m_tradingManager->canClosePercentage(25);
-    bool canClose50 = hasPosition && hasValidPrices && m_tradingManager->canClosePercentage(50);
-    bool canClose75 = hasPosition && hasValidPrices && m_tradingManager->canClosePercentage(75);
-    bool canClose100 = hasPosition && hasValidPrices && m_tradingManager->canClosePercentage(100);
+    bool canClose25 = hasPosition && hasValidPrices && trading.canClosePercentage(25);
+    bool canClose50 = hasPosition && hasValidPrices && trading.canClosePercentage(50);
+    bool canClose75 = hasPosition && hasValidPrices && trading.canClosePercentage(75);
+    bool canClose100 = hasPosition && hasValidPrices && trading.canClosePercentage(100);
 
     m_btnClose25->setEnabled(canClose25);
     m_btnClose50->setEnabled(canClose50);
@@ -9,8 +9,10 @@
 #include <QTimer>
 #include <QMap>
 
+class EngineThread;
 class IBKRClient;
 class TradingManager;
+class OrderLane;
 class TickerListWidget;
 class ChartWidget;
 class OrderHistoryWidget;
@@ -26,12 +28,19 @@ class RemoteControlServer;
 class DisplayGroupManager;
 class SymbolSearchManager;
 
+// Startup modes from the command line (see main.cpp)
+struct LaunchOptions {
+    QString recordJournal;    // Record TWS callbacks to this file (see MarketJournalWriter)
+    QString replayJournal;    // Replay this file instead of connecting to TWS
+    double replaySpeed = 1.0; // <= 0: as fast as possible
+};
+
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
 
 public:
-    explicit MainWindow(QWidget *parent = nullptr);
+    explicit MainWindow(const LaunchOptions& options = LaunchOptions(), QWidget *parent = nullptr);
     ~MainWindow();
 
 protected:
@@ -47,6 +56,7 @@ private slots:
     void onResetSession();
     void onQuit();
     void onDebugLogs();
+    void onDiagnostics();
 
     void onConnected();
     void onDisconnected();
@@ -152,9 +162,11 @@ private:
     SettingsDialog *m_settingsDialog;
     SymbolSearchDialog *m_symbolSearch;
 
-    // Business logic
+    // Business logic (client and managers run on the engine thread)
+    EngineThread *m_engine;
     IBKRClient *m_ibkrClient;
     TradingManager *m_tradingManager;
+    OrderLane *m_orderLane; // Trading commands to the engine thread
     TickerDataManager *m_tickerDataManager;
     SymbolSearchManager *m_symbolSearchManager;
     GlobalHotkeyManager *m_globalHotkeyManager;
@@ -163,6 +175,7 @@ private:
     DisplayGroupManager *m_displayGroupManager;
 
     QString m_currentSymbol;
+    QString m_activeAccount;                     // Last activeAccountChanged from the client
     QMap<QString, QString> m_symbolToExchange;   // symbol -> primaryExchange
 
     // Order sorting and unique IDs
@@ -0,0 +1,178 @@
+#include "fastdecimal.h"
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+// Exactly representable powers of ten (10^22 is the largest)
+static const double POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const int MAX_EXACT_POW10 = 22;
+static const uint64_t MAX_EXACT_MANTISSA = 1ull << 53;
+
+// Rounds fraction / 2^shift to 6 decimals (ties to even, like printf):
+// fraction * 10^6 / 2^shift = fraction * 15625 / 2^(shift - 6), with a 128-bit product
+static uint64_t roundMicros(uint64_t fraction, int shift)
+{
+    if (shift <= 6) {
+        return (fraction * 15625) << (6 - shift);
+    }
+    int t = shift - 6;
+    if (t >= 68) {
+        return 0; // fraction * 15625 < 2^67, below one half
+    }
+
+    uint64_t low = (fraction & 0xFFFFFFFFull) * 15625;
+    uint64_t high = (fraction >> 32) * 15625;
+    uint64_t lo = low + (high << 32);
+    uint64_t hi = (high >> 32) + (lo < low ? 1 : 0);
+
+    uint64_t quotient;
+    int compare; // Remainder against one half
+    if (t < 64) {
+        quotient = (lo >> t) | (hi << (64 - t));
+        uint64_t remainder = lo & ((1ull << t) - 1);
+        uint64_t half = 1ull << (t - 1);
+        compare = remainder > half ? 1 : (remainder < half ? -1 : 0);
+    } else {
+        int s = t - 64;
+        quotient = hi >> s;
+        if (s == 0) {
+            uint64_t half = 1ull << 63;
+            compare = lo > half ? 1 : (lo < half ? -1 : 0);
+        } else {
+            uint64_t remainderHigh = hi & ((1ull << s) - 1);
+            uint64_t halfHigh = 1ull << (s - 1);
+            if (remainderHigh != halfHigh) {
+                compare = remainderHigh > halfHigh ? 1 : -1;
+            } else {
+                compare = lo > 0 ? 1 : 0;
+            }
+        }
+    }
+
+    if (compare > 0 || (compare == 0 && (quotient & 1))) {
+        ++quotient;
+    }
+    return quotient;
+}
+
+bool FastDecimal::parse(const char* text, double& value)
+{
+    const char* p = text;
+    while (*p == ' ' || (*p >= '\t' && *p <= '\r')) {
+        ++p;
+    }
+    bool negative = false;
+    if (*p == '-' || *p == '+') {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int significant = 0;   // Digits in mantissa (leading zeros skipped)
+    int fractionDigits = 0;
+    bool anyDigit = false;
+    for (bool fraction = false;; ++p) {
+        if (*p >= '0' && *p <= '9') {
+            anyDigit = true;
+            if (fraction) {
+                ++fractionDigits;
+            }
+            if (mantissa != 0 || *p != '0') {
+                if (++significant > 19) {
+                    return parseFallback(text, value);
+                }
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            }
+        } else if (*p == '.' && !fraction) {
+            fraction = true;
+        } else {
+            break;
+        }
+    }
+
+    // Exponents, hex, inf/nan and anything that doesn't fit the exact path
+    if (!anyDigit || *p == 'e' || *p == 'E' || *p == 'x' || *p == 'X'
+        || mantissa > MAX_EXACT_MANTISSA || fractionDigits > MAX_EXACT_POW10) {
+        return parseFallback(text, value);
+    }
+
+    double result = static_cast<double>(mantissa);
+    if (fractionDigits > 0) {
+        result /= POW10[fractionDigits];
+    }
+    value = negative ? -result : result;
+    return true;
+}
+
+bool FastDecimal::parseFallback(const char* text, double& value)
+{
+    char* end = nullptr;
+    int savedErrno = errno;
+    errno = 0;
+    double result = std::strtod(text, &end);
+    bool outOfRange = (errno == ERANGE);
+    errno = savedErrno;
+    if (end == text || outOfRange) {
+        return false;
+    }
+    value = result;
+    return true;
+}
+
+int FastDecimal::formatFixed6(double value, char* out)
+{
+    char* p = out;
+    if (std::signbit(value)) {
+        *p++ = '-';
+    }
+
+    double magnitude = std::fabs(value);
+    if (!(magnitude < 18446744073709551616.0)) { // 2^64, also catches nan
+        std::strcpy(p, std::isinf(magnitude) ? "inf" : "nan");
+        return static_cast<int>(p - out) + 3;
+    }
+
+    // magnitude = mantissa / 2^shift, exactly
+    int exponent = 0;
+    double normalized = std::frexp(magnitude, &exponent);
+    uint64_t mantissa = static_cast<uint64_t>(std::ldexp(normalized, 53));
+    int shift = 53 - exponent;
+
+    uint64_t integer = 0;
+    uint64_t micros = 0;
+    if (shift <= 0) {
+        integer = mantissa << -shift;
+    } else if (shift < 64) {
+        integer = mantissa >> shift;
+        micros = roundMicros(mantissa & ((1ull << shift) - 1), shift);
+    } else {
+        micros = roundMicros(mantissa, shift);
+    }
+    if (micros == 1000000) {
+        ++integer;
+        micros = 0;
+    }
+
+    char digits[20];
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + integer % 10);
+        integer /= 10;
+    } while (integer != 0);
+    while (count > 0) {
+        *p++ = digits[--count];
+    }
+    *p++ = '.';
+    for (int i = 5; i >= 0; --i) {
+        p[i] = static_cast<char>('0' + micros % 10);
+        micros /= 10;
+    }
+    p += 6;
+    *p = '\0';
+    return static_cast<int>(p - out);
+}
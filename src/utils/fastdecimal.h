@@ -0,0 +1,37 @@
+#ifndef FASTDECIMAL_H
+#define FASTDECIMAL_H
+
+/**
+ * @brief Allocation-free text <-> double conversion for the Decimal stub (bid_stub.cpp)
+ *
+ * TWS sends sizes, positions and quantities as short decimal strings ("100",
+ * "0.5"). parse() accumulates the digits into an integer and scales it by an exact
+ * power of ten, which is correctly rounded whenever the mantissa fits in 53 bits
+ * and there are at most 22 fraction digits - the same double strtod() returns.
+ * Anything else (exponents, hex, inf/nan, very long numbers) falls back to strtod().
+ *
+ * formatFixed6() produces what printf("%.6f") does, with exact integer arithmetic
+ * instead of a stream: the bench (bench/decimal_bench.cpp) checks both against
+ * the former std::stod / std::ostringstream implementation.
+ *
+ * Both always use '.' as decimal separator, whatever the C locale is set to.
+ */
+class FastDecimal
+{
+public:
+    static const int FORMAT_CAPACITY = 32; // Sign, 20 integer digits, '.', 6 decimals, '\0'
+
+    // std::stod() semantics without exceptions: leading whitespace, trailing
+    // characters ignored; false if nothing was converted or the value is out of range
+    static bool parse(const char* text, double& value);
+
+    // Writes value with 6 decimals to out (at least FORMAT_CAPACITY bytes), returns
+    // the length. Non-finite values and magnitudes of 2^64 and above are written as
+    // "nan" / "inf" (UNSET_DECIMAL's bit pattern reads as ~1e289 in this stub).
+    static int formatFixed6(double value, char* out);
+
+private:
+    static bool parseFallback(const char* text, double& value);
+};
+
+#endif // FASTDECIMAL_H
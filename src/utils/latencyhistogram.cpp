@@ -0,0 +1,88 @@
+#include "utils/latencyhistogram.h"
+#include <QtAlgorithms>
+#include <cstring>
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::reset()
+{
+    std::memset(m_buckets, 0, sizeof(m_buckets));
+    m_count = 0;
+    m_sumNs = 0;
+    m_maxNs = 0;
+}
+
+int LatencyHistogram::bucketFor(quint64 ns)
+{
+    const quint64 subBuckets = 1u << SUB_BUCKET_BITS;
+    if (ns < subBuckets) return static_cast<int>(ns);
+
+    // Values with highest bit m fall into [2^m, 2^(m+1)), split into 4 equal sub-buckets
+    int msb = 63 - static_cast<int>(qCountLeadingZeroBits(ns));
+    int sub = static_cast<int>((ns >> (msb - SUB_BUCKET_BITS)) & (subBuckets - 1));
+    return ((msb - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) + sub;
+}
+
+qint64 LatencyHistogram::bucketUpperBound(int bucket)
+{
+    const int subBuckets = 1 << SUB_BUCKET_BITS;
+    if (bucket < subBuckets) return bucket;
+
+    int msb = (bucket >> SUB_BUCKET_BITS) + SUB_BUCKET_BITS - 1;
+    int sub = bucket & (subBuckets - 1);
+    int shift = msb - SUB_BUCKET_BITS;
+    quint64 lower = static_cast<quint64>(subBuckets + sub) << shift;
+    return static_cast<qint64>(lower + (quint64(1) << shift) - 1);
+}
+
+void LatencyHistogram::record(qint64 ns)
+{
+    if (ns < 0) ns = 0; // Clock adjustments can't happen with steady_clock, but be safe
+
+    m_buckets[bucketFor(static_cast<quint64>(ns))]++;
+    m_count++;
+    m_sumNs += ns;
+    if (ns > m_maxNs) {
+        m_maxNs = ns;
+    }
+}
+
+qint64 LatencyHistogram::percentileNs(double percentile) const
+{
+    if (m_count == 0) return 0;
+
+    quint64 target = static_cast<quint64>(percentile / 100.0 * m_count + 0.5);
+    target = qBound<quint64>(1, target, m_count);
+
+    quint64 seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += m_buckets[i];
+        if (seen >= target) {
+            return qMin(bucketUpperBound(i), m_maxNs);
+        }
+    }
+    return m_maxNs;
+}
+
+QString LatencyHistogram::formatNs(qint64 ns)
+{
+    if (ns < 1000) return QString("%1ns").arg(ns);
+    if (ns < 1000000) return QString("%1us").arg(ns / 1000.0, 0, 'f', 1);
+    if (ns < 1000000000) return QString("%1ms").arg(ns / 1000000.0, 0, 'f', 2);
+    return QString("%1s").arg(ns / 1000000000.0, 0, 'f', 2);
+}
+
+QString LatencyHistogram::summary() const
+{
+    if (m_count == 0) return QString("n=0");
+
+    return QString("n=%1 p50=%2 p99=%3 p99.9=%4 max=%5")
+        .arg(m_count)
+        .arg(formatNs(percentileNs(50.0)))
+        .arg(formatNs(percentileNs(99.0)))
+        .arg(formatNs(percentileNs(99.9)))
+        .arg(formatNs(m_maxNs));
+}
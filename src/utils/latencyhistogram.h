@@ -0,0 +1,51 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+#include <QString>
+#include <chrono>
+
+/**
+ * @brief Fixed-size latency histogram (nanoseconds), log2 buckets with 4 sub-buckets each
+ *
+ * record() is a few instructions and never allocates; percentiles are
+ * reported as the upper bound of the bucket (at most 25% high).
+ * Not thread-safe - record from one thread.
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    static qint64 nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void record(qint64 ns);
+    void reset();
+
+    quint64 count() const { return m_count; }
+    qint64 maxNs() const { return m_maxNs; }
+    double meanNs() const { return m_count > 0 ? static_cast<double>(m_sumNs) / m_count : 0.0; }
+    qint64 percentileNs(double percentile) const; // 0..100
+
+    // "n=1234 p50=12.3us p99=250us p99.9=1.2ms max=3.4ms"
+    QString summary() const;
+    static QString formatNs(qint64 ns);
+
+private:
+    static const int SUB_BUCKET_BITS = 2;
+    static const int BUCKET_COUNT = 64 << SUB_BUCKET_BITS;
+
+    static int bucketFor(quint64 ns);
+    static qint64 bucketUpperBound(int bucket);
+
+    quint64 m_buckets[BUCKET_COUNT];
+    quint64 m_count;
+    qint64 m_sumNs;
+    qint64 m_maxNs;
+};
+
+#endif // LATENCYHISTOGRAM_H
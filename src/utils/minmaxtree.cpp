@@ -0,0 +1,142 @@
+#include "minmaxtree.h"
+#include <limits>
+
+static const double NO_LOW = std::numeric_limits<double>::infinity();
+static const double NO_HIGH = -std::numeric_limits<double>::infinity();
+static const int MIN_CAPACITY = 64;
+
+MinMaxTree::MinMaxTree()
+    : m_capacity(0)
+    , m_head(0)
+    , m_size(0)
+{
+}
+
+void MinMaxTree::clear()
+{
+    m_low.fill(NO_LOW);
+    m_high.fill(NO_HIGH);
+    m_head = 0;
+    m_size = 0;
+}
+
+void MinMaxTree::reserve(int count)
+{
+    int capacity = qMax(m_capacity, MIN_CAPACITY);
+    while (capacity < count) {
+        capacity *= 2;
+    }
+    if (capacity != m_capacity) {
+        grow(capacity);
+    }
+}
+
+void MinMaxTree::grow(int capacity)
+{
+    // Leaves in logical order at the start of the new ring
+    QVector<double> low(2 * capacity, NO_LOW);
+    QVector<double> high(2 * capacity, NO_HIGH);
+    for (int i = 0; i < m_size; ++i) {
+        int from = m_capacity + physicalIndex(i);
+        low[capacity + i] = m_low[from];
+        high[capacity + i] = m_high[from];
+    }
+    for (int node = capacity - 1; node >= 1; --node) {
+        low[node] = qMin(low[2 * node], low[2 * node + 1]);
+        high[node] = qMax(high[2 * node], high[2 * node + 1]);
+    }
+
+    m_low = std::move(low);
+    m_high = std::move(high);
+    m_capacity = capacity;
+    m_head = 0;
+}
+
+void MinMaxTree::append(double low, double high)
+{
+    if (m_size == m_capacity) {
+        grow(qMax(MIN_CAPACITY, 2 * m_capacity));
+    }
+    update(physicalIndex(m_size), low, high);
+    ++m_size;
+}
+
+void MinMaxTree::set(int index, double low, double high)
+{
+    if (index < 0 || index >= m_size) return;
+    update(physicalIndex(index), low, high);
+}
+
+void MinMaxTree::removeFirst(int count)
+{
+    count = qMin(count, m_size);
+    if (count <= 0) return;
+    if (count == m_size) {
+        clear();
+        return;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        update(physicalIndex(i), NO_LOW, NO_HIGH);
+    }
+    m_head = physicalIndex(count);
+    m_size -= count;
+}
+
+void MinMaxTree::removeLast(int count)
+{
+    count = qMin(count, m_size);
+    if (count <= 0) return;
+
+    for (int i = m_size - count; i < m_size; ++i) {
+        update(physicalIndex(i), NO_LOW, NO_HIGH);
+    }
+    m_size -= count;
+}
+
+void MinMaxTree::update(int physical, double low, double high)
+{
+    int node = m_capacity + physical;
+    m_low[node] = low;
+    m_high[node] = high;
+    for (node >>= 1; node >= 1; node >>= 1) {
+        m_low[node] = qMin(m_low[2 * node], m_low[2 * node + 1]);
+        m_high[node] = qMax(m_high[2 * node], m_high[2 * node + 1]);
+    }
+}
+
+bool MinMaxTree::query(int from, int to, double& low, double& high) const
+{
+    from = qMax(0, from);
+    to = qMin(to, m_size);
+    if (from >= to) return false;
+
+    low = NO_LOW;
+    high = NO_HIGH;
+    int first = physicalIndex(from);
+    int last = first + (to - from);
+    if (last <= m_capacity) {
+        queryPhysical(first, last, low, high);
+    } else {
+        // Range wraps around the end of the ring
+        queryPhysical(first, m_capacity, low, high);
+        queryPhysical(0, last - m_capacity, low, high);
+    }
+    return true;
+}
+
+void MinMaxTree::queryPhysical(int from, int to, double& low, double& high) const
+{
+    for (int l = from + m_capacity, r = to + m_capacity; l < r; l >>= 1, r >>= 1) {
+        if (l & 1) {
+            low = qMin(low, m_low[l]);
+            high = qMax(high, m_high[l]);
+            ++l;
+        }
+        if (r & 1) {
+            --r;
+            low = qMin(low, m_low[r]);
+            high = qMax(high, m_high[r]);
+        }
+    }
+}
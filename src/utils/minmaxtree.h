@@ -0,0 +1,47 @@
+#ifndef MINMAXTREE_H
+#define MINMAXTREE_H
+
+#include <QtGlobal>
+#include <QVector>
+
+/**
+ * @brief Segment tree of (low, high) pairs answering min(low) / max(high) over any index range
+ *
+ * Built for the chart's visible-range auto-scale: bars are indexed by position,
+ * appended and patched at the end and dropped from the front as the candle
+ * container moves, each in O(log n); a range query is O(log n). Storage is a
+ * ring over a power-of-two capacity that doubles (rebuilt in O(n)) when full.
+ */
+class MinMaxTree
+{
+public:
+    MinMaxTree();
+
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+
+    void clear();
+    void reserve(int count); // Capacity for count values without regrowing
+    void append(double low, double high);
+    void set(int index, double low, double high);
+    void removeFirst(int count);
+    void removeLast(int count);
+
+    // Extremes over [from, to), clamped to the stored range; false if it's empty
+    bool query(int from, int to, double& low, double& high) const;
+
+private:
+    int physicalIndex(int index) const { return (m_head + index) & (m_capacity - 1); }
+    void grow(int capacity);
+    void update(int physical, double low, double high);
+    void queryPhysical(int from, int to, double& low, double& high) const;
+
+    // Iterative tree: node i has children 2i and 2i+1, leaves at m_capacity + physical index
+    QVector<double> m_low;
+    QVector<double> m_high;
+    int m_capacity; // Power of two (0 until the first append)
+    int m_head;     // Physical index of index 0
+    int m_size;
+};
+
+#endif // MINMAXTREE_H
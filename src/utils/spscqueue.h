@@ -0,0 +1,78 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief Bounded lock-free queue for exactly one producer thread and one consumer thread
+ *
+ * Capacity must be a power of two. Storage is allocated once in the constructor;
+ * push() and pop() never allocate or block. Head and tail live on separate cache
+ * lines so the two threads don't invalidate each other's line on every operation.
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacity)
+        : m_items(capacity)
+        , m_mask(capacity - 1)
+    {
+        // Power of two keeps the index wrap a single AND
+        Q_ASSERT(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer thread only. Returns false if full (item not queued)
+    bool push(const T& item)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_headCache > m_mask) {
+            m_headCache = m_head.load(std::memory_order_acquire);
+            if (tail - m_headCache > m_mask) return false;
+        }
+        m_items[tail & m_mask] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only. Returns false if empty
+    bool pop(T& item)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tailCache) {
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+            if (head == m_tailCache) return false;
+        }
+        item = m_items[head & m_mask];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called while the other side is running
+    bool isEmpty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return m_mask + 1; }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::vector<T> m_items;
+    const size_t m_mask;
+
+    alignas(CACHE_LINE) std::atomic<size_t> m_head{0}; // Next slot to pop (written by consumer)
+    size_t m_tailCache = 0;                            // Consumer's last seen tail
+
+    alignas(CACHE_LINE) std::atomic<size_t> m_tail{0}; // Next slot to push (written by producer)
+    size_t m_headCache = 0;                            // Producer's last seen head
+};
+
+#endif // SPSCQUEUE_H
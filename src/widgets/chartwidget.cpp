@@ -1,5 +1,6 @@
 #include "widgets/chartwidget.h"
 #include "models/uistate.h"
+#include "models/settings.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -8,10 +9,44 @@
 #include <QDebug>
 #include <limits>
 
+// Session shading, in fixed US Eastern standard time (UTC-5)
+enum ChartSession { SessionNone, SessionPreMarket, SessionAfterHours };
+static const qint64 EASTERN_OFFSET_SECS = -5 * 3600;
+
+static qint64 easternDay(qint64 timestamp)
+{
+    qint64 local = timestamp + EASTERN_OFFSET_SECS;
+    return local >= 0 ? local / 86400 : (local - 86399) / 86400;
+}
+
+// Level of detail: bucket sizes (seconds) for zoomed-out charts, and the narrowest candle drawn
+static const int LOD_BUCKETS[] = {10, 30, 60, 300, 900, 1800, 3600, 14400, 86400};
+static const double MIN_PIXELS_PER_CANDLE = 3.0;
+static const double CANDLE_WIDTH_RATIO = 0.7; // Body width relative to the bucket
+
+static int sessionOf(qint64 timestamp)
+{
+    qint64 minute = (timestamp + EASTERN_OFFSET_SECS - easternDay(timestamp) * 86400) / 60;
+    if (minute >= 4 * 60 && minute < 9 * 60 + 30) return SessionPreMarket;
+    if (minute >= 16 * 60 && minute < 20 * 60) return SessionAfterHours;
+    return SessionNone;
+}
+
 ChartWidget::ChartWidget(QWidget *parent)
     : QWidget(parent)
     , m_customPlot(nullptr)
     , m_candlesticks(nullptr)
+    , m_lodSeconds(-1)
+    , m_lodRefoldFrom(std::numeric_limits<double>::max())
+    , m_title(nullptr)
+    , m_volumeRect(nullptr)
+    , m_volumeAxis(nullptr)
+    , m_volumeBars(nullptr)
+    , m_vwapGraph(nullptr)
+    , m_emaFastGraph(nullptr)
+    , m_emaSlowGraph(nullptr)
+    , m_sessionHighGraph(nullptr)
+    , m_sessionLowGraph(nullptr)
     , m_bidLine(nullptr)
     , m_askLine(nullptr)
     , m_midLine(nullptr)
@@ -23,20 +58,31 @@ ChartWidget::ChartWidget(QWidget *parent)
     , m_currentTimeframe(Timeframe::SEC_10) // Default to 10s
     , m_dataManager(nullptr)
     , m_autoScale(true) // Auto-scale enabled by default
+    , m_plottedTimeframe(Timeframe::SEC_10)
+    , m_plottedRevision(0)
     , m_lastBid(0.0)
     , m_lastAsk(0.0)
     , m_lastMid(0.0)
-    , m_priceLinesDirty(false)
+    , m_frameIntervalMs(1000 / 30)
+    , m_dirty(0)
+    , m_replotsRequested(0)
+    , m_replotsPerformed(0)
 {
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
     mainLayout->setContentsMargins(0, 0, 0, 0);
     mainLayout->setSpacing(5);
 
-    // Setup debounce timer for replot (max 10 FPS for price lines)
+    // One replot per frame, whatever the tick rate
     m_replotTimer = new QTimer(this);
     m_replotTimer->setSingleShot(true);
-    m_replotTimer->setInterval(100); // 100ms = 10 FPS
+    m_replotTimer->setTimerType(Qt::PreciseTimer);
     connect(m_replotTimer, &QTimer::timeout, this, &ChartWidget::scheduledReplot);
+    setMaxFps(Settings::instance().chartMaxFps());
+
+    m_zoomSaveTimer = new QTimer(this);
+    m_zoomSaveTimer->setSingleShot(true);
+    m_zoomSaveTimer->setInterval(500);
+    connect(m_zoomSaveTimer, &QTimer::timeout, this, &ChartWidget::saveHorizontalRange);
 
     // Chart at the top
     m_customPlot = new QCustomPlot(this);
@@ -73,6 +119,9 @@ void ChartWidget::setupChart()
     // Create candlestick graph
     m_candlesticks = new QCPFinancial(m_customPlot->xAxis, m_customPlot->yAxis);
     m_candlesticks->setChartStyle(QCPFinancial::csCandlestick);
+    m_candlesticks->setWidth(CANDLE_WIDTH_RATIO * timeframeToSeconds(m_currentTimeframe));
+    m_candles = m_candlesticks->data();
+    m_lodCandles.reset(new QCPFinancialDataContainer);
 
     // Style for candlesticks
     m_candlesticks->setBrushPositive(QColor(26, 188, 156));  // Green for up candles
@@ -153,6 +202,81 @@ void ChartWidget::setupChart()
     m_bidLabel->setVisible(false);
     m_askLabel->setVisible(false);
     m_midLabel->setVisible(false);
+
+    setupVolumePane();
+    setupIndicators();
+}
+
+void ChartWidget::setupVolumePane()
+{
+    m_volumeRect = new QCPAxisRect(m_customPlot);
+    m_customPlot->plotLayout()->addElement(m_customPlot->plotLayout()->rowCount(), 0, m_volumeRect);
+    m_customPlot->plotLayout()->setRowStretchFactor(m_customPlot->plotLayout()->rowCount() - 1, 0.25);
+
+    // Follows the price chart's time axis, no drag/zoom of its own
+    m_volumeRect->setRangeDrag(Qt::Orientations());
+    m_volumeRect->setRangeZoom(Qt::Orientations());
+    QCPAxis* timeAxis = m_volumeRect->axis(QCPAxis::atBottom);
+    timeAxis->setTicker(m_customPlot->xAxis->ticker());
+    timeAxis->setTickLabels(false);
+    timeAxis->setRange(m_customPlot->xAxis->range());
+    connect(m_customPlot->xAxis, SIGNAL(rangeChanged(QCPRange)), timeAxis, SLOT(setRange(QCPRange)));
+
+    m_volumeAxis = m_volumeRect->axis(QCPAxis::atRight);
+    m_volumeAxis->setVisible(true);
+    m_volumeAxis->setLabel("Volume");
+    m_volumeAxis->setRange(0, 1);
+    m_volumeRect->axis(QCPAxis::atLeft)->setTickLabels(false);
+
+    // Plot areas line up with the price chart
+    QCPMarginGroup* marginGroup = new QCPMarginGroup(m_customPlot);
+    m_customPlot->axisRect()->setMarginGroup(QCP::msLeft | QCP::msRight, marginGroup);
+    m_volumeRect->setMarginGroup(QCP::msLeft | QCP::msRight, marginGroup);
+
+    // Light theme, as the price chart
+    const QList<QCPAxis*> axes = m_volumeRect->axes();
+    for (QCPAxis* axis : axes) {
+        axis->setBasePen(QPen(QColor(60, 60, 60)));
+        axis->setTickPen(QPen(QColor(60, 60, 60)));
+        axis->setSubTickPen(QPen(QColor(140, 140, 140)));
+        axis->setTickLabelColor(QColor(60, 60, 60));
+        axis->setLabelColor(QColor(40, 40, 40));
+        axis->grid()->setPen(QPen(QColor(200, 200, 200), 1, Qt::DotLine));
+    }
+
+    m_volumeBars = new QCPBars(timeAxis, m_volumeAxis);
+    m_volumeBars->setPen(Qt::NoPen);
+    m_volumeBars->setBrush(QColor(120, 144, 156, 160));
+    m_volumeBars->setWidth(CANDLE_WIDTH_RATIO * timeframeToSeconds(m_currentTimeframe));
+    m_volumeBars->removeFromLegend();
+    m_volume = m_volumeBars->data();
+    m_lodVolume.reset(new QCPBarsDataContainer);
+}
+
+void ChartWidget::setupIndicators()
+{
+    auto addOverlay = [this](const QString& name, const QPen& pen, QCPGraph::LineStyle style) {
+        QCPGraph* graph = m_customPlot->addGraph(m_customPlot->xAxis, m_customPlot->yAxis);
+        graph->setName(name);
+        graph->setPen(pen);
+        graph->setLineStyle(style);
+        return graph;
+    };
+    m_vwapGraph = addOverlay("VWAP", QPen(QColor(255, 152, 0), 1.5), QCPGraph::lsLine);
+    m_emaFastGraph = addOverlay(QString("EMA %1").arg(BarIndicators::FAST_EMA_PERIOD),
+                                QPen(QColor(156, 39, 176), 1), QCPGraph::lsLine);
+    m_emaSlowGraph = addOverlay(QString("EMA %1").arg(BarIndicators::SLOW_EMA_PERIOD),
+                                QPen(QColor(33, 150, 243), 1), QCPGraph::lsLine);
+    m_sessionHighGraph = addOverlay("Session high", QPen(QColor(100, 100, 100), 1, Qt::DotLine), QCPGraph::lsStepLeft);
+    m_sessionLowGraph = addOverlay("Session low", QPen(QColor(100, 100, 100), 1, Qt::DotLine), QCPGraph::lsStepLeft);
+
+    // Legend for the overlays in the top left corner of the price chart
+    m_candlesticks->removeFromLegend();
+    m_customPlot->legend->setVisible(true);
+    m_customPlot->legend->setFont(QFont("sans", 8));
+    m_customPlot->legend->setBrush(QBrush(QColor(255, 255, 255, 200)));
+    m_customPlot->legend->setBorderPen(Qt::NoPen);
+    m_customPlot->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignTop | Qt::AlignLeft);
 }
 
 void ChartWidget::setupControls()
@@ -187,27 +311,29 @@ void ChartWidget::setSymbol(const QString& symbol, const QString& exchange)
     if (!m_currentSymbol.isEmpty()) {
         m_customPlot->plotLayout()->insertRow(0);
         QString title = QString("%1 - %2 Candles").arg(m_currentSymbol).arg(timeframeToString(m_currentTimeframe));
-        m_customPlot->plotLayout()->addElement(0, 0,
-            new QCPTextElement(m_customPlot, title, QFont("sans", 12, QFont::Bold)));
+        m_title = new QCPTextElement(m_customPlot, title, QFont("sans", 12, QFont::Bold));
+        m_customPlot->plotLayout()->addElement(0, 0, m_title);
 
-        updateChart();
+        updateChart(true);
     }
 }
 
 void ChartWidget::setTimeframe(Timeframe timeframe)
 {
     if (m_currentTimeframe != timeframe) {
+        // Pending zoom belongs to the timeframe being left
+        if (m_zoomSaveTimer->isActive()) {
+            m_zoomSaveTimer->stop();
+            saveHorizontalRange();
+        }
         m_currentTimeframe = timeframe;
 
-        if (!m_currentSymbol.isEmpty() && m_customPlot->plotLayout()->rowCount() > 1) {
-            QCPTextElement* titleElement = qobject_cast<QCPTextElement*>(m_customPlot->plotLayout()->element(0, 0));
-            if (titleElement) {
-                QString title = QString("%1 - %2 Candles").arg(m_currentSymbol).arg(timeframeToString(m_currentTimeframe));
-                titleElement->setText(title);
-            }
+        if (!m_currentSymbol.isEmpty() && m_title) {
+            QString title = QString("%1 - %2 Candles").arg(m_currentSymbol).arg(timeframeToString(m_currentTimeframe));
+            m_title->setText(title);
         }
 
-        updateChart();
+        updateChart(true);
     }
 }
 
@@ -216,15 +342,17 @@ void ChartWidget::setTickerDataManager(TickerDataManager* manager)
     m_dataManager = manager;
 
     if (m_dataManager) {
-        connect(m_dataManager, &TickerDataManager::barsUpdated, this, [this](const QString& symbol) {
-            if (symbol == m_currentSymbol) {
+        connect(m_dataManager, &TickerDataManager::barsUpdated, this, [this](const QString& symbol, Timeframe timeframe) {
+            // All timeframes are aggregated in background - only redraw the one on screen
+            if (symbol == m_currentSymbol && timeframe == m_currentTimeframe) {
                 updateChart();
             }
         });
 
+        // History may have rewritten any bar - plot it again
         connect(m_dataManager, &TickerDataManager::tickerDataLoaded, this, [this](const QString& symbol) {
             if (symbol == m_currentSymbol) {
-                updateChart();
+                updateChart(true);
             }
         });
     }
@@ -232,7 +360,8 @@ void ChartWidget::setTickerDataManager(TickerDataManager* manager)
 
 void ChartWidget::clearChart()
 {
-    m_candlesticks->data()->clear();
+    clearPlottedData();
+    m_indicatorTracks.clear(); // Another ticker
 
     // Hide price lines
     if (m_bidLine) m_bidLine->setVisible(false);
@@ -242,41 +371,42 @@ void ChartWidget::clearChart()
     if (m_askLabel) m_askLabel->setVisible(false);
     if (m_midLabel) m_midLabel->setVisible(false);
 
-    // Remove session background rectangles
-    for (int i = m_customPlot->itemCount() - 1; i >= 0; --i) {
-        QCPAbstractItem* item = m_customPlot->item(i);
-        if (!item) continue;
-
-        QCPItemRect* rect = qobject_cast<QCPItemRect*>(item);
-        if (rect) {
-            m_customPlot->removeItem(rect);
-        }
-    }
-
-    if (m_customPlot->plotLayout()->rowCount() > 1) {
-        m_customPlot->plotLayout()->removeAt(0);
+    if (m_title) {
+        m_customPlot->plotLayout()->remove(m_title);
         m_customPlot->plotLayout()->simplify();
+        m_title = nullptr;
     }
 
-    m_customPlot->replot();
+    m_dirty &= ~DirtyPriceLines; // Stay hidden until the next quote
+    requestReplot(DirtyCandles);
 }
 
-void ChartWidget::updateChart()
+void ChartWidget::updateChart(bool reload)
 {
     if (m_currentSymbol.isEmpty() || !m_dataManager) {
         return;
     }
 
-    const QVector<CandleBar>* bars = m_dataManager->getBars(m_currentTickerKey, m_currentTimeframe);
-    if (bars && !bars->isEmpty()) {
-        plotCandles(*bars);
+    // Copy of the engine's series (shares storage until the engine modifies it)
+    CandleSeries series = m_dataManager->barsSnapshot(m_currentTickerKey, m_currentTimeframe);
+    bool samePlot = (m_plottedTickerKey == m_currentTickerKey && m_plottedTimeframe == m_currentTimeframe);
+    if (series.isEmpty()) {
+        // Nothing cached for this timeframe yet - don't leave another one's candles up
+        if (!samePlot && !m_candles->isEmpty()) {
+            clearPlottedData();
+            requestReplot(DirtyCandles);
+        }
+        return;
+    }
+
+    if (reload || !samePlot || !syncCandles(series)) {
+        plotCandles(series);
     }
 }
 
-void ChartWidget::plotCandles(const QVector<CandleBar>& bars)
+void ChartWidget::plotCandles(const CandleSeries& series)
 {
-    m_candlesticks->data()->clear();
-
+    CandleView bars = series.view();
     if (!bars.isEmpty()) {
         QDateTime firstTime = QDateTime::fromSecsSinceEpoch(bars.first().timestamp, QTimeZone::utc());
         QDateTime lastTime = QDateTime::fromSecsSinceEpoch(bars.last().timestamp, QTimeZone::utc());
@@ -287,24 +417,243 @@ void ChartWidget::plotCandles(const QVector<CandleBar>& bars)
                  << "Last timestamp:" << bars.last().timestamp;
     }
 
-    for (const CandleBar& bar : bars) {
-        m_candlesticks->addData(bar.timestamp, bar.open, bar.high, bar.low, bar.close);
+    // Bulk load: the series is sorted, so the container takes it without sorting
+    QVector<QCPFinancialData> points(bars.size());
+    for (int i = 0; i < bars.size(); ++i) {
+        points[i] = QCPFinancialData(bars.timestamp(i), bars.open(i), bars.high(i), bars.low(i), bars.close(i));
+    }
+    QVector<QCPBarsData> volumes(bars.size());
+    for (int i = 0; i < bars.size(); ++i) {
+        volumes[i] = QCPBarsData(bars.timestamp(i), bars.volume(i));
     }
+    m_candles->set(points, true);
+    m_volume->set(volumes, true);
+    rebuildRangeTrees();
+    m_series = series;
+    syncIndicators(series);
+    m_plottedTickerKey = m_currentTickerKey;
+    m_plottedTimeframe = m_currentTimeframe;
+    m_plottedRevision = series.revision();
 
     addSessionBackgrounds(bars);
 
+    // Level is decided again for the restored range (buckets are rebuilt either way)
+    m_lodSeconds = -1;
+    m_candlesticks->setData(m_candles);
+    m_volumeBars->setData(m_volume);
+
     // Auto-scale X axis to show all candles
     m_candlesticks->rescaleKeyAxis();
 
     // Restore saved horizontal zoom for this timeframe
     restoreHorizontalRange();
+    updateLevelOfDetail();
 
-    // Auto-scale Y axis for visible candles
-    if (m_autoScale) {
-        rescaleVerticalAxis();
+    requestReplot(DirtyCandles | DirtyAxes);
+}
+
+bool ChartWidget::syncCandles(const CandleSeries& series)
+{
+    QSharedPointer<QCPFinancialDataContainer> data = m_candles;
+    if (series.revision() != m_plottedRevision || data->isEmpty()) {
+        return false; // Bars inserted or rewritten before the newest one
+    }
+
+    // Bars the ring buffer dropped
+    qint64 firstTimestamp = series.timestamp(0);
+    int plotted = data->size();
+    data->removeBefore(firstTimestamp);
+    m_volume->removeBefore(firstTimestamp);
+    m_priceRange.removeFirst(plotted - data->size());
+    m_volumeRange.removeFirst(plotted - data->size());
+    m_lodCandles->removeBefore(firstTimestamp);
+    m_lodVolume->removeBefore(firstTimestamp);
+    m_indicatorTracks[m_currentTimeframe].indicators.removeBefore(firstTimestamp);
+    for (QCPGraph* graph : {m_vwapGraph, m_emaFastGraph, m_emaSlowGraph, m_sessionHighGraph, m_sessionLowGraph}) {
+        graph->data()->removeBefore(firstTimestamp);
+    }
+    trimSessionBackgrounds(firstTimestamp);
+    if (data->isEmpty()) {
+        return false;
+    }
+
+    // Patched from the newest bar synced before: the engine may have completed it since, and
+    // bars that live candles already ran past arrive after them. Everything up to it must
+    // line up one to one with the plotted candles
+    if (m_series.isEmpty()) {
+        return false;
+    }
+    qint64 syncedUntil = m_series.last().timestamp;
+    CandleView bars = series.view();
+    int from = bars.lowerBound(syncedUntil);
+    int plottedIndex = static_cast<int>(data->findBegin(syncedUntil, false) - data->constBegin());
+    if (from >= bars.size() || bars.timestamp(from) != syncedUntil || plottedIndex != from
+        || plottedIndex >= data->size() || (data->constBegin() + plottedIndex)->key != syncedUntil) {
+        return false;
+    }
+    m_series = series;
+
+    QCPRange xRange = m_customPlot->xAxis->range();
+    bool visibleChanged = false;
+    for (int i = from; i < bars.size(); ++i) {
+        CandleBar bar = bars.at(i);
+        patchCandle(bar);
+        feedIndicators(bar);
+        visibleChanged = visibleChanged || xRange.contains(bar.timestamp);
+    }
+    IndicatorTrack& track = m_indicatorTracks[m_currentTimeframe];
+    track.revision = series.revision();
+
+    // Live candle past the series: its preview was taken before these bars were fed
+    const QCPFinancialData& newest = *(data->constEnd() - 1);
+    if (newest.key > bars.last().timestamp) {
+        CandleBar live(static_cast<qint64>(newest.key), newest.open, newest.high, newest.low, newest.close,
+                       qRound64((m_volume->constEnd() - 1)->value));
+        plotIndicatorPoint(track.indicators.preview(live));
+    }
+
+    // The window didn't move - only rescale if a visible candle changed
+    requestReplot(visibleChanged ? (DirtyCandles | DirtyAxes) : DirtyCandles);
+    return true;
+}
+
+bool ChartWidget::patchCandle(const CandleBar& bar)
+{
+    QSharedPointer<QCPFinancialDataContainer> data = m_candles;
+    QCPFinancialData point(bar.timestamp, bar.open, bar.high, bar.low, bar.close);
+    QCPBarsData volume(bar.timestamp, bar.volume);
+
+    if (!data->isEmpty() && (data->constEnd() - 1)->key >= point.key) {
+        int index = static_cast<int>(data->findBegin(point.key, false) - data->constBegin());
+        if ((data->constBegin() + index)->key == point.key) {
+            // In place, the key order is unchanged (the newest, or a completed bar behind a live candle)
+            *(data->begin() + index) = point;
+            *(m_volume->begin() + index) = volume;
+            m_priceRange.set(index, point.low, point.high);
+            m_volumeRange.set(index, volume.value, volume.value);
+            if (index < data->size() - 1) {
+                m_lodRefoldFrom = qMin(m_lodRefoldFrom, point.key);
+            }
+            return false;
+        }
+
+        // Completed bar no live candle was built for: the newer live candles give way
+        // (the next tick brings the current one back)
+        int newer = data->size() - index;
+        data->remove(point.key, std::numeric_limits<double>::max());
+        m_volume->remove(volume.key, std::numeric_limits<double>::max());
+        m_priceRange.removeLast(newer);
+        m_volumeRange.removeLast(newer);
+        m_lodRefoldFrom = qMin(m_lodRefoldFrom, point.key);
+    }
+
+    data->add(point); // Newest key - appended without sorting
+    m_volume->add(volume);
+    m_priceRange.append(point.low, point.high);
+    m_volumeRange.append(volume.value, volume.value);
+    addSessionBackground(bar.timestamp);
+    return true;
+}
+
+void ChartWidget::rebuildRangeTrees()
+{
+    m_priceRange.clear();
+    m_priceRange.reserve(m_candles->size());
+    for (QCPFinancialDataContainer::const_iterator it = m_candles->constBegin(); it != m_candles->constEnd(); ++it) {
+        m_priceRange.append(it->low, it->high);
+    }
+    m_volumeRange.clear();
+    m_volumeRange.reserve(m_volume->size());
+    for (QCPBarsDataContainer::const_iterator it = m_volume->constBegin(); it != m_volume->constEnd(); ++it) {
+        m_volumeRange.append(it->value, it->value);
+    }
+}
+
+void ChartWidget::clearPlottedData()
+{
+    m_candles->clear();
+    m_lodCandles->clear();
+    m_volume->clear();
+    m_lodVolume->clear();
+    m_series = CandleSeries();
+    m_lodSeconds = -1;
+    m_priceRange.clear();
+    m_volumeRange.clear();
+    m_plottedTickerKey.clear();
+    clearIndicatorGraphs();
+    clearSessionBackgrounds();
+}
+
+void ChartWidget::syncIndicators(const CandleSeries& series)
+{
+    IndicatorTrack& track = m_indicatorTracks[m_currentTimeframe];
+    CandleView bars = series.view();
+
+    // Fed from this series before (timeframe was on screen): only the bars since then
+    int from = 0;
+    if (track.revision == series.revision() && !track.indicators.isEmpty()
+        && track.indicators.lastTimestamp() <= bars.last().timestamp) {
+        from = bars.lowerBound(track.indicators.lastTimestamp());
+    } else {
+        track.indicators.clear();
+    }
+    for (int i = from; i < bars.size(); ++i) {
+        track.indicators.update(bars.at(i));
+    }
+    track.indicators.removeBefore(bars.timestamp(0));
+    track.revision = series.revision();
+
+    const BarIndicators& indicators = track.indicators;
+    int count = indicators.size();
+    QVector<QCPGraphData> vwap(count), emaFast(count), emaSlow(count), sessionHigh(count), sessionLow(count);
+    for (int i = 0; i < count; ++i) {
+        const IndicatorPoint& point = indicators.at(i);
+        vwap[i] = QCPGraphData(point.timestamp, point.vwap);
+        emaFast[i] = QCPGraphData(point.timestamp, point.emaFast);
+        emaSlow[i] = QCPGraphData(point.timestamp, point.emaSlow);
+        sessionHigh[i] = QCPGraphData(point.timestamp, point.sessionHigh);
+        sessionLow[i] = QCPGraphData(point.timestamp, point.sessionLow);
+    }
+    m_vwapGraph->data()->set(vwap, true);
+    m_emaFastGraph->data()->set(emaFast, true);
+    m_emaSlowGraph->data()->set(emaSlow, true);
+    m_sessionHighGraph->data()->set(sessionHigh, true);
+    m_sessionLowGraph->data()->set(sessionLow, true);
+}
+
+void ChartWidget::feedIndicators(const CandleBar& bar)
+{
+    BarIndicators& indicators = m_indicatorTracks[m_currentTimeframe].indicators;
+    if (indicators.update(bar)) {
+        plotIndicatorPoint(indicators.last());
     }
+}
 
-    m_customPlot->replot();
+void ChartWidget::plotIndicatorPoint(const IndicatorPoint& point)
+{
+    // Existing point in place (the newest, or a bar completed behind the live candle's
+    // preview), otherwise added - appended unless a live candle's point is already newer
+    auto plot = [&point](QCPGraph* graph, double value) {
+        QSharedPointer<QCPGraphDataContainer> data = graph->data();
+        QCPGraphDataContainer::const_iterator it = data->findBegin(point.timestamp, false);
+        if (it != data->constEnd() && it->key == point.timestamp) {
+            (data->begin() + (it - data->constBegin()))->value = value;
+        } else {
+            data->add(QCPGraphData(point.timestamp, value));
+        }
+    };
+    plot(m_vwapGraph, point.vwap);
+    plot(m_emaFastGraph, point.emaFast);
+    plot(m_emaSlowGraph, point.emaSlow);
+    plot(m_sessionHighGraph, point.sessionHigh);
+    plot(m_sessionLowGraph, point.sessionLow);
+}
+
+void ChartWidget::clearIndicatorGraphs()
+{
+    for (QCPGraph* graph : {m_vwapGraph, m_emaFastGraph, m_emaSlowGraph, m_sessionHighGraph, m_sessionLowGraph}) {
+        graph->data()->clear();
+    }
 }
 
 void ChartWidget::updatePriceLines(double bid, double ask, double mid)
@@ -313,36 +662,28 @@ void ChartWidget::updatePriceLines(double bid, double ask, double mid)
         return;
     }
 
-    // Store the latest values for debounced update
+    // Latest values win, the lines move once per frame
     m_lastBid = bid;
     m_lastAsk = ask;
     m_lastMid = mid;
-    m_priceLinesDirty = true;
-
-    // Schedule a replot if not already scheduled (debouncing at 10 FPS)
-    if (!m_replotTimer->isActive()) {
-        m_replotTimer->start();
-    }
+    requestReplot(DirtyPriceLines);
 }
 
-void ChartWidget::updateCurrentBar(const CandleBar& bar)
+void ChartWidget::updateCurrentBar(Timeframe timeframe, const CandleBar& bar)
 {
-    if (!m_dataManager || m_currentSymbol.isEmpty()) {
+    // Only on top of this ticker's candles (not loaded yet or another timeframe on screen -
+    // bars queued before a timeframe switch reached the engine are still for the old one)
+    if (!m_dataManager || m_currentSymbol.isEmpty() || m_candles->isEmpty() || timeframe != m_currentTimeframe
+        || m_plottedTickerKey != m_currentTickerKey || m_plottedTimeframe != m_currentTimeframe) {
         return;
     }
 
-    const QVector<CandleBar>* bars = m_dataManager->getBars(m_currentTickerKey, m_currentTimeframe);
-    if (!bars || bars->isEmpty()) {
-        return;
-    }
+    bool isNewCandle = patchCandle(bar);
 
-    bool isNewCandle = (bars->last().timestamp != bar.timestamp);
-
-    if (bars->last().timestamp == bar.timestamp) {
-        m_candlesticks->data()->remove(bar.timestamp);
-        m_candlesticks->addData(bar.timestamp, bar.open, bar.high, bar.low, bar.close);
-    } else {
-        m_candlesticks->addData(bar.timestamp, bar.open, bar.high, bar.low, bar.close);
+    // Live candle: indicator values from the stored state, nothing fed until the series has it
+    const BarIndicators& indicators = m_indicatorTracks[m_currentTimeframe].indicators;
+    if (indicators.isEmpty() || bar.timestamp >= indicators.lastTimestamp()) {
+        plotIndicatorPoint(indicators.preview(bar));
     }
 
     // Auto-scroll chart when new candle arrives
@@ -355,62 +696,65 @@ void ChartWidget::updateCurrentBar(const CandleBar& bar)
         m_customPlot->xAxis->setRange(currentRange.lower + candleWidth, currentRange.upper + candleWidth);
     }
 
-    // Rescale vertical axis if auto-scale is enabled
-    if (m_autoScale) {
-        rescaleVerticalAxis();
-    }
+    // Every tick of the current ticker lands here - rescaled and drawn once per frame
+    requestReplot(DirtyCandles | DirtyAxes);
+}
 
-    m_customPlot->replot();
+void ChartWidget::addSessionBackgrounds(const CandleView& bars)
+{
+    clearSessionBackgrounds();
+    for (int i = 0; i < bars.size(); ++i) {
+        addSessionBackground(bars.timestamp(i));
+    }
 }
 
-void ChartWidget::addSessionBackgrounds(const QVector<CandleBar>& bars)
+void ChartWidget::addSessionBackground(qint64 timestamp)
 {
-    if (bars.isEmpty()) {
+    int session = sessionOf(timestamp);
+    if (session == SessionNone) {
         return;
     }
-
-    // Remove old session background rectangles (but not price lines)
-    QList<QCPItemRect*> rectsToRemove;
-    for (int i = 0; i < m_customPlot->itemCount(); ++i) {
-        QCPAbstractItem* item = m_customPlot->item(i);
-        if (!item) continue;
-
-        QCPItemRect* rect = qobject_cast<QCPItemRect*>(item);
-        if (rect) {
-            // Check if this is NOT a price line related rect (price lines are QCPItemLine, not rect)
-            rectsToRemove.append(rect);
+    qint64 end = timestamp + timeframeToSeconds(m_currentTimeframe);
+
+    // Next bar of the same session: widen its band
+    if (!m_sessionBands.isEmpty()) {
+        SessionBand& band = m_sessionBands.last();
+        if (band.session == session && timestamp >= band.start && easternDay(band.start) == easternDay(timestamp)) {
+            band.end = qMax(band.end, end);
+            band.rect->bottomRight->setCoords(band.end, 1);
+            return;
         }
     }
 
-    // Remove collected rectangles
-    for (QCPItemRect* rect : rectsToRemove) {
-        m_customPlot->removeItem(rect);
-    }
-
-    for (const CandleBar& bar : bars) {
-        QDateTime barTime = QDateTime::fromSecsSinceEpoch(bar.timestamp, QTimeZone::utc());
-
-        barTime = barTime.addSecs(-5 * 3600);
+    // Full height in axis rect coordinates - nothing to update when the price axis rescales
+    QCPItemRect* rect = new QCPItemRect(m_customPlot);
+    rect->topLeft->setTypeY(QCPItemPosition::ptAxisRectRatio);
+    rect->bottomRight->setTypeY(QCPItemPosition::ptAxisRectRatio);
+    rect->topLeft->setCoords(timestamp, 0);
+    rect->bottomRight->setCoords(end, 1);
+    rect->setBrush(QBrush(session == SessionPreMarket ? QColor(255, 250, 205, 80) : QColor(173, 216, 230, 80)));
+    rect->setPen(Qt::NoPen);
+    m_sessionBands.append({timestamp, end, session, rect});
+}
 
-        int hour = barTime.time().hour();
-        int minute = barTime.time().minute();
-        double hourDecimal = hour + minute / 60.0;
+void ChartWidget::trimSessionBackgrounds(qint64 firstTimestamp)
+{
+    while (!m_sessionBands.isEmpty() && m_sessionBands.first().end <= firstTimestamp) {
+        m_customPlot->removeItem(m_sessionBands.first().rect);
+        m_sessionBands.removeFirst();
+    }
+    if (!m_sessionBands.isEmpty() && m_sessionBands.first().start < firstTimestamp) {
+        m_sessionBands.first().start = firstTimestamp;
+        m_sessionBands.first().rect->topLeft->setCoords(firstTimestamp, 0);
+    }
+}
 
-        if (hourDecimal >= 4.0 && hourDecimal < 9.5) {
-            QCPItemRect* rect = new QCPItemRect(m_customPlot);
-            rect->topLeft->setCoords(bar.timestamp, m_customPlot->yAxis->range().upper);
-            rect->bottomRight->setCoords(bar.timestamp + 10, m_customPlot->yAxis->range().lower);
-            rect->setBrush(QBrush(QColor(255, 250, 205, 80)));
-            rect->setPen(Qt::NoPen);
-        }
-        else if (hourDecimal >= 16.0 && hourDecimal < 20.0) {
-            QCPItemRect* rect = new QCPItemRect(m_customPlot);
-            rect->topLeft->setCoords(bar.timestamp, m_customPlot->yAxis->range().upper);
-            rect->bottomRight->setCoords(bar.timestamp + 10, m_customPlot->yAxis->range().lower);
-            rect->setBrush(QBrush(QColor(173, 216, 230, 80)));
-            rect->setPen(Qt::NoPen);
-        }
+void ChartWidget::clearSessionBackgrounds()
+{
+    for (const SessionBand& band : m_sessionBands) {
+        m_customPlot->removeItem(band.rect);
     }
+    m_sessionBands.clear();
 }
 
 void ChartWidget::onCandleSizeChanged(int index)
@@ -425,11 +769,14 @@ void ChartWidget::onCandleSizeChanged(int index)
         setTimeframe(newTimeframe);
 
         if (m_dataManager) {
-            m_dataManager->setCurrentTimeframe(newTimeframe);
-
-            if (!m_currentSymbol.isEmpty()) {
-                m_dataManager->loadTimeframe(m_currentTickerKey, newTimeframe);
-            }
+            // Data manager runs on the engine thread
+            QMetaObject::invokeMethod(m_dataManager, [manager = m_dataManager, tickerKey = m_currentTickerKey, newTimeframe]() {
+                manager->setCurrentTimeframe(newTimeframe);
+
+                if (!tickerKey.isEmpty()) {
+                    manager->loadTimeframe(tickerKey, newTimeframe);
+                }
+            });
         }
     }
 }
@@ -438,8 +785,7 @@ void ChartWidget::onAutoScaleChanged(bool checked)
 {
     m_autoScale = checked;
     if (m_autoScale) {
-        rescaleVerticalAxis();
-        m_customPlot->replot();
+        requestReplot(DirtyAxes);
     }
 }
 
@@ -447,41 +793,35 @@ void ChartWidget::onXRangeChanged(const QCPRange &range)
 {
     Q_UNUSED(range);
 
-    // Auto-scale vertical axis based on visible candles
+    // Done right away (O(log n)): drag/zoom replots are issued by QCustomPlot itself
+    updateLevelOfDetail();
     if (m_autoScale) {
         rescaleVerticalAxis();
     }
+    rescaleVolumeAxis();
+    if (m_midLine && m_midLine->visible()) {
+        updatePriceLineItems(); // Lines span the visible window
+    }
 
     // Save horizontal range for current timeframe
-    saveHorizontalRange();
+    m_zoomSaveTimer->start();
 }
 
 void ChartWidget::rescaleVerticalAxis()
 {
-    if (!m_candlesticks || m_candlesticks->data()->isEmpty()) {
+    if (m_candles->isEmpty()) {
         return;
     }
 
-    // Get visible range on x-axis
-    QCPRange xRange = m_customPlot->xAxis->range();
-
-    double minPrice = std::numeric_limits<double>::max();
-    double maxPrice = std::numeric_limits<double>::lowest();
-
-    // Iterate through all candles and find min/max within visible range
-    QCPFinancialDataContainer::const_iterator begin = m_candlesticks->data()->constBegin();
-    QCPFinancialDataContainer::const_iterator end = m_candlesticks->data()->constEnd();
+    int from = 0;
+    int to = 0;
+    visibleIndexRange(from, to);
 
-    for (QCPFinancialDataContainer::const_iterator it = begin; it != end; ++it) {
-        double key = it->key;
-        if (key >= xRange.lower && key <= xRange.upper) {
-            minPrice = qMin(minPrice, it->low);
-            maxPrice = qMax(maxPrice, it->high);
-        }
-    }
+    double minPrice = 0.0;
+    double maxPrice = 0.0;
 
     // Add 5% padding
-    if (minPrice != std::numeric_limits<double>::max() && maxPrice != std::numeric_limits<double>::lowest()) {
+    if (m_priceRange.query(from, to, minPrice, maxPrice)) {
         double range = maxPrice - minPrice;
         double padding = range * 0.05;
         m_customPlot->yAxis->setRange(minPrice - padding, maxPrice + padding);
@@ -489,6 +829,42 @@ void ChartWidget::rescaleVerticalAxis()
     }
 }
 
+void ChartWidget::rescaleVolumeAxis()
+{
+    double minVolume = 0.0;
+    double maxVolume = 0.0;
+    if (m_lodSeconds > 0) {
+        // Bucket sums on screen - few enough to scan (MIN_PIXELS_PER_CANDLE wide each)
+        QCPRange xRange = m_customPlot->xAxis->range();
+        QCPBarsDataContainer::const_iterator end = m_lodVolume->findEnd(xRange.upper, false);
+        for (auto it = m_lodVolume->findBegin(xRange.lower - m_lodSeconds, false); it != end; ++it) {
+            maxVolume = qMax(maxVolume, it->value);
+        }
+    } else {
+        int from = 0;
+        int to = 0;
+        visibleIndexRange(from, to);
+        m_volumeRange.query(from, to, minVolume, maxVolume);
+    }
+
+    // Bars stand on zero, 10% headroom above the tallest one
+    if (maxVolume > 0.0) {
+        m_volumeAxis->setRange(0, maxVolume * 1.1);
+    } else {
+        m_volumeAxis->setRange(0, 1);
+    }
+}
+
+void ChartWidget::visibleIndexRange(int& from, int& to) const
+{
+    // Candles with key in [lower, upper] by binary search (the range trees are indexed the same way)
+    QCPRange xRange = m_customPlot->xAxis->range();
+    QSharedPointer<QCPFinancialDataContainer> data = m_candles;
+    QCPFinancialDataContainer::const_iterator begin = data->constBegin();
+    from = static_cast<int>(data->findBegin(xRange.lower, false) - begin);
+    to = static_cast<int>(data->findEnd(xRange.upper, false) - begin);
+}
+
 void ChartWidget::saveHorizontalRange()
 {
     if (!m_customPlot || m_currentSymbol.isEmpty()) {
@@ -513,11 +889,55 @@ void ChartWidget::restoreHorizontalRange()
     }
 }
 
+void ChartWidget::setMaxFps(int fps)
+{
+    m_frameIntervalMs = 1000 / qBound(1, fps, 60);
+}
+
+void ChartWidget::requestReplot(int dirty)
+{
+    m_dirty |= dirty;
+    m_replotsRequested++;
+    if (m_replotTimer->isActive()) {
+        return; // Joins the frame already scheduled
+    }
+
+    // After a quiet period the frame goes out right away, otherwise one interval after the last
+    qint64 sinceLastFrame = m_lastFrame.isValid() ? m_lastFrame.elapsed() : m_frameIntervalMs;
+    m_replotTimer->start(static_cast<int>(qMax<qint64>(0, m_frameIntervalMs - sinceLastFrame)));
+}
+
 void ChartWidget::scheduledReplot()
 {
-    if (!m_priceLinesDirty || !m_customPlot || !m_bidLine || !m_askLine || !m_midLine) {
+    if (!m_customPlot || m_dirty == 0) {
         return;
     }
+    int dirty = m_dirty;
+    m_dirty = 0;
+
+    updateLevelOfDetail(); // Widget width may have changed
+    if ((dirty & DirtyCandles) && m_lodSeconds > 0) {
+        patchLodTail();
+    }
+
+    if ((dirty & DirtyAxes) && m_autoScale) {
+        rescaleVerticalAxis();
+    }
+    if (dirty & (DirtyAxes | DirtyCandles)) {
+        rescaleVolumeAxis();
+    }
+    if ((dirty & DirtyPriceLines) && m_bidLine && m_askLine && m_midLine) {
+        updatePriceLineItems();
+    }
+
+    // Queued: merges with replots QCustomPlot triggers itself in the same event loop pass
+    m_customPlot->replot(QCustomPlot::rpQueuedReplot);
+    m_lastFrame.start();
+    m_replotsPerformed++;
+}
+
+void ChartWidget::updatePriceLineItems()
+{
 
     double xMin = m_customPlot->xAxis->range().lower;
     double xMax = m_customPlot->xAxis->range().upper;
@@ -545,8 +965,126 @@ void ChartWidget::scheduledReplot()
     m_midLabel->setText(QString("Mid: %1").arg(m_lastMid, 0, 'f', 2));
     m_midLine->setVisible(true);
     m_midLabel->setVisible(true);
+}
+
+void ChartWidget::resizeEvent(QResizeEvent* event)
+{
+    QWidget::resizeEvent(event);
+    requestReplot(DirtyCandles); // Pixels per candle changed
+}
+
+int ChartWidget::lodSecondsFor(const QCPRange& range) const
+{
+    int barSeconds = timeframeToSeconds(m_currentTimeframe);
+    int width = m_customPlot->axisRect()->width();
+    if (width <= 0) {
+        width = m_customPlot->width();
+    }
+    if (width <= 0 || range.size() <= 0) {
+        return 0;
+    }
+
+    // Narrowest bucket that is still MIN_PIXELS_PER_CANDLE wide
+    double minSeconds = MIN_PIXELS_PER_CANDLE * range.size() / width;
+    if (barSeconds >= minSeconds) {
+        return 0;
+    }
+    int seconds = barSeconds;
+    for (int bucket : LOD_BUCKETS) {
+        if (bucket <= barSeconds || bucket % barSeconds != 0) continue;
+        seconds = bucket;
+        if (bucket >= minSeconds) break;
+    }
+    return seconds == barSeconds ? 0 : seconds;
+}
 
-    // Replot once for all updates
-    m_customPlot->replot();
-    m_priceLinesDirty = false;
+void ChartWidget::updateLevelOfDetail()
+{
+    int seconds = lodSecondsFor(m_customPlot->xAxis->range());
+    if (seconds == m_lodSeconds) {
+        return;
+    }
+
+    m_lodSeconds = seconds;
+    if (seconds == 0) {
+        m_lodCandles->clear();
+        m_lodVolume->clear();
+        m_candlesticks->setData(m_candles);
+        m_candlesticks->setWidth(CANDLE_WIDTH_RATIO * timeframeToSeconds(m_currentTimeframe));
+        m_volumeBars->setData(m_volume);
+        m_volumeBars->setWidth(CANDLE_WIDTH_RATIO * timeframeToSeconds(m_currentTimeframe));
+    } else {
+        rebuildLodCandles();
+        m_candlesticks->setData(m_lodCandles);
+        m_candlesticks->setWidth(CANDLE_WIDTH_RATIO * seconds);
+        m_volumeBars->setData(m_lodVolume);
+        m_volumeBars->setWidth(CANDLE_WIDTH_RATIO * seconds);
+    }
+}
+
+void ChartWidget::rebuildLodCandles()
+{
+    // Same aggregation as the engine's timeframes
+    m_lodRefoldFrom = std::numeric_limits<double>::max();
+    QVector<CandleBar> buckets = resampleBars(m_series.view(), m_lodSeconds);
+    QVector<QCPFinancialData> points(buckets.size());
+    QVector<QCPBarsData> volumes(buckets.size());
+    for (int i = 0; i < buckets.size(); ++i) {
+        const CandleBar& bar = buckets[i];
+        points[i] = QCPFinancialData(bar.timestamp, bar.open, bar.high, bar.low, bar.close);
+        volumes[i] = QCPBarsData(bar.timestamp, bar.volume);
+    }
+    m_lodCandles->set(points, true);
+    m_lodVolume->set(volumes, true);
+
+    // Live candles newer than the snapshot
+    patchLodTail();
+}
+
+void ChartWidget::patchLodTail()
+{
+    if (m_candles->isEmpty()) {
+        m_lodCandles->clear();
+        m_lodVolume->clear();
+        return;
+    }
+
+    // From the newest bucket on screen (it may have been completed since), the raw
+    // candles' newest bucket or the bucket of an older candle patched since, whichever is oldest
+    double lastKey = qMin((m_candles->constEnd() - 1)->key, m_lodRefoldFrom);
+    m_lodRefoldFrom = std::numeric_limits<double>::max();
+    qint64 from = (static_cast<qint64>(lastKey) / m_lodSeconds) * m_lodSeconds;
+    if (!m_lodCandles->isEmpty()) {
+        from = qMin(from, static_cast<qint64>((m_lodCandles->constEnd() - 1)->key));
+    }
+    m_lodCandles->remove(from, std::numeric_limits<double>::max());
+    m_lodVolume->remove(from, std::numeric_limits<double>::max());
+
+    // Volume container runs parallel to the candles (same keys, same positions)
+    QCPFinancialData bucket;
+    QCPBarsData bucketVolume;
+    bool open = false;
+    QCPFinancialDataContainer::const_iterator it = m_candles->findBegin(from, false);
+    QCPBarsDataContainer::const_iterator volumeIt = m_volume->constBegin() + (it - m_candles->constBegin());
+    for (; it != m_candles->constEnd(); ++it, ++volumeIt) {
+        double key = (static_cast<qint64>(it->key) / m_lodSeconds) * m_lodSeconds;
+        if (!open || key != bucket.key) {
+            if (open) {
+                m_lodCandles->add(bucket);
+                m_lodVolume->add(bucketVolume);
+            }
+            bucket = QCPFinancialData(key, it->open, it->high, it->low, it->close);
+            bucketVolume = QCPBarsData(key, volumeIt->value);
+            open = true;
+        } else {
+            bucket.high = qMax(bucket.high, it->high);
+            bucket.low = qMin(bucket.low, it->low);
+            bucket.close = it->close;
+            bucketVolume.value += volumeIt->value;
+        }
+    }
+    if (open) {
+        m_lodCandles->add(bucket);
+        m_lodVolume->add(bucketVolume);
+    }
 }
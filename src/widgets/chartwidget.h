@@ -6,8 +6,11 @@
 #include <QCheckBox>
 #include <QHBoxLayout>
 #include <QTimer>
+#include <QElapsedTimer>
 #include "qcustomplot.h"
 #include "models/tickerdatamanager.h"
+#include "models/barindicators.h"
+#include "utils/minmaxtree.h"
 
 class ChartWidget : public QWidget
 {
@@ -18,11 +21,20 @@ public:
     void setSymbol(const QString& symbol, const QString& exchange = QString());
     void setTimeframe(Timeframe timeframe);
     void setTickerDataManager(TickerDataManager* manager);
-    void updateChart();
+    void updateChart(bool reload = false); // Patches the plotted candles unless reload
     void updatePriceLines(double bid, double ask, double mid);
-    void updateCurrentBar(const CandleBar& bar);
+    void updateCurrentBar(Timeframe timeframe, const CandleBar& bar); // Dropped unless timeframe is on screen
     void clearChart();
 
+    // Render scheduler: every change marks what it touched and asks for a frame; at
+    // most one (queued) replot per frame interval
+    void setMaxFps(int fps);
+    quint64 replotsRequested() const { return m_replotsRequested; }
+    quint64 replotsPerformed() const { return m_replotsPerformed; }
+
+protected:
+    void resizeEvent(QResizeEvent* event) override;
+
 private slots:
     void onCandleSizeChanged(int index);
     void onAutoScaleChanged(bool checked);
@@ -30,17 +42,76 @@ private slots:
     void scheduledReplot();
 
 private:
+    enum DirtyFlag {
+        DirtyCandles = 0x1,
+        DirtyPriceLines = 0x2,
+        DirtyAxes = 0x4 // Price axis to auto-scale
+    };
+    void requestReplot(int dirty);
+
     void setupChart();
+    void setupVolumePane();
+    void setupIndicators();
     void setupControls();
     QHBoxLayout* createControlsLayout();
-    void plotCandles(const QVector<CandleBar>& bars);
-    void addSessionBackgrounds(const QVector<CandleBar>& bars);
+    void plotCandles(const CandleSeries& series); // Bulk load, replaces everything plotted
+    bool syncCandles(const CandleSeries& series); // Tail patch, false if a reload is needed
+    bool patchCandle(const CandleBar& bar);       // True if the bar was appended (volume patched alongside)
+    void rebuildRangeTrees();
+    void clearPlottedData();
+
+    // Indicators: caught up from the series on a full load, then fed bar by bar
+    void syncIndicators(const CandleSeries& series);
+    void feedIndicators(const CandleBar& bar);
+    void plotIndicatorPoint(const IndicatorPoint& point);
+    void clearIndicatorGraphs();
+
+    // Level of detail: zoomed out below MIN_PIXELS_PER_CANDLE, buckets of a coarser
+    // timeframe (resampleBars) are drawn instead of the raw candles
+    int lodSecondsFor(const QCPRange& range) const; // 0 = raw candles
+    void updateLevelOfDetail();
+    void rebuildLodCandles();
+    void patchLodTail(); // Re-folds the newest buckets from the raw candles
+    void addSessionBackgrounds(const CandleView& bars);
+    void addSessionBackground(qint64 timestamp);
+    void trimSessionBackgrounds(qint64 firstTimestamp);
+    void clearSessionBackgrounds();
+    void visibleIndexRange(int& from, int& to) const; // Plotted candles inside the time axis range
     void rescaleVerticalAxis();
+    void rescaleVolumeAxis(); // Always, whether auto-scale is on or not
+    void updatePriceLineItems(); // Moves bid/ask/mid lines and labels to the last quote
     void saveHorizontalRange();
     void restoreHorizontalRange();
 
     QCustomPlot *m_customPlot;
     QCPFinancial *m_candlesticks;
+    QSharedPointer<QCPFinancialDataContainer> m_candles;    // Every plotted candle (raw timeframe)
+    QSharedPointer<QCPFinancialDataContainer> m_lodCandles; // Buckets on screen when zoomed out
+    CandleSeries m_series; // Snapshot behind m_candles, aggregated into the buckets
+    int m_lodSeconds;      // Bucket size on screen, 0 = raw candles, -1 = to be decided
+    double m_lodRefoldFrom; // Oldest candle patched behind the newest since the last fold
+    QCPTextElement *m_title;
+
+    // Volume pane under the price chart, same time range
+    QCPAxisRect *m_volumeRect;
+    QCPAxis *m_volumeAxis;
+    QCPBars *m_volumeBars;
+    QSharedPointer<QCPBarsDataContainer> m_volume;    // Parallel to m_candles (same keys)
+    QSharedPointer<QCPBarsDataContainer> m_lodVolume; // Parallel to m_lodCandles
+    MinMaxTree m_volumeRange;
+
+    // Overlays; indicator state is kept per timeframe of the current ticker, so switching
+    // back only feeds the bars added meanwhile
+    QCPGraph *m_vwapGraph;
+    QCPGraph *m_emaFastGraph;
+    QCPGraph *m_emaSlowGraph;
+    QCPGraph *m_sessionHighGraph;
+    QCPGraph *m_sessionLowGraph;
+    struct IndicatorTrack {
+        BarIndicators indicators;
+        quint32 revision = 0; // Series revision the indicators were fed from
+    };
+    QMap<Timeframe, IndicatorTrack> m_indicatorTracks;
 
     // Price lines
     QCPItemLine *m_bidLine;
@@ -60,12 +131,32 @@ private:
     TickerDataManager* m_dataManager;
     bool m_autoScale;
 
-    // Replot debouncing
+    // What the candle container holds, for incremental updates
+    QString m_plottedTickerKey;
+    Timeframe m_plottedTimeframe;
+    quint32 m_plottedRevision;
+    MinMaxTree m_priceRange; // Low/high of the plotted candles by container index, for auto-scale
+
+    // Pre-market / after-hours shading: one rectangle per contiguous session, extended as bars arrive
+    struct SessionBand {
+        qint64 start;
+        qint64 end; // Exclusive
+        int session;
+        QCPItemRect* rect;
+    };
+    QVector<SessionBand> m_sessionBands;
+
+    // Render scheduling
     QTimer* m_replotTimer;
+    QElapsedTimer m_lastFrame;
+    int m_frameIntervalMs;
+    int m_dirty; // DirtyFlag bits waiting for the next frame
+    quint64 m_replotsRequested;
+    quint64 m_replotsPerformed;
+    QTimer* m_zoomSaveTimer; // Zoom is saved once panning/zooming pauses, not per mouse move
     double m_lastBid;
     double m_lastAsk;
     double m_lastMid;
-    bool m_priceLinesDirty;
 };
 
 #endif // CHARTWIDGET_H
\ No newline at end of file